@@ -0,0 +1,113 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include <cstring>
+#include <vector>
+
+#include "WaveCompiler/Parser/ASTFormat.h"
+#include "WaveCompiler/Parser/Parser.h"
+
+#include "Corpus.h"
+
+namespace Wave {
+
+namespace {
+
+/// Time loading a source by parsing it, and from its binary AST.
+///
+/// \param runner The runner.
+/// \param name What the source is.
+/// \param source The source, which must have no errors.
+void TimeLoad(BenchmarkRunner& runner, const std::string& name, const std::string& source)
+{
+	CompileContext context;
+	FileID file = AddSource(context, "format.wve", source);
+
+	double parse = runner.Time([&]() {
+		Lexer lexer(context, file);
+		lexer.Lex();
+		Parser parser(context, lexer);
+		parser.Parse();
+	});
+
+	Lexer lexer(context, file);
+	lexer.Lex();
+	Parser parser(context, lexer);
+	parser.Parse();
+	if (!parser.GetDiagnostics().empty())
+	{
+		runner.Check(false, name + " did not parse");
+		return;
+	}
+
+	std::string data;
+	bool written = false;
+	double serialize = runner.Time([&]() { written = SerializeModule(*parser.GetModule(), context.GetSymbols(), data); });
+	if (!written)
+	{
+		runner.Check(false, name + " is too large to serialize");
+		return;
+	}
+
+	// The format needs the buffer aligned to 8 bytes, as a mapped file would be.
+	std::vector<uint64_t> buffer((data.size() + 7) / 8);
+	memcpy(buffer.data(), data.data(), data.size());
+	auto bytes = reinterpret_cast<const char*>(buffer.data());
+
+	bool loaded = false;
+	double deserialize = runner.Time([&]() { loaded = DeserializeModule(context, file, bytes, data.size()) != nullptr; });
+
+	uint64_t kinds = 0;
+	double open = runner.Time([&]() {
+		BinaryModule view(bytes, data.size());
+		if (!view.IsValid()) { return; }
+		for (auto& definition : view.Get(view.GetModule().Definitions)) { kinds += static_cast<uint64_t>(view.GetKind(definition.Def)); }
+	});
+	DoNotOptimize(kinds);
+
+	runner.Section("AST format: " + name);
+	runner.ReportValue("Source", std::to_string(source.size()) + " bytes");
+	runner.ReportValue("Binary AST", std::to_string(data.size()) + " bytes");
+	runner.ReportThroughput("Lex and parse", parse, source.size());
+	runner.ReportThroughput("Serialize", serialize, data.size());
+	runner.ReportThroughput("Deserialize", deserialize, data.size());
+	runner.Report("Open in place", open, "checks the header, reads the definition kinds");
+	runner.Check(loaded, name + " did not deserialize");
+}
+
+}
+
+void RunASTFormatBenchmark(BenchmarkRunner& runner)
+{
+	uint64_t functions = runner.Scale(MixedCorpusFunctions);
+	TimeLoad(runner, "mixed source, " + std::to_string(functions) + " functions", GenerateMixedCorpus(functions));
+
+	uint64_t terms = runner.Scale(NestedCorpusTerms);
+	TimeLoad(
+		runner, 
+		std::to_string(NestedCorpusGroups) + " nested groups, " + std::to_string(terms) + " terms each", 
+		GenerateNestedGroupsCorpus(NestedCorpusGroups, terms)
+	);
+
+	uint64_t loops = runner.Scale(ForCorpusLoops);
+	TimeLoad(
+		runner, 
+		std::to_string(loops) + " for loops, " + std::to_string(ForCorpusTerms) + " terms each", 
+		GenerateForHeadersCorpus(loops, ForCorpusTerms)
+	);
+}
+
+}
@@ -0,0 +1,106 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+
+#include "WaveCompiler/SourceBuffer.h"
+
+namespace Wave {
+
+namespace {
+
+/// Sink for values benchmarks compute, which the compiler cannot see is never read.
+volatile uint64_t s_Sink = 0;
+
+}
+
+BenchmarkRunner::BenchmarkRunner(uint32_t runs, double scale)
+	: m_Runs(std::max(runs, 1u)), m_Scale(scale)
+{}
+
+uint64_t BenchmarkRunner::Scale(uint64_t size) const
+{
+	return std::max(static_cast<uint64_t>(std::llround(size * m_Scale)), uint64_t(1));
+}
+
+double BenchmarkRunner::Time(const std::function<void()>& function) const
+{
+	double best = 0.0;
+	for (uint32_t run = 0; run < m_Runs; run++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		auto end = std::chrono::steady_clock::now();
+
+		double time = std::chrono::duration<double, std::milli>(end - start).count();
+		if (run == 0 || time < best) { best = time; }
+	}
+
+	return best;
+}
+
+void BenchmarkRunner::Section(std::string_view title) const
+{
+	std::printf("\n%.*s\n", static_cast<int>(title.size()), title.data());
+}
+
+void BenchmarkRunner::Report(std::string_view name, double milliseconds, std::string_view note) const
+{
+	std::printf("  %-44.*s %10.2f ms", static_cast<int>(name.size()), name.data(), milliseconds);
+	if (!note.empty()) { std::printf("   %.*s", static_cast<int>(note.size()), note.data()); }
+	std::printf("\n");
+}
+
+void BenchmarkRunner::ReportThroughput(std::string_view name, double milliseconds, uint64_t bytes) const
+{
+	char note[32];
+	std::snprintf(note, sizeof(note), "%.1f MB/s", bytes / 1e6 / (milliseconds / 1e3));
+	Report(name, milliseconds, note);
+}
+
+void BenchmarkRunner::ReportValue(std::string_view name, std::string_view value) const
+{
+	std::printf(
+		"  %-44.*s %13.*s\n", 
+		static_cast<int>(name.size()), name.data(), static_cast<int>(value.size()), value.data()
+	);
+}
+
+void BenchmarkRunner::Check(bool condition, std::string_view message)
+{
+	if (condition) { return; }
+
+	std::fprintf(stderr, "check failed: %.*s\n", static_cast<int>(message.size()), message.data());
+	m_Failed = true;
+}
+
+FileID AddSource(CompileContext& context, std::string_view name, const std::string& source)
+{
+	std::istringstream stream(source);
+	return context.GetSources().AddFile(std::make_unique<SourceBuffer>(std::string(name), stream));
+}
+
+void DoNotOptimize(uint64_t value)
+{
+	s_Sink = value;
+}
+
+}
@@ -0,0 +1,138 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "WaveCompiler/CompileContext.h"
+
+namespace Wave {
+
+/// Times benchmarks and prints their results as rows of a table.
+class BenchmarkRunner
+{
+public:
+	/// Create a runner.
+	///
+	/// \param runs Number of times each measurement is repeated. The fastest run is reported.
+	/// \param scale Factor the default size of every corpus is multiplied by.
+	BenchmarkRunner(uint32_t runs, double scale);
+
+	/// Scale the default size of a corpus.
+	///
+	/// \param size The default size.
+	///
+	/// \return The size to generate, which is at least 1.
+	uint64_t Scale(uint64_t size) const;
+
+	/// Time a function, running it once per run.
+	///
+	/// \param function The function to time.
+	///
+	/// \return The fastest run, in milliseconds.
+	double Time(const std::function<void()>& function) const;
+
+	/// Print a heading for the measurements that follow.
+	///
+	/// \param title The heading.
+	void Section(std::string_view title) const;
+
+	/// Print a measurement.
+	///
+	/// \param name What was measured.
+	/// \param milliseconds The time it took.
+	/// \param note Extra detail, such as a count or a throughput.
+	void Report(std::string_view name, double milliseconds, std::string_view note = "") const;
+
+	/// Print a measurement of work over a number of bytes, with its throughput.
+	///
+	/// \param name What was measured.
+	/// \param milliseconds The time it took.
+	/// \param bytes Number of bytes the work went over.
+	void ReportThroughput(std::string_view name, double milliseconds, uint64_t bytes) const;
+
+	/// Print a value which is not a time, such as a count.
+	///
+	/// \param name What was counted.
+	/// \param value The value.
+	void ReportValue(std::string_view name, std::string_view value) const;
+
+	/// Check that a benchmark computed what it should have, failing the run if it did not.
+	///
+	/// \param condition What should hold.
+	/// \param message What went wrong if it does not.
+	void Check(bool condition, std::string_view message);
+
+	/// Check if any check failed.
+	///
+	/// \return If the run failed.
+	bool HasFailed() const { return m_Failed; }
+
+private:
+	uint32_t m_Runs;
+	double m_Scale;
+	bool m_Failed = false;
+};
+
+/// A benchmark which can be selected by name on the command line.
+struct Benchmark
+{
+	const char* Name;
+	const char* Description;
+	void (*Run)(BenchmarkRunner& runner);
+};
+
+/// Add source text to the sources of a context, as if it were read from a file.
+///
+/// \param context The context.
+/// \param name The name of the file.
+/// \param source The source text.
+///
+/// \return The ID of the file.
+FileID AddSource(CompileContext& context, std::string_view name, const std::string& source);
+
+/// Keep the compiler from optimizing away a value a benchmark computed.
+///
+/// \param value The value.
+void DoNotOptimize(uint64_t value);
+
+/// Lexing a file loaded through std::istream, against a mapped source buffer.
+void RunLexerBenchmark(BenchmarkRunner& runner);
+
+/// Keyword recognition, against the std::map lookup the lexer used before.
+void RunKeywordBenchmark(BenchmarkRunner& runner);
+
+/// Parsing with errors, which the parser recovers from.
+void RunErrorRecoveryBenchmark(BenchmarkRunner& runner);
+
+/// Parsing source where telling constructs apart needs lookahead.
+void RunLookaheadBenchmark(BenchmarkRunner& runner);
+
+/// Loading a module from the binary AST format, against lexing and parsing it.
+void RunASTFormatBenchmark(BenchmarkRunner& runner);
+
+/// Building the flat AST, and walking it against walking the pointer AST.
+void RunFlatASTBenchmark(BenchmarkRunner& runner);
+
+/// Walking the AST through virtual calls against the kind dispatch of StaticVisitor.
+void RunVisitorBenchmark(BenchmarkRunner& runner);
+
+/// Heap allocations of the parser, and of building short lists with std::vector and SmallVector.
+void RunParserMemoryBenchmark(BenchmarkRunner& runner);
+
+}
@@ -0,0 +1,179 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Corpus.h"
+
+#include <iterator>
+
+#include "Benchmark.h"
+
+namespace Wave {
+
+namespace {
+
+/// Small pseudo-random generator, so a corpus does not depend on the standard library it is built with.
+class Random
+{
+public:
+	/// Get the next number.
+	///
+	/// \return The number.
+	uint64_t Next()
+	{
+		m_State ^= m_State >> 12;
+		m_State ^= m_State << 25;
+		m_State ^= m_State >> 27;
+		return m_State * 0x2545F4914F6CDD1Dull;
+	}
+
+	/// Get a number below a bound.
+	///
+	/// \param bound The bound, which must not be 0.
+	///
+	/// \return The number.
+	uint64_t Below(uint64_t bound) { return Next() % bound; }
+
+private:
+	uint64_t m_State = 0x9E3779B97F4A7C15ull;
+};
+
+constexpr const char* KeywordNames[] = {
+	"and", "or", "if", "else", "true", "false", "for", "in", "while", "break", "continue",
+	"try", "catch", "throw", "enum", "tuple", "class", "construct", "abstract", "static",
+	"copy", "const", "public", "protected", "private", "self", "super", "func", "return",
+	"var", "type", "typeof", "int", "real", "char", "bool", "module", "import", "extern",
+	"as", "export"
+};
+
+}
+
+std::string GenerateMixedCorpus(uint64_t functions)
+{
+	std::string source = "module Tests.Big;\nimport Std.IO;\n\n";
+	for (uint64_t i = 0; i < functions; i++)
+	{
+		auto n = std::to_string(i);
+		auto local = "local_value_" + n;
+
+		source += "// function number " + n + " does some arithmetic on its arguments\n";
+		source += "/* block comment for f" + n + "\n   spanning lines */\n";
+		source += "func f" + n + "(alpha: int, beta: real, gamma)\n{\n";
+		source += "\tvar " + local + " = alpha * " + n + " + beta / 2.5 - (gamma % 7);\n";
+		source += "\tif " + local + " >= 10 and alpha != beta { Std.IO.Print(\"value is large\", " + local + "); }\n";
+		source += "\twhile alpha < 100 { alpha = alpha + 1; }\n";
+		source += "\treturn Compute(alpha, beta, gamma, " + local + ");\n}\n\n";
+	}
+
+	return source;
+}
+
+std::string GenerateWordsCorpus(uint64_t words)
+{
+	static constexpr char Letters[] = "abcdefghijklmnopqrstuvwxyzABCDXYZ_";
+
+	Random random;
+	std::string source;
+	for (uint64_t i = 0; i < words; i++)
+	{
+		if (random.Below(100) < 35)
+		{
+			source += KeywordNames[random.Below(std::size(KeywordNames))];
+		}
+		else
+		{
+			// Identifiers start with a letter, and are as long as keywords often are.
+			source += Letters[random.Below(26)];
+			for (uint64_t length = random.Below(12); length > 0; length--)
+			{
+				source += Letters[random.Below(std::size(Letters) - 1)];
+			}
+		}
+
+		source += (i % 12 == 11) ? '\n' : ' ';
+	}
+
+	return source;
+}
+
+std::string GenerateErrorsCorpus(uint64_t functions, uint64_t every)
+{
+	std::string source = "module Tests.Errors;\n";
+	uint64_t statement = 0;
+	for (uint64_t i = 0; i < functions; i++)
+	{
+		source += "func f" + std::to_string(i) + "(a, b)\n{\n";
+		for (uint64_t j = 0; j < 100; j++)
+		{
+			statement++;
+			if (statement % every == 0) { source += "\tvar x = a * b + ;\n"; }
+			else { source += "\tvar x = a * (b + " + std::to_string(j) + ");\n"; }
+		}
+		source += "}\n";
+	}
+
+	return source;
+}
+
+std::string GenerateNestedGroupsCorpus(uint64_t groups, uint64_t terms)
+{
+	std::string source = "module T;\nfunc f()\n{\n\tvar x = ";
+	for (uint64_t i = 0; i < groups; i++)
+	{
+		source += '(';
+		for (uint64_t j = 0; j < terms; j++) { source += "a + "; }
+	}
+	source += 'a';
+	source.append(groups, ')');
+	source += ";\n}\n";
+
+	return source;
+}
+
+std::string GenerateForHeadersCorpus(uint64_t loops, uint64_t terms)
+{
+	std::string condition;
+	for (uint64_t i = 0; i < terms; i++)
+	{
+		if (i != 0) { condition += " + "; }
+		condition += "(a" + std::to_string(i) + ")";
+	}
+
+	std::string source = "module T;\nfunc f()\n{\n";
+	for (uint64_t i = 0; i < loops; i++)
+	{
+		source += "\tfor var i = 0; i < " + condition + "; i = i + 1 { }\n";
+	}
+	source += "}\n";
+
+	return source;
+}
+
+std::vector<std::pair<std::string, std::string>> GenerateCorpora(const BenchmarkRunner& runner)
+{
+	std::vector<std::pair<std::string, std::string>> corpora;
+	corpora.emplace_back("mixed.wve", GenerateMixedCorpus(runner.Scale(MixedCorpusFunctions)));
+	corpora.emplace_back("words.wve", GenerateWordsCorpus(runner.Scale(WordsCorpusWords)));
+	corpora.emplace_back("nested.wve", GenerateNestedGroupsCorpus(NestedCorpusGroups, runner.Scale(NestedCorpusTerms)));
+	corpora.emplace_back("forheaders.wve", GenerateForHeadersCorpus(runner.Scale(ForCorpusLoops), ForCorpusTerms));
+	for (uint64_t every : ErrorsCorpusIntervals)
+	{
+		corpora.emplace_back(
+			"errors_" + std::to_string(every) + ".wve",
+			GenerateErrorsCorpus(runner.Scale(ErrorsCorpusFunctions), every)
+		);
+	}
+	return corpora;
+}
+
+}
@@ -0,0 +1,99 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Wave {
+
+class BenchmarkRunner;
+
+/// Default number of functions in the mixed corpus.
+constexpr uint64_t MixedCorpusFunctions = 10000;
+
+/// Default number of words in the words corpus.
+constexpr uint64_t WordsCorpusWords = 800000;
+
+/// Default number of functions in the errors corpus, each with 100 statements.
+constexpr uint64_t ErrorsCorpusFunctions = 2000;
+
+/// How often errors corpora have an error, in statements.
+constexpr uint64_t ErrorsCorpusIntervals[] = { 1, 10, 100, 1000 };
+
+/// Default nesting depth of the nested groups corpus.
+/// It is not scaled, as the parser has a limit on how deep expressions can nest.
+constexpr uint64_t NestedCorpusGroups = 400;
+
+/// Default number of terms in each group of the nested groups corpus.
+constexpr uint64_t NestedCorpusTerms = 1000;
+
+/// Default number of loops in the for headers corpus.
+constexpr uint64_t ForCorpusLoops = 20;
+
+/// Default number of terms in the condition of each loop of the for headers corpus.
+constexpr uint64_t ForCorpusTerms = 20000;
+
+/// Generate ordinary source: functions with comments, arithmetic, branches, loops and calls.
+/// Every generator returns the same source on every run and platform.
+///
+/// \param functions Number of functions, each about 400 bytes.
+///
+/// \return The source.
+std::string GenerateMixedCorpus(uint64_t functions);
+
+/// Generate lines of words, about a third of them keywords and the rest identifiers.
+/// It does not parse, and only stresses the lexer.
+///
+/// \param words Number of words.
+///
+/// \return The source.
+std::string GenerateWordsCorpus(uint64_t words);
+
+/// Generate functions of 100 statements, with a syntax error in some of them.
+///
+/// \param functions Number of functions.
+/// \param every One statement in this many is an error, counting across functions.
+///
+/// \return The source.
+std::string GenerateErrorsCorpus(uint64_t functions, uint64_t every);
+
+/// Generate a variable initialized with groups nested in one another,
+/// each a sum of terms with the next group as its last term.
+///
+/// \param groups Number of groups.
+/// \param terms Number of terms in each group, besides the next group.
+///
+/// \return The source.
+std::string GenerateNestedGroupsCorpus(uint64_t groups, uint64_t terms);
+
+/// Generate for loops with long headers, whose condition is a sum of parenthesized terms.
+///
+/// \param loops Number of loops.
+/// \param terms Number of terms in the condition of each loop.
+///
+/// \return The source.
+std::string GenerateForHeadersCorpus(uint64_t loops, uint64_t terms);
+
+/// Generate every corpus at its default size, as written by wavebench --write-corpus.
+///
+/// \param runner Runner, which scales the sizes.
+///
+/// \return The file name and source of each corpus.
+std::vector<std::pair<std::string, std::string>> GenerateCorpora(const BenchmarkRunner& runner);
+
+}
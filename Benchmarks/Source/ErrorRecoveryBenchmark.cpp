@@ -0,0 +1,52 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include "WaveCompiler/Parser/Parser.h"
+
+#include "Corpus.h"
+
+namespace Wave {
+
+void RunErrorRecoveryBenchmark(BenchmarkRunner& runner)
+{
+	uint64_t functions = runner.Scale(ErrorsCorpusFunctions);
+	runner.Section("Error recovery: " + std::to_string(functions * 100) + " statements, parse only");
+
+	for (uint64_t every : ErrorsCorpusIntervals)
+	{
+		auto source = GenerateErrorsCorpus(functions, every);
+
+		CompileContext context;
+		Lexer lexer(context, AddSource(context, "errors.wve", source));
+		lexer.Lex();
+
+		uint64_t diagnostics = 0;
+		double parse = runner.Time([&]() {
+			Parser parser(context, lexer);
+			parser.Parse();
+			diagnostics = parser.GetDiagnostics().size();
+		});
+
+		runner.Report(
+			every == 1 ? "an error in every statement" : "one error every " + std::to_string(every) + " statements", 
+			parse, 
+			std::to_string(diagnostics) + " diagnostics"
+		);
+		runner.Check(diagnostics >= functions * 100 / every, "the parser reported fewer errors than there are");
+	}
+}
+
+}
@@ -0,0 +1,255 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include <array>
+#include <vector>
+
+#include "WaveCompiler/Parser/ASTTraversal.h"
+#include "WaveCompiler/Parser/FlatAST.h"
+#include "WaveCompiler/Parser/Parser.h"
+
+#include "Corpus.h"
+
+namespace Wave {
+
+namespace {
+
+/// Number of nodes of each kind.
+using KindCounts = std::array<uint64_t, static_cast<size_t>(NodeKind::Count)>;
+
+/// Walks the tree of a flat module from its definitions, following the child indexes of every record.
+/// Like ASTTraversal, an interned type is walked under every node that refers to it.
+class FlatWalker
+{
+public:
+	FlatWalker(const FlatModule& module) : m_Module(module) {}
+
+	/// Walk every node, counting them by kind.
+	///
+	/// \return The counts.
+	KindCounts Walk()
+	{
+		KindCounts counts{};
+		for (auto& def : m_Module.GetDefinitions()) { Push(def.Def); }
+
+		while (!m_Stack.empty())
+		{
+			NodeIndex node = m_Stack.back();
+			m_Stack.pop_back();
+
+			auto kind = m_Module.GetKind(node);
+			counts[static_cast<size_t>(kind)]++;
+			PushChildren(node, kind);
+		}
+
+		return counts;
+	}
+
+private:
+	void Push(NodeIndex node)
+	{
+		if (node != NoNode) { m_Stack.push_back(node); }
+	}
+
+	void Push(FlatAST::Range<NodeIndex> nodes)
+	{
+		for (auto node : m_Module.Get(nodes)) { Push(node); }
+	}
+
+	void Push(FlatAST::Range<FlatAST::Parameter> params)
+	{
+		for (auto& param : m_Module.Get(params)) { Push(param.DataType); }
+	}
+
+	template<typename T>
+	const T& Get(NodeIndex node) const { return m_Module.Get<T>(node); }
+
+	void PushChildren(NodeIndex node, NodeKind kind)
+	{
+		switch (kind)
+		{
+		case NodeKind::Abstract: Push(Get<FlatAST::Abstract>(node).Params); Push(Get<FlatAST::Abstract>(node).ReturnType); break;
+		case NodeKind::ArrayIndex: Push(Get<FlatAST::ArrayIndex>(node).Index); break;
+		case NodeKind::ArrayType: Push(Get<FlatAST::ArrayType>(node).HoldType); Push(Get<FlatAST::ArrayType>(node).Size); break;
+		case NodeKind::Assignment: Push(Get<FlatAST::Assignment>(node).Value); break;
+		case NodeKind::Binary: Push(Get<FlatAST::Binary>(node).Left); Push(Get<FlatAST::Binary>(node).Right); break;
+		case NodeKind::Block: Push(Get<FlatAST::Block>(node).Statements); break;
+		case NodeKind::Call: Push(Get<FlatAST::Call>(node).Callee); Push(Get<FlatAST::Call>(node).Args); break;
+		case NodeKind::ClassDefinition:
+		{
+			auto& record = Get<FlatAST::ClassDefinition>(node);
+			Push(record.Public);
+			Push(record.Protected);
+			Push(record.Private);
+			break;
+		}
+		case NodeKind::ConditionFor:
+		{
+			auto& record = Get<FlatAST::ConditionFor>(node);
+			Push(record.Initializer);
+			Push(record.Condition);
+			Push(record.Increment);
+			Push(record.ExecBlock);
+			break;
+		}
+		case NodeKind::Constructor: Push(Get<FlatAST::Constructor>(node).Params); Push(Get<FlatAST::Constructor>(node).ExecBlock); break;
+		case NodeKind::ExpressionStatement: Push(Get<FlatAST::ExpressionStatement>(node).Expr); break;
+		case NodeKind::Function:
+		{
+			auto& record = Get<FlatAST::Function>(node);
+			Push(record.Params);
+			Push(record.ReturnType);
+			Push(record.ExecBlock);
+			break;
+		}
+		case NodeKind::FunctionDefinition: Push(Get<FlatAST::FunctionDefinition>(node).Func); break;
+		case NodeKind::FuncType: Push(Get<FlatAST::FuncType>(node).ParamTypes); Push(Get<FlatAST::FuncType>(node).ReturnType); break;
+		case NodeKind::Getter: Push(Get<FlatAST::Getter>(node).GetType); Push(Get<FlatAST::Getter>(node).ExecBlock); break;
+		case NodeKind::Group: Push(Get<FlatAST::Group>(node).Expr); break;
+		case NodeKind::If:
+		{
+			auto& record = Get<FlatAST::If>(node);
+			Push(record.Condition);
+			Push(record.True);
+			for (auto& elseIf : m_Module.Get(record.ElseIfs))
+			{
+				Push(elseIf.Condition);
+				Push(elseIf.True);
+			}
+			Push(record.Else);
+			break;
+		}
+		case NodeKind::InitializerList: Push(Get<FlatAST::InitializerList>(node).Data); break;
+		case NodeKind::Logical: Push(Get<FlatAST::Logical>(node).Left); Push(Get<FlatAST::Logical>(node).Right); break;
+		case NodeKind::Method: Push(Get<FlatAST::Method>(node).Def); break;
+		case NodeKind::OperatorOverload:
+		{
+			auto& record = Get<FlatAST::OperatorOverload>(node);
+			Push(record.Left.DataType);
+			if (!record.IsUnary) { Push(record.Right.DataType); }
+			Push(record.ReturnType);
+			Push(record.ExecBlock);
+			break;
+		}
+		case NodeKind::RangeFor: Push(Get<FlatAST::RangeFor>(node).Range); Push(Get<FlatAST::RangeFor>(node).ExecBlock); break;
+		case NodeKind::Return: Push(Get<FlatAST::Return>(node).Value); break;
+		case NodeKind::Setter: Push(Get<FlatAST::Setter>(node).SetParam.DataType); Push(Get<FlatAST::Setter>(node).ExecBlock); break;
+		case NodeKind::Throw: Push(Get<FlatAST::Throw>(node).Value); break;
+		case NodeKind::Try:
+		{
+			auto& record = Get<FlatAST::Try>(node);
+			Push(record.ExecBlock);
+			for (auto& c : m_Module.Get(record.Catches))
+			{
+				Push(c.Param.DataType);
+				Push(c.ExecBlock);
+			}
+			break;
+		}
+		case NodeKind::TupleType: Push(Get<FlatAST::TupleType>(node).Types); break;
+		case NodeKind::TypeOf: Push(Get<FlatAST::TypeOf>(node).Expr); break;
+		case NodeKind::Unary: Push(Get<FlatAST::Unary>(node).Right); break;
+		case NodeKind::VarDefinition: Push(Get<FlatAST::VarDefinition>(node).DataType); Push(Get<FlatAST::VarDefinition>(node).Value); break;
+		case NodeKind::While: Push(Get<FlatAST::While>(node).Condition); Push(Get<FlatAST::While>(node).ExecBlock); break;
+		default: break;
+		}
+	}
+
+	const FlatModule& m_Module;
+	std::vector<NodeIndex> m_Stack;
+};
+
+/// Time flattening a module, and counting its nodes in both forms.
+///
+/// \param runner The runner.
+/// \param name What the source is.
+/// \param source The source, which must have no errors.
+void TimeFlat(BenchmarkRunner& runner, const std::string& name, const std::string& source)
+{
+	CompileContext context;
+	Lexer lexer(context, AddSource(context, "flat.wve", source));
+	lexer.Lex();
+	Parser parser(context, lexer);
+	parser.Parse();
+	if (!parser.GetDiagnostics().empty())
+	{
+		runner.Check(false, name + " did not parse");
+		return;
+	}
+
+	auto& module = *parser.GetModule();
+	FlatModule flat;
+	double flatten = runner.Time([&]() { flat = FlattenModule(module); });
+
+	KindCounts pointerCounts{};
+	ASTTraversal traversal(ASTTraversal::Order::PreOrder);
+	double pointer = runner.Time([&]() {
+		pointerCounts = {};
+		traversal.Reset(module);
+		for (ASTNode node : traversal) { pointerCounts[static_cast<size_t>(GetKind(node))]++; }
+	});
+
+	KindCounts walkCounts{};
+	FlatWalker walker(flat);
+	double walk = runner.Time([&]() { walkCounts = walker.Walk(); });
+
+	KindCounts streamCounts{};
+	double stream = runner.Time([&]() {
+		streamCounts = {};
+		for (auto kind : flat.GetKinds()) { streamCounts[static_cast<size_t>(kind)]++; }
+	});
+
+	runner.Section("Flat AST: " + name);
+	runner.ReportValue("Nodes", std::to_string(flat.GetSize()));
+	runner.Report("Flatten", flatten);
+	runner.Report("Pointer walk", pointer, "ASTTraversal, pre-order");
+	runner.Report("Flat walk", walk, "following child indexes");
+	runner.Report("Flat stream", stream, "counting the kind array");
+
+	// Interned types are shared, so the stream sees each once while the walks see them under every use.
+	for (size_t i = 0; i < walkCounts.size(); i++)
+	{
+		auto kind = static_cast<NodeKind>(i);
+		bool type = kind == NodeKind::ArrayType || kind == NodeKind::ClassType || kind == NodeKind::FuncType || 
+			kind == NodeKind::SimpleType || kind == NodeKind::TupleType || kind == NodeKind::TypeOf;
+		runner.Check(pointerCounts[i] == walkCounts[i], name + ": the walks counted different nodes");
+		runner.Check(type || streamCounts[i] == walkCounts[i], name + ": the stream counted different nodes");
+	}
+}
+
+}
+
+void RunFlatASTBenchmark(BenchmarkRunner& runner)
+{
+	uint64_t functions = runner.Scale(MixedCorpusFunctions);
+	TimeFlat(runner, "mixed source, " + std::to_string(functions) + " functions", GenerateMixedCorpus(functions));
+
+	uint64_t terms = runner.Scale(NestedCorpusTerms);
+	TimeFlat(
+		runner, 
+		std::to_string(NestedCorpusGroups) + " nested groups, " + std::to_string(terms) + " terms each", 
+		GenerateNestedGroupsCorpus(NestedCorpusGroups, terms)
+	);
+
+	uint64_t loops = runner.Scale(ForCorpusLoops);
+	TimeFlat(
+		runner, 
+		std::to_string(loops) + " for loops, " + std::to_string(ForCorpusTerms) + " terms each", 
+		GenerateForHeadersCorpus(loops, ForCorpusTerms)
+	);
+}
+
+}
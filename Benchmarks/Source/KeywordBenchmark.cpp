@@ -0,0 +1,141 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include <map>
+#include <string_view>
+#include <vector>
+
+#include "WaveCompiler/Lexer.h"
+
+#include "Corpus.h"
+#include "Keywords.h"
+
+namespace Wave {
+
+namespace {
+
+/// The keyword lookup the lexer used before keywords were matched with a perfect hash.
+const std::map<std::string, TokenType, std::less<>> s_Reserved =
+{
+	{ "and", TokenType::And },
+	{ "or", TokenType::Or },
+	{ "if", TokenType::If },
+	{ "else", TokenType::Else },
+	{ "true", TokenType::True },
+	{ "false", TokenType::False },
+	{ "for", TokenType::For },
+	{ "in", TokenType::In },
+	{ "while", TokenType::While },
+	{ "break", TokenType::Break },
+	{ "continue", TokenType::Continue },
+	{ "try", TokenType::Try },
+	{ "catch", TokenType::Catch },
+	{ "throw", TokenType::Throw },
+	{ "enum", TokenType::Enum },
+	{ "tuple", TokenType::Tuple },
+	{ "class", TokenType::Class },
+	{ "construct", TokenType::Construct },
+	{ "abstract", TokenType::Abstract },
+	{ "static", TokenType::Static },
+	{ "copy", TokenType::Copy },
+	{ "const", TokenType::Const },
+	{ "public", TokenType::Public },
+	{ "protected", TokenType::Protected },
+	{ "private", TokenType::Private },
+	{ "self", TokenType::Self },
+	{ "super", TokenType::Super },
+	{ "func", TokenType::Function },
+	{ "return", TokenType::Return },
+	{ "var", TokenType::Variable },
+	{ "type", TokenType::Type },
+	{ "typeof", TokenType::TypeOf },
+	{ "int", TokenType::IntegerType },
+	{ "real", TokenType::RealType },
+	{ "char", TokenType::CharType },
+	{ "bool", TokenType::BoolType },
+	{ "module", TokenType::Module },
+	{ "import", TokenType::Import },
+	{ "extern", TokenType::Extern },
+	{ "as", TokenType::As },
+	{ "export", TokenType::Export }
+};
+
+/// Split source into its words.
+///
+/// \param source The source, with words separated by spaces and newlines.
+///
+/// \return The words.
+std::vector<std::string_view> SplitWords(const std::string& source)
+{
+	std::vector<std::string_view> words;
+	uint64_t start = 0;
+	for (uint64_t i = 0; i <= source.size(); i++)
+	{
+		if (i == source.size() || source[i] == ' ' || source[i] == '\n')
+		{
+			if (i > start) { words.emplace_back(source.data() + start, i - start); }
+			start = i + 1;
+		}
+	}
+
+	return words;
+}
+
+}
+
+void RunKeywordBenchmark(BenchmarkRunner& runner)
+{
+	auto source = GenerateWordsCorpus(runner.Scale(WordsCorpusWords));
+	auto words = SplitWords(source);
+
+	runner.Section("Keywords: " + std::to_string(words.size()) + " words, about a third of them keywords");
+
+	uint64_t mapKeywords = 0;
+	double map = runner.Time([&]() {
+		mapKeywords = 0;
+		for (auto word : words)
+		{
+			auto reserved = s_Reserved.find(word);
+			if (reserved != s_Reserved.end()) { mapKeywords += static_cast<uint64_t>(reserved->second); }
+		}
+		DoNotOptimize(mapKeywords);
+	});
+	runner.Report("classify each word, std::map", map);
+
+	uint64_t hashKeywords = 0;
+	double hash = runner.Time([&]() {
+		hashKeywords = 0;
+		for (auto word : words)
+		{
+			auto type = MatchKeyword(word.data(), word.size());
+			if (type != TokenType::Identifier) { hashKeywords += static_cast<uint64_t>(type); }
+		}
+		DoNotOptimize(hashKeywords);
+	});
+	runner.Report("classify each word, perfect hash", hash);
+	runner.Check(hashKeywords == mapKeywords, "the perfect hash and std::map found different keywords");
+
+	CompileContext context;
+	FileID file = AddSource(context, "words.wve", source);
+	double lex = runner.Time([&]() {
+		Lexer lexer(context, file);
+		lexer.Lex();
+		DoNotOptimize(lexer.GetTokens().size());
+	});
+	runner.ReportThroughput("lex the whole corpus", lex, source.size());
+}
+
+}
@@ -0,0 +1,75 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "WaveCompiler/Lexer.h"
+#include "WaveCompiler/SourceManager.h"
+
+#include "Corpus.h"
+
+namespace fs = std::filesystem;
+
+namespace Wave {
+
+void RunLexerBenchmark(BenchmarkRunner& runner)
+{
+	uint64_t functions = runner.Scale(MixedCorpusFunctions);
+	auto source = GenerateMixedCorpus(functions);
+
+	// The mapped buffer needs a file to map, so the corpus is written out first.
+	auto path = fs::temp_directory_path() / "wavebench_lexer.wve";
+	{
+		std::ofstream file(path, std::ios::binary);
+		file.write(source.data(), static_cast<std::streamsize>(source.size()));
+		if (!file)
+		{
+			runner.Check(false, "could not write '" + path.string() + "'");
+			return;
+		}
+	}
+
+	runner.Section("Lexer: mixed source, " + std::to_string(functions) + " functions, loading and lexing the file");
+
+	// Each run loads the file again, as the driver does once per file.
+	CompileContext context;
+	uint64_t streamTokens = 0;
+	double stream = runner.Time([&]() {
+		std::ifstream file(path, std::ios::binary);
+		Lexer lexer(context, path, file);
+		lexer.Lex();
+		streamTokens = lexer.GetTokens().size();
+	});
+	runner.ReportThroughput("std::istream constructor", stream, source.size());
+
+	uint64_t bufferTokens = 0;
+	bool mapped = false;
+	double buffer = runner.Time([&]() {
+		FileID file = context.GetSources().AddFile(path);
+		mapped = context.GetSources().GetBuffer(file).IsMapped();
+		Lexer lexer(context, file);
+		lexer.Lex();
+		bufferTokens = lexer.GetTokens().size();
+	});
+	runner.ReportThroughput(mapped ? "source buffer constructor, mapped" : "source buffer constructor, read", buffer, source.size());
+
+	std::error_code error;
+	fs::remove(path, error);
+	runner.Check(streamTokens == bufferTokens, "the two constructors lexed different tokens");
+}
+
+}
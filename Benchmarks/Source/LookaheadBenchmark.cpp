@@ -0,0 +1,75 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include "WaveCompiler/Parser/Parser.h"
+
+#include "Corpus.h"
+
+namespace Wave {
+
+namespace {
+
+/// Time parsing a source, after lexing it once.
+///
+/// \param runner The runner.
+/// \param name What the source is.
+/// \param source The source, which must have no errors.
+void TimeParse(BenchmarkRunner& runner, const std::string& name, const std::string& source)
+{
+	CompileContext context;
+	Lexer lexer(context, AddSource(context, "lookahead.wve", source));
+	lexer.Lex();
+
+	uint64_t diagnostics = 0;
+	double parse = runner.Time([&]() {
+		Parser parser(context, lexer);
+		parser.Parse();
+		diagnostics = parser.GetDiagnostics().size();
+	});
+
+	runner.ReportThroughput(name, parse, source.size());
+	runner.Check(diagnostics == 0, name + " did not parse");
+}
+
+}
+
+void RunLookaheadBenchmark(BenchmarkRunner& runner)
+{
+	runner.Section("Lookahead: parse only");
+
+	uint64_t terms = runner.Scale(NestedCorpusTerms);
+	TimeParse(
+		runner, 
+		std::to_string(NestedCorpusGroups) + " nested groups, " + std::to_string(terms) + " terms each", 
+		GenerateNestedGroupsCorpus(NestedCorpusGroups, terms)
+	);
+
+	uint64_t loops = runner.Scale(ForCorpusLoops);
+	TimeParse(
+		runner, 
+		std::to_string(loops) + " for loops, " + std::to_string(ForCorpusTerms) + " terms each", 
+		GenerateForHeadersCorpus(loops, ForCorpusTerms)
+	);
+
+	uint64_t functions = runner.Scale(MixedCorpusFunctions);
+	TimeParse(
+		runner, 
+		"mixed source, " + std::to_string(functions) + " functions", 
+		GenerateMixedCorpus(functions)
+	);
+}
+
+}
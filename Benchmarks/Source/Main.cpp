@@ -0,0 +1,147 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Corpus.h"
+
+using namespace Wave;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr Benchmark Benchmarks[] = {
+	{ "lexer", "Lexing a file through the std::istream and the source buffer constructors", RunLexerBenchmark },
+	{ "keywords", "Keyword recognition, perfect hash against std::map", RunKeywordBenchmark },
+	{ "errors", "Parsing with a syntax error every 1, 10, 100 and 1000 statements", RunErrorRecoveryBenchmark },
+	{ "lookahead", "Parsing nested groups and long for loop headers", RunLookaheadBenchmark },
+	{ "astformat", "Loading a module from its binary AST, against lexing and parsing it", RunASTFormatBenchmark },
+	{ "flatast", "Flattening the AST, and walking it in both forms", RunFlatASTBenchmark },
+	{ "visitors", "Walking the AST with ASTVisitor and with StaticVisitor", RunVisitorBenchmark },
+	{ "parsermemory", "Heap allocations and time of parsing, and short lists against SmallVector", RunParserMemoryBenchmark },
+};
+
+void OutputHelp()
+{
+	printf(
+R"(Wave compiler benchmarks
+
+Usage: wavebench [option/benchmark] [option/benchmark] ...
+
+Runs the named benchmarks, or all of them if none are named.
+Every benchmark generates its own corpus, so nothing has to be set up first.
+
+Options:
+  -h, --help                       Show this help message, and exit
+  -list                            List the benchmarks, and exit
+  -runs=<N>                        Repeat each measurement N times and report the fastest, 5 by default
+  -scale=<factor>                  Multiply the size of every corpus by <factor>, 1 by default
+  -write-corpus=<dir>              Write every corpus to <dir> as .wve files, to compile with wavec, and exit
+)"
+	);
+}
+
+[[noreturn]] void Fail(const char* message, const char* argument)
+{
+	fprintf(stderr, "wavebench: %s: '%s'\n", message, argument);
+	exit(1);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t runs = 5;
+	double scale = 1.0;
+	fs::path corpusDirectory;
+	std::vector<const Benchmark*> selected;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (argv[i][0] != '-')
+		{
+			auto benchmark = std::find_if(std::begin(Benchmarks), std::end(Benchmarks), [&](const Benchmark& benchmark) {
+				return strcmp(benchmark.Name, argv[i]) == 0;
+			});
+			if (benchmark == std::end(Benchmarks)) { Fail("unknown benchmark", argv[i]); }
+
+			selected.push_back(benchmark);
+		}
+		else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+		{
+			OutputHelp();
+			return 0;
+		}
+		else if (strcmp(argv[i], "-list") == 0)
+		{
+			for (auto& benchmark : Benchmarks) { printf("%-16s %s\n", benchmark.Name, benchmark.Description); }
+			return 0;
+		}
+		else if (strncmp(argv[i], "-runs=", 6) == 0)
+		{
+			char* end;
+			long count = strtol(argv[i] + 6, &end, 10);
+			if (*end != '\0' || count <= 0) { Fail("invalid run count", argv[i] + 6); }
+
+			runs = static_cast<uint32_t>(count);
+		}
+		else if (strncmp(argv[i], "-scale=", 7) == 0)
+		{
+			char* end;
+			scale = strtod(argv[i] + 7, &end);
+			if (*end != '\0' || !(scale > 0.0)) { Fail("invalid scale", argv[i] + 7); }
+		}
+		else if (strncmp(argv[i], "-write-corpus=", 14) == 0)
+		{
+			corpusDirectory = argv[i] + 14;
+		}
+		else
+		{
+			Fail("unknown option", argv[i]);
+		}
+	}
+
+	BenchmarkRunner runner(runs, scale);
+
+	if (!corpusDirectory.empty())
+	{
+		fs::create_directories(corpusDirectory);
+		for (auto& [name, source] : GenerateCorpora(runner))
+		{
+			std::ofstream file(corpusDirectory / name, std::ios::binary);
+			file.write(source.data(), source.size());
+			if (!file) { Fail("could not write corpus", (corpusDirectory / name).string().c_str()); }
+		}
+
+		return 0;
+	}
+
+	if (selected.empty())
+	{
+		for (auto& benchmark : Benchmarks) { selected.push_back(&benchmark); }
+	}
+
+	for (auto* benchmark : selected) { benchmark->Run(runner); }
+
+	return runner.HasFailed() ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "WaveCompiler/MemoryTracker.h"
+#include "WaveCompiler/Parser/Parser.h"
+#include "WaveCompiler/SmallVector.h"
+
+#include "Corpus.h"
+
+namespace Wave {
+
+namespace {
+
+/// Default number of lists built by the short lists measurement.
+constexpr uint64_t ShortListCount = 1000000;
+
+/// Longest short list, cycling through every length up to it.
+/// Lists longer than the 4 elements SmallVector keeps inline go to the heap.
+constexpr uint64_t ShortListMaxLength = 6;
+
+/// Get what was counted in a phase while running a function, with tracking on.
+///
+/// \param phase The phase.
+/// \param function The function.
+///
+/// \return The counts.
+MemoryPhaseStats Track(MemoryPhase phase, const std::function<void()>& function)
+{
+	bool enabled = MemoryTracker::IsEnabled();
+	auto start = MemoryTracker::GetStats(phase);
+	MemoryTracker::SetEnabled(true);
+	function();
+	MemoryTracker::SetEnabled(enabled);
+
+	auto stats = MemoryTracker::GetStats(phase);
+	stats.Allocations -= start.Allocations;
+	stats.Bytes -= start.Bytes;
+	stats.Frees -= start.Frees;
+	stats.FreedBytes -= start.FreedBytes;
+	stats.Items -= start.Items;
+	return stats;
+}
+
+/// Count what the parser allocates for a source, and time parsing it and freeing its AST.
+///
+/// \param runner The runner.
+/// \param name What the source is.
+/// \param source The source, which must have no errors.
+void TimeParse(BenchmarkRunner& runner, const std::string& name, const std::string& source)
+{
+	CompileContext context;
+	Lexer lexer(context, AddSource(context, "memory.wve", source));
+	lexer.Lex();
+
+	uint64_t diagnostics = 0;
+	auto parse = [&]() {
+		Parser parser(context, lexer);
+		parser.Parse();
+		diagnostics = parser.GetDiagnostics().size();
+	};
+
+	// Tracking costs time, so allocations are counted in a run of their own.
+	auto stats = Track(MemoryPhase::Parser, parse);
+	double time = runner.Time(parse);
+
+	runner.Section("Parser memory: " + name);
+	runner.ReportValue("AST nodes", std::to_string(stats.Items));
+	runner.ReportValue("Heap allocations", std::to_string(stats.Allocations));
+	runner.ReportValue("Allocations per node", std::to_string(double(stats.Allocations) / double(std::max<uint64_t>(stats.Items, 1))));
+	runner.ReportValue("Bytes allocated", std::to_string(stats.Bytes));
+	runner.ReportThroughput("Parse and free the AST", time, source.size());
+	runner.Check(diagnostics == 0, name + " did not parse");
+}
+
+/// Build short lists of pointers one element at a time, like the parser builds the lists of the AST.
+///
+/// \tparam List The list type.
+/// \param count Number of lists.
+///
+/// \return A sum of the lists, so they are not optimized away.
+template<typename List>
+uint64_t BuildShortLists(uint64_t count)
+{
+	uint64_t sum = 0;
+	for (uint64_t i = 0; i < count; i++)
+	{
+		List list;
+		for (uint64_t j = 0; j < i % (ShortListMaxLength + 1); j++) { list.push_back(reinterpret_cast<Expression*>(j + 1)); }
+		sum += list.size();
+	}
+
+	return sum;
+}
+
+/// Count the allocations of building short lists, and time it.
+///
+/// \param runner The runner.
+/// \param name The list type.
+/// \param count Number of lists.
+template<typename List>
+void TimeShortLists(BenchmarkRunner& runner, const std::string& name, uint64_t count)
+{
+	auto stats = Track(MemoryPhase::Other, [&]() { DoNotOptimize(BuildShortLists<List>(count)); });
+	double time = runner.Time([&]() { DoNotOptimize(BuildShortLists<List>(count)); });
+	runner.Report(name, time, std::to_string(stats.Allocations) + " allocations");
+}
+
+}
+
+void RunParserMemoryBenchmark(BenchmarkRunner& runner)
+{
+	uint64_t functions = runner.Scale(MixedCorpusFunctions);
+	TimeParse(runner, "mixed source, " + std::to_string(functions) + " functions", GenerateMixedCorpus(functions));
+
+	uint64_t terms = runner.Scale(NestedCorpusTerms);
+	TimeParse(
+		runner, 
+		std::to_string(NestedCorpusGroups) + " nested groups, " + std::to_string(terms) + " terms each", 
+		GenerateNestedGroupsCorpus(NestedCorpusGroups, terms)
+	);
+
+	uint64_t loops = runner.Scale(ForCorpusLoops);
+	TimeParse(
+		runner, 
+		std::to_string(loops) + " for loops, " + std::to_string(ForCorpusTerms) + " terms each", 
+		GenerateForHeadersCorpus(loops, ForCorpusTerms)
+	);
+
+	uint64_t lists = runner.Scale(ShortListCount);
+	runner.Section(
+		"Parser memory: " + std::to_string(lists) + " lists of 0 to " + std::to_string(ShortListMaxLength) + " elements"
+	);
+	TimeShortLists<std::vector<Expression*>>(runner, "std::vector", lists);
+	TimeShortLists<SmallVector<Expression*, 4>>(runner, "SmallVector, 4 inline", lists);
+}
+
+}
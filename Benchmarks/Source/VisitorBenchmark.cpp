@@ -0,0 +1,307 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include <vector>
+
+#include "WaveCompiler/Parser/Parser.h"
+#include "WaveCompiler/Parser/StaticVisitor.h"
+
+#include "Corpus.h"
+
+namespace Wave {
+
+namespace {
+
+/// Worklist of nodes still to visit, which both walkers push the children of every node onto.
+/// Visiting does nothing else, so the walks time the dispatch and the pointer chasing.
+class ChildQueue
+{
+public:
+	/// Queue the global definitions of a module.
+	///
+	/// \param module The module.
+	void PushModule(Module& module)
+	{
+		for (auto& def : module.Definitions) { Push(def.Def); }
+	}
+
+	/// Get the number of nodes visited.
+	///
+	/// \return The number of nodes.
+	uint64_t GetVisited() const { return m_Visited; }
+
+protected:
+	void Push(Statement* node) { if (node) { m_Pending.emplace_back(node); } }
+	void Push(Expression* node) { if (node) { m_Pending.emplace_back(node); } }
+	void Push(Type* node) { if (node) { m_Pending.emplace_back(node); } }
+
+	template<typename T>
+	void Push(const std::vector<T*>& nodes)
+	{
+		for (auto node : nodes) { Push(node); }
+	}
+
+	template<typename T, uint32_t N>
+	void Push(const SmallVector<T*, N>& nodes)
+	{
+		for (auto node : nodes) { Push(node); }
+	}
+
+	template<uint32_t N>
+	void Push(const SmallVector<Parameter, N>& params)
+	{
+		for (auto& param : params) { Push(param.DataType); }
+	}
+
+	/// Nodes without children.
+	template<typename T>
+	void PushChildren(T&) { m_Visited++; }
+
+	void PushChildren(Abstract& node) { m_Visited++; Push(node.Params); Push(node.ReturnType); }
+	void PushChildren(ArrayIndex& node) { m_Visited++; Push(node.Index); }
+	void PushChildren(ArrayType& node) { m_Visited++; Push(node.HoldType); Push(node.Size); }
+	void PushChildren(Assignment& node) { m_Visited++; Push(node.Value); }
+	void PushChildren(Binary& node) { m_Visited++; Push(node.Left); Push(node.Right); }
+	void PushChildren(Block& node) { m_Visited++; Push(node.Statements); }
+	void PushChildren(Call& node) { m_Visited++; Push(node.Callee); Push(node.Args); }
+
+	void PushChildren(ClassDefinition& node)
+	{
+		m_Visited++;
+		Push(node.Public);
+		Push(node.Protected);
+		Push(node.Private);
+	}
+
+	void PushChildren(ConditionFor& node)
+	{
+		m_Visited++;
+		std::visit([this](auto init) { Push(init); }, node.Condition.Initializer);
+		Push(node.Condition.Condition);
+		Push(node.Condition.Increment);
+		Push(node.ExecBlock);
+	}
+
+	void PushChildren(Constructor& node) { m_Visited++; Push(node.Params); Push(node.ExecBlock); }
+	void PushChildren(ExpressionStatement& node) { m_Visited++; Push(node.Expr); }
+
+	void PushChildren(Function& node)
+	{
+		m_Visited++;
+		Push(node.Params);
+		Push(node.ReturnType);
+		Push(node.ExecBlock);
+	}
+
+	void PushChildren(FunctionDefinition& node) { m_Visited++; Push(node.Func); }
+	void PushChildren(FuncType& node) { m_Visited++; Push(node.ReturnType); Push(node.ParamTypes); }
+	void PushChildren(Getter& node) { m_Visited++; Push(node.GetType); Push(node.ExecBlock); }
+	void PushChildren(Group& node) { m_Visited++; Push(node.Expr); }
+
+	void PushChildren(If& node)
+	{
+		m_Visited++;
+		Push(node.Condition);
+		Push(node.True);
+		for (auto& elseIf : node.ElseIfs)
+		{
+			Push(elseIf.Condition);
+			Push(elseIf.True);
+		}
+		Push(node.Else);
+	}
+
+	void PushChildren(InitializerList& node) { m_Visited++; Push(node.Data); }
+	void PushChildren(Logical& node) { m_Visited++; Push(node.Left); Push(node.Right); }
+	void PushChildren(Method& node) { m_Visited++; Push(node.Def); }
+
+	void PushChildren(OperatorOverload& node)
+	{
+		m_Visited++;
+		Push(node.Left.DataType);
+		Push(node.Right.DataType);
+		Push(node.ReturnType);
+		Push(node.ExecBlock);
+	}
+
+	void PushChildren(RangeFor& node) { m_Visited++; Push(node.Condition.Range); Push(node.ExecBlock); }
+	void PushChildren(Return& node) { m_Visited++; Push(node.Value); }
+	void PushChildren(Setter& node) { m_Visited++; Push(node.SetParam.DataType); Push(node.ExecBlock); }
+	void PushChildren(Throw& node) { m_Visited++; Push(node.Value); }
+
+	void PushChildren(Try& node)
+	{
+		m_Visited++;
+		Push(node.ExecBlock);
+		for (auto& c : node.Catches)
+		{
+			Push(c.Param.DataType);
+			Push(c.ExecBlock);
+		}
+	}
+
+	void PushChildren(TupleType& node) { m_Visited++; Push(node.Types); }
+	void PushChildren(TypeOf& node) { m_Visited++; Push(node.Expr); }
+	void PushChildren(Unary& node) { m_Visited++; Push(node.Right); }
+	void PushChildren(VarDefinition& node) { m_Visited++; Push(node.DataType); Push(node.Value); }
+	void PushChildren(While& node) { m_Visited++; Push(node.Condition); Push(node.ExecBlock); }
+
+	std::vector<ASTNode> m_Pending;
+	uint64_t m_Visited = 0;
+};
+
+/// Walks the AST through the virtual calls of ASTVisitor.
+class VirtualWalker : public ASTVisitor, public ChildQueue
+{
+public:
+	/// Visit queued nodes until there are none left.
+	void Run()
+	{
+		while (!m_Pending.empty())
+		{
+			auto node = m_Pending.back();
+			m_Pending.pop_back();
+			std::visit([this](auto n) { n->Accept(*this, m_Context); }, node);
+		}
+	}
+
+	void Visit(Abstract& node, std::any&) override { PushChildren(node); }
+	void Visit(ArrayIndex& node, std::any&) override { PushChildren(node); }
+	void Visit(ArrayType& node, std::any&) override { PushChildren(node); }
+	void Visit(Assignment& node, std::any&) override { PushChildren(node); }
+	void Visit(Binary& node, std::any&) override { PushChildren(node); }
+	void Visit(Block& node, std::any&) override { PushChildren(node); }
+	void Visit(Break& node, std::any&) override { PushChildren(node); }
+	void Visit(Call& node, std::any&) override { PushChildren(node); }
+	void Visit(ClassDefinition& node, std::any&) override { PushChildren(node); }
+	void Visit(ClassType& node, std::any&) override { PushChildren(node); }
+	void Visit(ConditionFor& node, std::any&) override { PushChildren(node); }
+	void Visit(Constructor& node, std::any&) override { PushChildren(node); }
+	void Visit(Continue& node, std::any&) override { PushChildren(node); }
+	void Visit(EnumDefinition& node, std::any&) override { PushChildren(node); }
+	void Visit(ExpressionStatement& node, std::any&) override { PushChildren(node); }
+	void Visit(Function& node, std::any&) override { PushChildren(node); }
+	void Visit(FunctionDefinition& node, std::any&) override { PushChildren(node); }
+	void Visit(FuncType& node, std::any&) override { PushChildren(node); }
+	void Visit(Getter& node, std::any&) override { PushChildren(node); }
+	void Visit(Group& node, std::any&) override { PushChildren(node); }
+	void Visit(If& node, std::any&) override { PushChildren(node); }
+	void Visit(InitializerList& node, std::any&) override { PushChildren(node); }
+	void Visit(Literal& node, std::any&) override { PushChildren(node); }
+	void Visit(Logical& node, std::any&) override { PushChildren(node); }
+	void Visit(Method& node, std::any&) override { PushChildren(node); }
+	void Visit(OperatorOverload& node, std::any&) override { PushChildren(node); }
+	void Visit(RangeFor& node, std::any&) override { PushChildren(node); }
+	void Visit(Return& node, std::any&) override { PushChildren(node); }
+	void Visit(Setter& node, std::any&) override { PushChildren(node); }
+	void Visit(SimpleType& node, std::any&) override { PushChildren(node); }
+	void Visit(Throw& node, std::any&) override { PushChildren(node); }
+	void Visit(Try& node, std::any&) override { PushChildren(node); }
+	void Visit(TupleType& node, std::any&) override { PushChildren(node); }
+	void Visit(TypeOf& node, std::any&) override { PushChildren(node); }
+	void Visit(Unary& node, std::any&) override { PushChildren(node); }
+	void Visit(VarAccess& node, std::any&) override { PushChildren(node); }
+	void Visit(VarDefinition& node, std::any&) override { PushChildren(node); }
+	void Visit(While& node, std::any&) override { PushChildren(node); }
+
+private:
+	std::any m_Context;
+};
+
+/// Walks the AST through the kind dispatch of StaticVisitor.
+class StaticWalker : public StaticVisitor<StaticWalker>, public ChildQueue
+{
+public:
+	/// Visit queued nodes until there are none left.
+	void Run()
+	{
+		while (!m_Pending.empty())
+		{
+			auto node = m_Pending.back();
+			m_Pending.pop_back();
+			std::visit([this](auto n) { Dispatch(*n); }, node);
+		}
+	}
+
+	template<typename T>
+	void Visit(T& node) { PushChildren(node); }
+};
+
+/// Time walking the AST of a source with both visitors.
+///
+/// \param runner The runner.
+/// \param name What the source is.
+/// \param source The source, which must have no errors.
+void TimeWalks(BenchmarkRunner& runner, const std::string& name, const std::string& source)
+{
+	CompileContext context;
+	Lexer lexer(context, AddSource(context, "visitor.wve", source));
+	lexer.Lex();
+	Parser parser(context, lexer);
+	parser.Parse();
+	if (!parser.GetDiagnostics().empty())
+	{
+		runner.Check(false, name + " did not parse");
+		return;
+	}
+
+	auto& module = *parser.GetModule();
+	uint64_t virtualNodes = 0;
+	double virtualWalk = runner.Time([&]() {
+		VirtualWalker walker;
+		walker.PushModule(module);
+		walker.Run();
+		virtualNodes = walker.GetVisited();
+	});
+
+	uint64_t staticNodes = 0;
+	double staticWalk = runner.Time([&]() {
+		StaticWalker walker;
+		walker.PushModule(module);
+		walker.Run();
+		staticNodes = walker.GetVisited();
+	});
+
+	runner.Section("Visitors: " + name);
+	runner.ReportValue("Nodes", std::to_string(staticNodes));
+	runner.Report("ASTVisitor walk", virtualWalk);
+	runner.Report("StaticVisitor walk", staticWalk);
+	runner.Check(virtualNodes == staticNodes, name + ": the walks visited different nodes");
+}
+
+}
+
+void RunVisitorBenchmark(BenchmarkRunner& runner)
+{
+	uint64_t functions = runner.Scale(MixedCorpusFunctions);
+	TimeWalks(runner, "mixed source, " + std::to_string(functions) + " functions", GenerateMixedCorpus(functions));
+
+	uint64_t terms = runner.Scale(NestedCorpusTerms);
+	TimeWalks(
+		runner, 
+		std::to_string(NestedCorpusGroups) + " nested groups, " + std::to_string(terms) + " terms each", 
+		GenerateNestedGroupsCorpus(NestedCorpusGroups, terms)
+	);
+
+	uint64_t loops = runner.Scale(ForCorpusLoops);
+	TimeWalks(
+		runner, 
+		std::to_string(loops) + " for loops, " + std::to_string(ForCorpusTerms) + " terms each", 
+		GenerateForHeadersCorpus(loops, ForCorpusTerms)
+	);
+}
+
+}
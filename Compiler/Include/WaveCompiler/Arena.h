@@ -0,0 +1,122 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Global.h"
+
+namespace Wave {
+
+/// Bump-pointer allocator which owns every object created in it.
+/// Objects are never freed one by one: when the arena is destroyed, the destructors
+/// of objects which need one are run in a single pass, and the memory is freed in blocks.
+class Arena
+{
+public:
+	Arena() = default;
+
+	/// Destroy all objects and free the memory.
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	/// Construct an object in the arena.
+	///
+	/// \tparam T Type of the object.
+	/// \param args Arguments to pass to the constructor.
+	/// 
+	/// \return The object, which lives as long as the arena.
+	template<typename T, typename... Args>
+	T* Make(Args&&... args)
+	{
+		T* object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if constexpr (!std::is_trivially_destructible_v<T>)
+		{
+			// The list of destructors lives in the arena too, so registering one never reallocates.
+			auto destructor = new (Allocate(sizeof(Destructor), alignof(Destructor))) Destructor;
+			destructor->Object = object;
+			destructor->Destroy = [](void* o) { static_cast<T*>(o)->~T(); };
+			destructor->Next = m_Destructors;
+			m_Destructors = destructor;
+		}
+
+		m_ObjectCount++;
+		return object;
+	}
+
+	/// Allocate uninitialized memory in the arena.
+	///
+	/// \param size Size of the memory in bytes.
+	/// \param alignment Alignment of the memory, must be a power of two.
+	/// 
+	/// \return The memory.
+	void* Allocate(uint64_t size, uint64_t alignment)
+	{
+		auto address = reinterpret_cast<uintptr_t>(m_Cur);
+		uint64_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+		if (padding + size > static_cast<uint64_t>(m_End - m_Cur)) { return AllocateBlock(size); }
+
+		char* memory = m_Cur + padding;
+		m_Cur = memory + size;
+		m_BytesUsed += size;
+		return memory;
+	}
+
+	/// Get the number of objects created with Make().
+	///
+	/// \return The number of objects.
+	uint64_t GetObjectCount() const { return m_ObjectCount; }
+
+	/// Get the number of blocks allocated from the heap.
+	///
+	/// \return The number of blocks.
+	uint64_t GetBlockCount() const { return m_Blocks.size(); }
+
+	/// Get the number of bytes handed out by the arena.
+	///
+	/// \return The number of bytes.
+	uint64_t GetBytesUsed() const { return m_BytesUsed; }
+
+private:
+	/// Start a new block and allocate from it.
+	///
+	/// \param size Size of the memory in bytes.
+	/// 
+	/// \return The memory.
+	void* AllocateBlock(uint64_t size);
+
+	struct Destructor
+	{
+		void* Object;
+		void (*Destroy)(void*);
+		Destructor* Next;
+	};
+
+	std::vector<std::unique_ptr<char[]>> m_Blocks;
+	Destructor* m_Destructors = nullptr;
+	char* m_Cur = nullptr;
+	char* m_End = nullptr;
+	uint64_t m_ObjectCount = 0;
+	uint64_t m_BytesUsed = 0;
+};
+
+}
@@ -0,0 +1,142 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <vector>
+
+#include "Parser/AST.h"
+
+namespace Wave {
+
+/// What is kept of compiling one file: enough to report it and to place it in the module graph.
+struct CachedFile
+{
+	/// If the file had errors.
+	bool Failed = false;
+
+	/// If the file got as far as being parsed.
+	bool Parsed = false;
+
+	/// Name the module was defined with.
+	Identifier Name;
+
+	/// Modules the file imports.
+	std::vector<ModuleImport> Imports;
+
+	/// Diagnostics of the lexer and the parser.
+	std::vector<Diagnostic> Diagnostics;
+};
+
+/// On-disk cache of compiled files, so that unchanged files are not lexed and parsed again.
+///
+/// Entries are keyed by a hash of the contents of the file and the version of the compiler,
+/// so they are shared by every copy of a file, and can never be stale.
+/// Using an entry marks it as recently used, and Prune() evicts the least recently used entries
+/// once the cache is larger than its size limit.
+///
+/// Loading and storing are thread-safe, and entries are written to a temporary file and moved in place,
+/// so any number of compilers can share a cache.
+class BuildCache
+{
+public:
+	/// Open a cache, creating its directory if it does not exist.
+	///
+	/// \param context The context files are compiled in.
+	/// \param directory The directory entries are kept in.
+	/// \param maxSize The size the cache is pruned to, in bytes.
+	BuildCache(CompileContext& context, const std::filesystem::path& directory, uint64_t maxSize);
+
+	BuildCache(const BuildCache&) = delete;
+	BuildCache& operator=(const BuildCache&) = delete;
+
+	/// Check if the cache directory could be created.
+	///
+	/// \return If entries can be loaded and stored.
+	bool IsValid() const { return m_Valid; }
+
+	/// Hash a buffer. Fast enough to hash every source file on every run.
+	///
+	/// \param data The buffer.
+	/// \param size Size of the buffer.
+	/// \param seed Seed of the hash.
+	/// 
+	/// \return The hash.
+	static uint64_t Hash(const char* data, uint64_t size, uint64_t seed = 0);
+
+	/// Load the entry of a file.
+	/// An entry holds the module name, the imports and the diagnostics, not the tokens of the file.
+	/// The name and import paths, and the markers of the diagnostics, are placed in the file,
+	/// and the symbols of the paths are interned again.
+	///
+	/// \param file The file.
+	/// \param result Receives the entry.
+	/// 
+	/// \return If the file has an entry.
+	bool Load(FileID file, CachedFile& result);
+
+	/// Store the entry of a file.
+	///
+	/// \param file The file.
+	/// \param result What came of compiling the file.
+	void Store(FileID file, const CachedFile& result);
+
+	/// Evict the least recently used entries until the cache fits its size limit.
+	void Prune();
+
+	/// Get the number of files which had an entry.
+	///
+	/// \return The number of hits.
+	uint64_t GetHits() const { return m_Hits; }
+
+	/// Get the number of files which had no entry.
+	///
+	/// \return The number of misses.
+	uint64_t GetMisses() const { return m_Misses; }
+
+	/// Get the number of entries evicted by Prune().
+	///
+	/// \return The number of evictions.
+	uint64_t GetEvictions() const { return m_Evictions; }
+
+	/// Get the number of bytes of entries written.
+	///
+	/// \return The number of bytes.
+	uint64_t GetBytesWritten() const { return m_BytesWritten; }
+
+private:
+	/// Get the path of the entry of a file.
+	///
+	/// \param file The file.
+	/// 
+	/// \return The path.
+	std::filesystem::path GetEntryPath(FileID file) const;
+
+	CompileContext& m_Context;
+	std::filesystem::path m_Directory;
+	uint64_t m_MaxSize;
+	uint64_t m_Seed;
+	uint64_t m_TempID;
+	bool m_Valid = false;
+
+	std::atomic<uint64_t> m_Hits = 0;
+	std::atomic<uint64_t> m_Misses = 0;
+	std::atomic<uint64_t> m_Evictions = 0;
+	std::atomic<uint64_t> m_BytesWritten = 0;
+	std::atomic<uint64_t> m_NextTemp = 0;
+};
+
+}
@@ -15,11 +15,15 @@
 #pragma once
 
 #include "Global.h"
+#include "SourceManager.h"
+#include "Statistics.h"
+#include "SymbolTable.h"
+#include "Timer.h"
 
 namespace Wave {
 
 /// Class for storage of compiler options,
-/// currently does nothing.
+/// and of the tables shared by everything being compiled.
 class CompileContext
 {
 public:
@@ -37,8 +41,46 @@ public:
 	/// \return If debug ouput is enabled.
 	bool IsDebugOutputEnabled() { return m_DebugOutput; }
 
+	/// Set if lexing and parsing are fused into one pass.
+	/// The parser then pulls tokens from a TokenStream as it needs them,
+	/// instead of the lexer filling a token list for the whole file first.
+	///
+	/// \param on If lexing and parsing are fused. It defaults to false, so fusing is only
+	/// turned on by passing true: SetFusedLexParse() with no argument turns it off.
+	void SetFusedLexParse(bool on = false);
+
+	/// Check if lexing and parsing are fused.
+	///
+	/// \return If fused lex-parse is enabled.
+	bool IsFusedLexParseEnabled() { return m_FusedLexParse; }
+
+	/// Get the source files being compiled, so tokens and diagnostics can refer to them by ID.
+	///
+	/// \return The source manager.
+	SourceManager& GetSources() { return m_Sources; }
+
+	/// Get the table of interned identifiers and strings.
+	///
+	/// \return The symbol table.
+	SymbolTable& GetSymbols() { return m_Symbols; }
+
+	/// Get the statistics counters, which only count once enabled.
+	///
+	/// \return The statistics.
+	Statistics& GetStatistics() { return m_Statistics; }
+
+	/// Get the timers of the compiler phases, which only record once enabled.
+	///
+	/// \return The timer registry.
+	TimerRegistry& GetTimers() { return m_Timers; }
+
 private:
 	bool m_DebugOutput = false;
+	bool m_FusedLexParse = false;
+	SourceManager m_Sources;
+	SymbolTable m_Symbols;
+	TimerRegistry m_Timers;
+	Statistics m_Statistics;
 };
 
 }
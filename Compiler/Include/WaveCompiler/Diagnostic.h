@@ -14,32 +14,36 @@
 
 #pragma once
 
-#include <filesystem>
-#include <fstream>
+#include <cstdint>
 #include <string>
 
 #include "Global.h"
 
 namespace Wave {
 
+/// Identifier of a source file registered with a CompileContext.
+using FileID = uint16_t;
+
 /// A specific position in a specific file.
 struct FileMarker
 {
-	/// Construct a FileMarker from an std::ifstream.
+	/// Construct a FileMarker.
 	///
-	/// \param filePath The path of the file.
-	FileMarker(const std::filesystem::path& filePath)
-		: File(filePath)
+	/// \param file The file the marker points to.
+	/// \param pos Position of the first character.
+	/// \param length Length of the marker.
+	FileMarker(FileID file, uint32_t pos = 0, uint32_t length = 0)
+		: File(file), Pos(pos), Length(length)
 	{}
 
-	/// Path of the file the marker points to.
-	std::filesystem::path File;
+	/// File the marker points to.
+	FileID File;
 
-	/// Position of the first character of the marker. 0 is the first character of the stream.
-	uint64_t Pos = 0;
+	/// Position of the first character of the marker. 0 is the first character of the file.
+	uint32_t Pos = 0;
 
 	/// Length of the marker, including the first character.
-	uint64_t Length = 0;
+	uint32_t Length = 0;
 };
 
 /// Severity of diagnostic.
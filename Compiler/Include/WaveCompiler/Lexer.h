@@ -18,20 +18,22 @@
 #include <istream>
 #include <memory>
 #include <string>
-#include <variant>
 #include <vector>
 
 #include "Global.h"
 #include "CompileContext.h"
 #include "Diagnostic.h"
+#include "SourceBuffer.h"
 
 namespace Wave {
 
 template<typename T>
 using up = std::unique_ptr<T>;
 
+struct ScanKernels;
+
 /// Type of a lexer token.
-enum class TokenType
+enum class TokenType : uint8_t
 {
 	// Single character tokens
 	LeftParenthesis, RightParenthesis, 
@@ -70,38 +72,67 @@ enum class TokenType
 	Null
 };
 
-/// Lexer token.
+/// Get the name of a token type.
+///
+/// \param type The type.
+/// 
+/// \return The name, like 'LeftParenthesis'.
+const char* GetTokenTypeName(TokenType type);
+
+/// Lexer token, packed into 16 bytes.
+/// Identifiers and strings are interned in the SymbolTable of the CompileContext,
+/// and values of number literals are kept in a LiteralTable.
 struct Token
 {
-	Token()
-		: Marker(""), Type(TokenType::Null)
-	{}
+	/// Position of the first character of the token.
+	uint32_t Pos = 0;
 
-	/// Construct a token.
-	///
-	/// \param marker Marker of the token.
-	/// \param type Type of the token.
-	Token(FileMarker marker, TokenType type)
-		: Marker(marker), Type(type)
-	{}
+	/// Length of the token, including the first character.
+	uint32_t Length = 0;
 
-	/// Construct a token.
-	///
-	/// \param marker Marker of the token.
-	/// \param type Type of the token.
-	/// \param value Value of the token.
-	Token(FileMarker marker, TokenType type, const std::variant<std::string, int64_t, double>& value)
-		: Marker(marker), Type(type), Value(value)
-	{}
+	/// Symbol of the token if it is an identifier or a string,
+	/// or index of its value in its LiteralTable if it is a number.
+	uint32_t Value = 0;
+
+	/// File the token is in.
+	FileID File = 0;
 
 	/// Type of the token.
-	TokenType Type;
+	TokenType Type = TokenType::Null;
+
+	/// Unused. Fills the padding so that every byte of a token is set, and tokens can be written out as they are.
+	uint8_t Reserved = 0;
+
+	/// Get a marker spanning the entire token.
+	///
+	/// \return The marker.
+	FileMarker GetMarker() const { return FileMarker(File, Pos, Length); }
+};
+
+static_assert(sizeof(Token) == 16, "Token should be packed into 16 bytes");
 
-	/// Marker of the entire token.
-	FileMarker Marker;
+/// Side tables holding the values of number literal tokens.
+struct LiteralTable
+{
+	/// Values of integer tokens.
+	std::vector<int64_t> Integers;
+
+	/// Values of real tokens.
+	std::vector<double> Reals;
+
+	/// Get the value of an integer token.
+	///
+	/// \param token The token.
+	/// 
+	/// \return The value.
+	int64_t GetInteger(const Token& token) const { return Integers[token.Value]; }
 
-	/// String value of the token.
-	std::variant<std::string, int64_t, double> Value;
+	/// Get the value of a real token.
+	///
+	/// \param token The token.
+	/// 
+	/// \return The value.
+	double GetReal(const Token& token) const { return Reals[token.Value]; }
 };
 
 /// Wave lexer.
@@ -109,25 +140,43 @@ class Lexer
 {
 public:
 	/// Initialize a lexer from an input stream.
+	/// The whole stream is read into a buffer, and registered with the source manager.
 	///
 	/// \param context Compile context to use for lexing.
 	/// \param filePath The path of the file.
 	/// \param stream std::istream to read from.
 	Lexer(CompileContext& context, const std::filesystem::path& filePath, std::istream& stream);
 
-	/// Run the lexical analyzer.
+	/// Initialize a lexer from a file registered with the source manager.
+	///
+	/// \param context Compile context to use for lexing.
+	/// \param file The ID of the file.
+	Lexer(CompileContext& context, FileID file);
+
+	/// Run the lexical analyzer over the whole file, filling the token list.
 	void Lex();
 
+	/// Lex the next token, without adding it to the token list.
+	/// Used to pull tokens on demand instead of running Lex().
+	///
+	/// \return The token. Once the file has ended, every call returns a Null token.
+	Token Next();
+
 	/// Print out all tokens to standard output.
 	void PrettyPrint();
 
 	/// PrettyPrint a specific token.
-	static void PrettyPrint(const Token& token);
+	void PrettyPrint(const Token& token) const;
+
+	/// Print a token with its position, as PrettyPrint() does for each token.
+	///
+	/// \param token The token.
+	void Print(const Token& token) const;
 
 	/// Get the path of the module file.
 	///
 	/// \return The path.
-	const std::filesystem::path& GetPath() const { return m_Marker.File; };
+	const std::filesystem::path& GetPath() const { return m_Source->GetPath(); };
 
 	/// Get the diagnostics from lexical analysis.
 	///
@@ -139,15 +188,24 @@ public:
 	/// \return std::vector of the tokens.
 	const std::vector<Token>& GetTokens() const;
 
+	/// Get the values of the number literal tokens.
+	///
+	/// \return The literal table.
+	const LiteralTable& GetLiterals() const { return m_Literals; }
+
+	/// Get the ID of the file being lexed.
+	///
+	/// \return The file ID.
+	FileID GetFile() const { return m_File; }
+
 private:
-	/// Get the next character in the input stream.
-	/// Update the length of the FileMarker.
+	/// Get the next character in the buffer, and extend the current token over it.
 	/// 
-	/// \return The character.
+	/// \return The character, or '\0' at the end of the buffer.
 	char GetChar();
 
 	/// Look ahead at the next characters.
-	/// Updates the FileMarker if the character was found.
+	/// Extends the current token if the character was found.
 	/// 
 	/// \param c Character to match with.
 	/// 
@@ -156,40 +214,75 @@ private:
 
 	/// Peeks at the next character.
 	///
-	/// \return The next character.
+	/// \return The next character, or '\0' at the end of the buffer.
 	char Peek();
 
-	/// Push a token into the token list.
-	/// Uses the FileMarker to push the token, and resets the marker's state.
+	/// Get a marker spanning the current token.
+	///
+	/// \return The marker.
+	FileMarker GetMarker() const;
+
+	/// Discard the current token, and start the next one at the cursor.
+	void Skip();
+
+	/// Produce a token, ending the current call to Next().
+	/// Uses the current token span to make the token, and starts the next one.
 	/// 
 	/// \param type Type of the token to push.
 	void PushToken(TokenType type);
 
-	/// Push a valued token into the token list.
-	/// Resets the marker's state.
+	/// Produce an identifier or string token.
+	/// Starts the next token.
 	/// 
 	/// \param type Token type.
-	/// \param value Value to push.
-	void PushToken(TokenType type, const std::variant<std::string, int64_t, double>& value);
+	/// \param value Value to intern.
+	void PushToken(TokenType type, std::string_view value);
+
+	/// Produce an integer token.
+	/// Starts the next token.
+	/// 
+	/// \param value Value to push into the literal table.
+	void PushToken(int64_t value);
+
+	/// Produce a real token.
+	/// Starts the next token.
+	/// 
+	/// \param value Value to push into the literal table.
+	void PushToken(double value);
 
 	/// Push a string literal into the token list.
 	void StringLiteral();
 
 	/// Push a number literal into the token list.
-	/// 
-	/// \param c The current character.
-	void NumberLiteral(char c);
+	/// Expects the current token to start at the first digit.
+	void NumberLiteral();
 
 	/// Push an identifier into the token list.
-	///
-	/// \param c The current character.
-	void Identifier(char c);
+	/// Expects the current token to start at the first character.
+	void Identifier();
+
+	/// Produce the Null token at the end of the file.
+	/// Records the statistics of the file the first time.
+	void EndFile();
+
+	/// Add the counts of the lexed tokens to the statistics of the context.
+	void RecordStatistics();
 
 	CompileContext& m_Context;
-	std::istream& m_Stream;
+	const SourceBuffer* m_Source;
+	FileID m_File;
+	const ScanKernels* m_Kernels;
+	const char* m_Begin;
+	const char* m_End;
+	const char* m_Cur;
+	const char* m_Start;
 	std::vector<Diagnostic> m_Diagnostics;
-	FileMarker m_Marker;
+	Token m_Token;
+	bool m_HasToken = false;
+	bool m_Finished = false;
+	uint64_t m_TypeCounts[static_cast<size_t>(TokenType::Null) + 1] = {};
 	std::vector<Token> m_Tokens;
+	LiteralTable m_Literals;
 };
 
 }
@@ -0,0 +1,131 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <ostream>
+
+#include "Global.h"
+
+namespace Wave {
+
+/// Phase of the compiler that heap allocations are attributed to.
+enum class MemoryPhase : uint8_t
+{
+	Other,
+	Lexer,
+	Parser,
+	Diagnostics,
+	Count
+};
+
+/// What was counted in one phase.
+struct MemoryPhaseStats
+{
+	/// Number of allocations.
+	uint64_t Allocations = 0;
+
+	/// Bytes allocated.
+	uint64_t Bytes = 0;
+
+	/// Number of frees.
+	uint64_t Frees = 0;
+
+	/// Bytes freed.
+	uint64_t FreedBytes = 0;
+
+	/// Number of items produced.
+	uint64_t Items = 0;
+};
+
+/// Process-wide accounting of heap allocations, by the phase the allocating thread is in.
+///
+/// The compiler only marks its phases with ScopedMemoryPhase. Counting needs allocation hooks
+/// which call Allocated and Freed, and those are installed by the program, not the library:
+/// the WaveMemoryHooks object library replaces the global operator new and delete to do so,
+/// and is linked into wavec, the tests and the benchmarks.
+///
+/// Each phase counts the allocations made in it, the bytes they took, the bytes it retained
+/// (allocated minus freed while in the phase), and the highest number of live bytes in the process
+/// while a thread was in the phase. Only what happens after tracking is enabled is counted.
+class MemoryTracker
+{
+public:
+	/// Start or stop tracking allocations.
+	///
+	/// \param on If allocations should be counted.
+	static void SetEnabled(bool on) { s_Enabled.store(on, std::memory_order_relaxed); }
+
+	/// Check if allocations are being tracked. Allocation hooks check this before anything else.
+	///
+	/// \return If tracking is on.
+	static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+
+	/// Count an allocation in the phase of the current thread.
+	///
+	/// \param size Usable size of the allocated block.
+	static void Allocated(uint64_t size);
+
+	/// Count a deallocation in the phase of the current thread.
+	///
+	/// \param size Usable size of the freed block.
+	static void Freed(uint64_t size);
+
+	/// Add to the number of items a phase produced, like tokens or AST nodes,
+	/// so that the report can show allocations and bytes per item.
+	///
+	/// \param phase The phase.
+	/// \param count The number of items.
+	static void AddItems(MemoryPhase phase, uint64_t count);
+
+	/// Get what has been counted in a phase so far.
+	///
+	/// \param phase The phase.
+	///
+	/// \return The counts.
+	static MemoryPhaseStats GetStats(MemoryPhase phase);
+
+	/// Print the allocations of every phase as a table.
+	///
+	/// \param stream Stream to print to.
+	static void Print(std::ostream& stream);
+
+private:
+	friend class ScopedMemoryPhase;
+
+	static std::atomic<bool> s_Enabled;
+	static thread_local MemoryPhase s_Phase;
+};
+
+/// Attributes the allocations of the current thread to a phase, until the end of the scope.
+class ScopedMemoryPhase
+{
+public:
+	/// Enter a phase.
+	///
+	/// \param phase The phase.
+	ScopedMemoryPhase(MemoryPhase phase) : m_Previous(MemoryTracker::s_Phase) { MemoryTracker::s_Phase = phase; }
+
+	/// Go back to the phase the thread was in before.
+	~ScopedMemoryPhase() { MemoryTracker::s_Phase = m_Previous; }
+
+	ScopedMemoryPhase(const ScopedMemoryPhase&) = delete;
+	ScopedMemoryPhase& operator=(const ScopedMemoryPhase&) = delete;
+
+private:
+	MemoryPhase m_Previous;
+};
+
+}
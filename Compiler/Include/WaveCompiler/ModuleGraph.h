@@ -0,0 +1,157 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Parser/AST.h"
+
+namespace Wave {
+
+/// Graph of the modules being compiled, with an edge from every module to each module it imports.
+/// Imports of modules which are not being compiled are left out.
+///
+/// Modules which import each other in a cycle are reported, and treated as one unit:
+/// the dependencies of a module never include modules in the same cycle,
+/// so following them always terminates.
+class ModuleGraph
+{
+public:
+	/// Construct an empty graph.
+	///
+	/// \param context The context the modules were parsed in, used to compare and print names.
+	ModuleGraph(CompileContext& context);
+
+	/// Add a parsed module to the graph.
+	///
+	/// \param name The name the module was defined with, empty if it has none.
+	/// \param imports The modules it imports.
+	/// 
+	/// \return The node of the module.
+	uint32_t AddModule(const Identifier& name, const std::vector<ModuleImport>& imports);
+
+	/// Resolve the imports of all added modules, and look for cycles.
+	/// Must be called once, after all modules have been added.
+	void Link();
+
+	/// Get diagnostics for duplicate modules and import cycles.
+	///
+	/// \return std::vector of diagnostics.
+	const std::vector<Diagnostic>& GetDiagnostics() const { return m_Diagnostics; }
+
+	/// Get the number of modules.
+	///
+	/// \return The number of nodes.
+	uint32_t GetSize() const { return static_cast<uint32_t>(m_Nodes.size()); }
+
+	/// Get the modules a module has to wait for.
+	///
+	/// \param node The node.
+	/// 
+	/// \return Nodes of the imported modules, excluding those in the same cycle.
+	const std::vector<uint32_t>& GetDependencies(uint32_t node) const { return m_Nodes[node].Dependencies; }
+
+	/// Get the modules waiting for a module.
+	///
+	/// \param node The node.
+	/// 
+	/// \return Nodes of the importing modules, excluding those in the same cycle.
+	const std::vector<uint32_t>& GetDependents(uint32_t node) const { return m_Nodes[node].Dependents; }
+
+	/// Get the import of a dependency, to point diagnostics at.
+	///
+	/// \param node The importing node.
+	/// \param index Index into GetDependencies(node).
+	/// 
+	/// \return The import.
+	const ModuleImport& GetImport(uint32_t node, uint32_t index) const;
+
+	/// Check if a module imports itself, directly or through other modules.
+	///
+	/// \param node The node.
+	/// 
+	/// \return If the module is part of a cycle.
+	bool IsInCycle(uint32_t node) const { return m_Nodes[node].InCycle; }
+
+	/// Get every node, ordered so that each comes after its dependencies.
+	///
+	/// \return The nodes.
+	const std::vector<uint32_t>& GetOrder() const { return m_Order; }
+
+	/// Get the number of resolved imports, counting each importing module once per imported module.
+	///
+	/// \return The number of edges.
+	uint32_t GetEdgeCount() const { return m_EdgeCount; }
+
+	/// Get the number of import cycles.
+	///
+	/// \return The number of cycles.
+	uint32_t GetCycleCount() const { return m_CycleCount; }
+
+	/// Find the longest chain of modules which each import the next,
+	/// which has to be compiled one module after another however many threads there are.
+	///
+	/// \return Nodes on the chain, dependencies first. Empty if there are no modules.
+	std::vector<uint32_t> GetCriticalPath() const;
+
+	/// Get the most modules at one level, where a module's level is the length of the longest chain of imports below it.
+	/// Modules at the same level do not depend on each other, so can be compiled at the same time.
+	///
+	/// \return The number of modules at the widest level.
+	uint32_t GetMaxWidth() const { return m_MaxWidth; }
+
+private:
+	struct Node
+	{
+		Identifier Name;
+		std::vector<ModuleImport> Declared;
+		std::vector<uint32_t> Imports;
+		std::vector<uint32_t> ImportSites;
+		std::vector<uint32_t> Dependencies;
+		std::vector<uint32_t> DependencySites;
+		std::vector<uint32_t> Dependents;
+		uint32_t Component = 0;
+		uint32_t Level = 0;
+		bool InCycle = false;
+	};
+
+	/// Get the dotted name of a module.
+	///
+	/// \param node The node.
+	/// 
+	/// \return The name, like 'Std.IO'.
+	std::string GetName(uint32_t node) const;
+
+	/// Find strongly connected components, and fill in the order.
+	void FindComponents();
+
+	/// Report the cycle running through a node.
+	///
+	/// \param start The node, which must be in a cycle.
+	void ReportCycle(uint32_t start);
+
+	CompileContext& m_Context;
+	std::vector<Node> m_Nodes;
+	std::map<std::vector<Symbol>, uint32_t> m_Names;
+	std::vector<uint32_t> m_Order;
+	std::vector<Diagnostic> m_Diagnostics;
+	uint32_t m_EdgeCount = 0;
+	uint32_t m_CycleCount = 0;
+	uint32_t m_MaxWidth = 0;
+};
+
+}
@@ -14,7 +14,12 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <variant>
+
+#include "WaveCompiler/Arena.h"
 #include "WaveCompiler/Lexer.h"
+#include "WaveCompiler/SmallVector.h"
 
 namespace Wave {
 
@@ -22,7 +27,22 @@ namespace Wave {
 struct Identifier
 {
 	/// List of identifiers in the path.
-	std::vector<Token> Path;
+	SmallVector<Token, 2> Path;
+
+	/// Check if two identifiers name the same path.
+	/// Compares symbols, so both must have been interned in the same SymbolTable.
+	///
+	/// \param other Identifier to compare with.
+	/// 
+	/// \return If the paths are equal.
+	bool operator==(const Identifier& other) const;
+
+	/// Check if two identifiers name different paths.
+	///
+	/// \param other Identifier to compare with.
+	/// 
+	/// \return If the paths are not equal.
+	bool operator!=(const Identifier& other) const { return !(*this == other); }
 };
 
 /// Structure representing an imported module.
@@ -41,19 +61,40 @@ struct CImport
 	Token Path;
 };
 
+/// Kind of a node, one for every concrete node type.
+enum class NodeKind : uint8_t
+{
+	Abstract, ArrayIndex, ArrayType, Assignment, Binary, Block, Break, Call,
+	ClassDefinition, ClassType, ConditionFor, Constructor, Continue, EnumDefinition,
+	ExpressionStatement, Function, FunctionDefinition, FuncType, Getter, Group, If,
+	InitializerList, Literal, Logical, Method, OperatorOverload, RangeFor, Return,
+	Setter, SimpleType, Throw, Try, TupleType, TypeOf, Unary, VarAccess, VarDefinition, While,
+	Count
+};
+
+/// Get the name of a node kind.
+///
+/// \param kind The kind.
+/// 
+/// \return The name, like 'Binary'.
+const char* GetNodeKindName(NodeKind kind);
+
 class ASTVisitor;
 
 /// A statement.
 struct Statement
 {
-	/// Virtual destructor.
-	virtual ~Statement() = default;
+	/// Kind of the node, which tells its concrete type.
+	const NodeKind Kind;
 
 	/// Accept a visitor.
 	///
 	/// \param visitor Visitor to accept.
 	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) = 0;
+	void Accept(ASTVisitor& visitor, std::any& context);
+
+protected:
+	explicit Statement(NodeKind kind) : Kind(kind) {}
 };
 
 /// The definition of a class, function, or variable.
@@ -62,11 +103,8 @@ struct Definition : Statement
 	/// Local identifier of the definition.
 	Token Ident;
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) = 0;
+protected:
+	explicit Definition(NodeKind kind) : Statement(kind) {}
 };
 
 /// A global definition in a module.
@@ -76,34 +114,16 @@ struct GlobalDefinition
 	bool Exported = false;
 
 	/// The definition.
-	up<Definition> Def = nullptr;
-};
-
-/// Structure representing a module,
-/// which is a single source file.
-struct Module
-{
-	/// Definition of the module.
-	Identifier Def;
-
-	/// List of all imports.
-	std::vector<ModuleImport> Imports;
-
-	/// List of all C imports.
-	std::vector<CImport> CImports;
-
-	/// List of all global definitions.
-	std::vector<GlobalDefinition> Definitions;
-
-	/// Path of the module file.
-	std::filesystem::path FilePath;
+	Definition* Def = nullptr;
 };
 
 /// A data type.
 struct Type
 {
-	/// Virtual destructor.
-	virtual ~Type() = default;
+	/// Kind of the node, which tells its concrete type.
+	/// Each concrete type also declares its kind as a static constant of the same name,
+	/// so code that only has the type, like TypeContext, can read it without a node.
+	const NodeKind Kind;
 
 	Token Tok;
 
@@ -111,48 +131,45 @@ struct Type
 	///
 	/// \param visitor Visitor to accept.
 	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) = 0;
+	void Accept(ASTVisitor& visitor, std::any& context);
+
+protected:
+	explicit Type(NodeKind kind) : Kind(kind) {}
 };
 
 struct SimpleType : Type
 {
+	static constexpr NodeKind Kind = NodeKind::SimpleType;
+
+	SimpleType() : Type(Kind) {}
+
 	enum class TypeType
 	{
 		Int, Real, Char, Bool, Generic
 	};
 
 	TypeType T;
-
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
 };
 
 /// Type of function.
 struct FuncType : Type
 {
-	up<Type> ReturnType;
-	std::vector<up<Type>> ParamTypes;
+	static constexpr NodeKind Kind = NodeKind::FuncType;
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	FuncType() : Type(Kind) {}
+
+	Type* ReturnType = nullptr;
+	SmallVector<Type*, 4> ParamTypes;
 };
 
 /// Type of a class.
 struct ClassType : Type
 {
-	Identifier Ident;
+	static constexpr NodeKind Kind = NodeKind::ClassType;
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	ClassType() : Type(Kind) {}
+
+	Identifier Ident;
 };
 
 /// A parameter of a function.
@@ -160,501 +177,496 @@ struct Parameter
 {
 	bool IsConst = false;
 	Token Ident;
-	up<Type> DataType;
+	Type* DataType = nullptr;
 };
 
 /// An abstract method in a class.
 struct Abstract : Definition
 {
+	Abstract() : Definition(NodeKind::Abstract) {}
+
 	Token Ident;
-	std::vector<Parameter> Params;
-	up<Type> ReturnType;
+	SmallVector<Parameter, 4> Params;
+	Type* ReturnType = nullptr;
 	bool IsReturnConst = false;
 	bool IsConst = false;
-
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
 };
 
 /// Class definition.
 struct ClassDefinition : Definition
 {
-	std::vector<Identifier> Bases;
-	std::vector<up<Definition>> Public;
-	std::vector<up<Definition>> Protected;
-	std::vector<up<Definition>> Private;
+	ClassDefinition() : Definition(NodeKind::ClassDefinition) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	std::vector<Identifier> Bases;
+	std::vector<Definition*> Public;
+	std::vector<Definition*> Protected;
+	std::vector<Definition*> Private;
 };
 
 /// Enum definition.
 struct EnumDefinition : Definition
 {
-	std::vector<Token> Elements;
+	EnumDefinition() : Definition(NodeKind::EnumDefinition) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	std::vector<Token> Elements;
 };
 
 /// Block of statements.
 struct Block : Statement
 {
-	std::vector<up<Statement>> Statements;
+	Block() : Statement(NodeKind::Block) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	SmallVector<Statement*, 4> Statements;
 };
 
 struct OperatorOverload : Definition
 {
+	OperatorOverload() : Definition(NodeKind::OperatorOverload) {}
+
 	Token Operator;
 	bool IsUnary = false;
 	Parameter Left, Right;
-	up<Block> ExecBlock;
-	up<Type> ReturnType;
-
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Block* ExecBlock = nullptr;
+	Type* ReturnType = nullptr;
 };
 
 /// Class constructor.
 struct Constructor : Definition
 {
-	std::vector<Parameter> Params;
-	up<Block> ExecBlock;
+	Constructor() : Definition(NodeKind::Constructor) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	SmallVector<Parameter, 4> Params;
+	Block* ExecBlock = nullptr;
 };
 
 /// Class getter.
 struct Getter : Definition
 {
-	Token Ident;
-	up<Type> GetType;
-	up<Block> ExecBlock;
+	Getter() : Definition(NodeKind::Getter) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Token Ident;
+	Type* GetType = nullptr;
+	Block* ExecBlock = nullptr;
 };
 
 /// Class setter.
 struct Setter : Definition
 {
+	Setter() : Definition(NodeKind::Setter) {}
+
 	Token Ident;
 	Parameter SetParam;
-	up<Block> ExecBlock;
-
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Block* ExecBlock = nullptr;
 };
 
 /// Break statement.
 struct Break : Statement
 {
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Break() : Statement(NodeKind::Break) {}
 };
 
 /// Continue statement.
 struct Continue : Statement
 {
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Continue() : Statement(NodeKind::Continue) {}
 };
 
 /// An expression.
 struct Expression
 {
-	/// Virtual destructor.
-	virtual ~Expression() = default;
+	/// Kind of the node, which tells its concrete type.
+	const NodeKind Kind;
 
 	/// Accept a visitor.
 	///
 	/// \param visitor Visitor to accept.
 	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) = 0;
+	void Accept(ASTVisitor& visitor, std::any& context);
+
+protected:
+	explicit Expression(NodeKind kind) : Kind(kind) {}
 };
 
 struct ArrayType : Type
 {
-	up<Type> HoldType;
-	up<Expression> Size;
+	static constexpr NodeKind Kind = NodeKind::ArrayType;
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	ArrayType() : Type(Kind) {}
+
+	Type* HoldType = nullptr;
+	Expression* Size = nullptr;
 };
 
 struct TupleType : Type
 {
-	std::vector<up<Type>> Types;
+	static constexpr NodeKind Kind = NodeKind::TupleType;
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	TupleType() : Type(Kind) {}
+
+	SmallVector<Type*, 4> Types;
 };
 
 /// Type of an expression preceded by 'typeof'
 struct TypeOf : Type
 {
-	up<Expression> Expr;
+	static constexpr NodeKind Kind = NodeKind::TypeOf;
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	TypeOf() : Type(Kind) {}
+
+	Expression* Expr = nullptr;
 };
 
 /// Return statement.
 struct Return : Statement
 {
-	up<Expression> Value;
+	Return() : Statement(NodeKind::Return) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Expression* Value = nullptr;
 };
 
 /// Definition of a variable.
 struct VarDefinition : Definition
 {
-	Token VarType;
-	up<Type> DataType;
-	up<Expression> Value;
+	VarDefinition() : Definition(NodeKind::VarDefinition) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Token VarType;
+	Type* DataType = nullptr;
+	Expression* Value = nullptr;
 };
 
 /// Statement which evaluates an expression and discards the result.
 struct ExpressionStatement : Statement
 {
-	up<Expression> Expr;
+	ExpressionStatement() : Statement(NodeKind::ExpressionStatement) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Expression* Expr = nullptr;
 };
 
 /// While loop.
 struct While : Statement
 {
-	up<Expression> Condition;
-	up<Block> ExecBlock;
+	While() : Statement(NodeKind::While) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Expression* Condition = nullptr;
+	Block* ExecBlock = nullptr;
 };
 
 /// For loop condition.
 struct ForCond
 {
-	std::variant<up<Expression>, up<Definition>> Initializer;
-	up<Expression> Condition;
-	up<Expression> Increment;
+	std::variant<Expression*, Definition*> Initializer;
+	Expression* Condition = nullptr;
+	Expression* Increment = nullptr;
 };
 
 /// For loop range
 struct ForRange
 {
 	Token Ident;
-	up<Expression> Range;
+	Expression* Range = nullptr;
 };
 
 /// For loop.
 struct ConditionFor : Statement
 {
-	ForCond Condition;
-	up<Block> ExecBlock;
+	ConditionFor() : Statement(NodeKind::ConditionFor) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	ForCond Condition;
+	Block* ExecBlock = nullptr;
 };
 
 /// For loop.
 struct RangeFor : Statement
 {
-	ForRange Condition;
-	up<Block> ExecBlock;
+	RangeFor() : Statement(NodeKind::RangeFor) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	ForRange Condition;
+	Block* ExecBlock = nullptr;
 };
 
 /// Else if statement.
 struct ElseIf
 {
-	up<Expression> Condition;
-	up<Block> True;
+	Expression* Condition = nullptr;
+	Block* True = nullptr;
 };
 
 /// If statement.
 struct If : Statement
 {
-	up<Expression> Condition;
-	up<Block> True;
-	std::vector<ElseIf> ElseIfs;
-	up<Block> Else;
+	If() : Statement(NodeKind::If) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Expression* Condition = nullptr;
+	Block* True = nullptr;
+	std::vector<ElseIf> ElseIfs;
+	Block* Else = nullptr;
 };
 
 struct Catch
 {
-	up<Block> ExecBlock;
+	Block* ExecBlock = nullptr;
 	Parameter Param;
 };
 
 struct Try : Statement
 {
-	up<Block> ExecBlock;
-	std::vector<Catch> Catches;
+	Try() : Statement(NodeKind::Try) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Block* ExecBlock = nullptr;
+	std::vector<Catch> Catches;
 };
 
 struct Throw : Statement
 {
-	up<Expression> Value;
+	Throw() : Statement(NodeKind::Throw) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Expression* Value = nullptr;
 };
 
 /// A function, which could be anonymous.
 struct Function : Expression
 {
-	std::vector<Parameter> Params;
-	up<Type> ReturnType;
+	Function() : Expression(NodeKind::Function) {}
+
+	SmallVector<Parameter, 4> Params;
+	Type* ReturnType = nullptr;
 	bool IsReturnConst = false;
 	bool IsVariadic = false;
-	up<Block> ExecBlock;
-
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Block* ExecBlock = nullptr;
 };
 
 /// Function definition.
 struct FunctionDefinition : Definition
 {
-	up<Function> Func;
+	FunctionDefinition() : Definition(NodeKind::FunctionDefinition) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Function* Func = nullptr;
 };
 
 
 /// Class member function.
 struct Method : Definition
 {
+	Method() : Definition(NodeKind::Method) {}
+
 	bool IsStatic = false;
 	bool IsConst = false;
-	up<FunctionDefinition> Def;
-
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	FunctionDefinition* Def = nullptr;
 };
 
 /// A variable assignment expression.
 struct Assignment : Expression
 {
-	Identifier Var;
-	up<Expression> Value;
+	Assignment() : Expression(NodeKind::Assignment) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Identifier Var;
+	Expression* Value = nullptr;
 };
 
 /// A logical expression.
 struct Logical : Expression
 {
-	up<Expression> Left;
-	Token Operator;
-	up<Expression> Right;
+	Logical() : Expression(NodeKind::Logical) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Expression* Left = nullptr;
+	Token Operator;
+	Expression* Right = nullptr;
 };
 
 /// A binary expression.
 struct Binary : Expression
 {
-	up<Expression> Left;
-	Token Operator;
-	up<Expression> Right;
+	Binary() : Expression(NodeKind::Binary) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Expression* Left = nullptr;
+	Token Operator;
+	Expression* Right = nullptr;
 };
 
 
 /// A unary expression.
 struct Unary : Expression
 {
-	Token Operator;
-	up<Expression> Right;
+	Unary() : Expression(NodeKind::Unary) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Token Operator;
+	Expression* Right = nullptr;
 };
 
 /// A call expression.
 struct Call : Expression
 {
-	up<Expression> Callee;
-	std::vector<up<Expression>> Args;
+	Call() : Expression(NodeKind::Call) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Expression* Callee = nullptr;
+	SmallVector<Expression*, 4> Args;
 };
 
 /// A literal expression.
 struct Literal : Expression
 {
-	Token Value;
+	Literal() : Expression(NodeKind::Literal) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Token Value;
 };
 
 /// A grouping expression.
 struct Group : Expression
 {
-	up<Expression> Expr;
+	Group() : Expression(NodeKind::Group) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	Expression* Expr = nullptr;
 };
 
 struct InitializerList : Expression
 {
-	std::vector<up<Expression>> Data;
+	InitializerList() : Expression(NodeKind::InitializerList) {}
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	std::vector<Expression*> Data;
 };
 
 /// A variable access expression.
 struct VarAccess : Expression
 {
+	VarAccess() : Expression(NodeKind::VarAccess) {}
+
 	Identifier Var;
 	bool IsCopy = false;
 
-	/// Accept a visitor.
-	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+protected:
+	explicit VarAccess(NodeKind kind) : Expression(kind) {}
 };
 
 struct ArrayIndex : VarAccess
 {
-	up<Expression> Index;
+	ArrayIndex() : VarAccess(NodeKind::ArrayIndex) {}
 
-	/// Accept a visitor.
+	Expression* Index = nullptr;
+};
+
+/// Interns the types of a module, so that structurally identical types are a single node.
+/// The parts of an interned type are interned too, so two interned types are equal
+/// exactly when their pointers are. An interned type keeps the token it was first seen at.
+/// Sized arrays and 'typeof' hold an expression, and are never interned.
+class TypeContext
+{
+public:
+	/// Construct a type context.
 	///
-	/// \param visitor Visitor to accept.
-	/// \param context Context argument to pass on to visit.
-	virtual void Accept(ASTVisitor& visitor, std::any& context) override;
+	/// \param arena Arena to allocate new types in.
+	explicit TypeContext(Arena& arena) : m_Arena(arena) {}
+
+	TypeContext(const TypeContext&) = delete;
+	TypeContext& operator=(const TypeContext&) = delete;
+
+	/// Get a simple type.
+	///
+	/// \param type Which simple type.
+	/// \param tok Token of the type, used if it is new.
+	/// 
+	/// \return The interned type.
+	SimpleType* GetSimple(SimpleType::TypeType type, const Token& tok = {});
+
+	/// Get an unsized array type.
+	///
+	/// \param holdType Interned type of the elements.
+	/// \param tok Token of the type, used if it is new.
+	/// 
+	/// \return The interned type.
+	ArrayType* GetArray(Type* holdType, const Token& tok = {});
+
+	/// Get a tuple type.
+	///
+	/// \param types Interned types of the elements.
+	/// \param tok Token of the type, used if it is new.
+	/// 
+	/// \return The interned type.
+	TupleType* GetTuple(const SmallVector<Type*, 4>& types, const Token& tok = {});
+
+	/// Get a function type.
+	///
+	/// \param paramTypes Interned types of the parameters.
+	/// \param returnType Interned return type, or null if the function returns nothing.
+	/// \param tok Token of the type, used if it is new.
+	/// 
+	/// \return The interned type.
+	FuncType* GetFunc(const SmallVector<Type*, 4>& paramTypes, Type* returnType, const Token& tok = {});
+
+	/// Get the type of a class.
+	///
+	/// \param ident Name of the class.
+	/// \param tok Token of the type, used if it is new.
+	/// 
+	/// \return The interned type.
+	ClassType* GetClass(const Identifier& ident, const Token& tok = {});
+
+	/// Get the number of distinct interned types.
+	///
+	/// \return The number of types.
+	uint64_t GetTypeCount() const { return m_TypeCount; }
+
+private:
+	/// Find an interned type, or make it if there is none.
+	///
+	/// \param hash Hash of the type.
+	/// \param tok Token of the type, used if it is new.
+	/// \param equal Check if an interned type of the same kind is the one wanted.
+	/// \param fill Fill in the parts of a new type.
+	/// 
+	/// \return The interned type.
+	template<typename T, typename Equal, typename Fill>
+	T* Intern(uint64_t hash, const Token& tok, const Equal& equal, const Fill& fill);
+
+	Arena& m_Arena;
+	std::unordered_multimap<uint64_t, Type*> m_Types;
+	SimpleType* m_Simple[static_cast<size_t>(SimpleType::TypeType::Generic) + 1] = {};
+	uint64_t m_TypeCount = 0;
 };
 
+/// Structure representing a module,
+/// which is a single source file.
+struct Module
+{
+	/// Definition of the module.
+	Identifier Def;
+
+	/// List of all imports.
+	std::vector<ModuleImport> Imports;
+
+	/// List of all C imports.
+	std::vector<CImport> CImports;
+
+	/// List of all global definitions.
+	std::vector<GlobalDefinition> Definitions;
+
+	/// Path of the module file.
+	std::filesystem::path FilePath;
+
+	/// Values of the number literal tokens in the module.
+	LiteralTable Literals;
+
+	/// Arena owning every AST node of the module.
+	Arena Nodes;
+
+	/// Interned types of the module, allocated in Nodes.
+	TypeContext Types;
+
+	Module() : Types(Nodes) {}
+};
+
+/// Any node, by its base type.
+using ASTNode = std::variant<Statement*, Expression*, Type*>;
+
+/// Get the kind of a node.
+///
+/// \param node The node, which must not be null.
+/// 
+/// \return The kind.
+inline NodeKind GetKind(const ASTNode& node)
+{
+	return std::visit([](auto n) { return n->Kind; }, node);
+}
+
 /// A visitor of the AST.
 class ASTVisitor
 {
@@ -0,0 +1,608 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "AST.h"
+
+namespace Wave {
+
+/// Records of the binary AST format.
+///
+/// A serialized module is one buffer, starting with a Header. Nodes are records which refer to
+/// each other by their offset from the start of the buffer, so a module can be memory-mapped
+/// and walked in place with a BinaryModule, without building any AST nodes.
+///
+/// Every node record starts with a Node header, whose Kind tells the record type. Lists are arrays
+/// of records or of Refs. An interned type is written once, and every Ref to it is to that one record.
+///
+/// Tokens keep their position in the source file. The Value of identifier and string tokens is an index
+/// into the string table of the module, and the Value of number tokens is an index into its integer
+/// or real table, as in a LiteralTable. The File of tokens is always 0.
+///
+/// All records are aligned to 4 bytes, and the integer and real tables to 8 bytes.
+/// Values are in the byte order of the machine that wrote them, which the header records.
+namespace ASTFormat {
+
+/// Version of the format, bumped whenever any record changes.
+constexpr uint32_t Version = 1;
+
+/// Written as 'WAST'.
+constexpr char Magic[4] = { 'W', 'A', 'S', 'T' };
+
+/// Written as a uint32_t, reads back differently in the other byte order.
+constexpr uint32_t ByteOrderMark = 0x01020304;
+
+/// Largest serialized module, since offsets and sizes are 32-bit.
+constexpr uint64_t MaxSize = UINT32_MAX;
+
+/// Offset of a node record from the start of the buffer, 0 if there is no node.
+using Ref = uint32_t;
+
+/// Array of records, stored one after the other.
+template<typename T>
+struct List
+{
+	/// Offset of the first record, 0 if the list is empty.
+	uint32_t Offset = 0;
+
+	/// Number of records.
+	uint32_t Count = 0;
+};
+
+/// Start of a serialized module.
+struct Header
+{
+	char Magic[4];
+	uint32_t ByteOrder;
+	uint32_t Version;
+
+	/// Size of the whole buffer.
+	uint32_t Size;
+
+	/// Offset of the Module record.
+	uint32_t Module;
+};
+
+/// An entry in the string table.
+struct String
+{
+	/// Offset of the characters.
+	uint32_t Offset;
+
+	/// Number of characters.
+	uint32_t Length;
+};
+
+/// A Wave::Identifier.
+using Identifier = List<Token>;
+
+struct ModuleImport
+{
+	Identifier Imported;
+	Identifier As;
+};
+
+struct GlobalDefinition
+{
+	Ref Def;
+	uint8_t Exported;
+	uint8_t Reserved[3];
+};
+
+struct Module
+{
+	Identifier Def;
+	List<ModuleImport> Imports;
+	List<Token> CImports;
+	List<GlobalDefinition> Definitions;
+
+	/// Index of the file path in the string table.
+	uint32_t FilePath;
+
+	List<String> Strings;
+	List<int64_t> Integers;
+	List<double> Reals;
+};
+
+/// Start of every node record.
+struct Node
+{
+	NodeKind Kind;
+	uint8_t Reserved[3];
+};
+
+struct Parameter
+{
+	Token Ident;
+	Ref DataType;
+	uint8_t IsConst;
+	uint8_t Reserved[3];
+};
+
+struct ElseIf
+{
+	Ref Condition;
+	Ref True;
+};
+
+struct Catch
+{
+	Ref ExecBlock;
+	Parameter Param;
+};
+
+// Types.
+
+struct SimpleType
+{
+	static constexpr NodeKind Kind = NodeKind::SimpleType;
+	Node Header;
+	Token Tok;
+	uint8_t T;
+	uint8_t Reserved[3];
+};
+
+struct FuncType
+{
+	static constexpr NodeKind Kind = NodeKind::FuncType;
+	Node Header;
+	Token Tok;
+	Ref ReturnType;
+	List<Ref> ParamTypes;
+};
+
+struct ClassType
+{
+	static constexpr NodeKind Kind = NodeKind::ClassType;
+	Node Header;
+	Token Tok;
+	Identifier Ident;
+};
+
+struct ArrayType
+{
+	static constexpr NodeKind Kind = NodeKind::ArrayType;
+	Node Header;
+	Token Tok;
+	Ref HoldType;
+	Ref Size;
+};
+
+struct TupleType
+{
+	static constexpr NodeKind Kind = NodeKind::TupleType;
+	Node Header;
+	Token Tok;
+	List<Ref> Types;
+};
+
+struct TypeOf
+{
+	static constexpr NodeKind Kind = NodeKind::TypeOf;
+	Node Header;
+	Token Tok;
+	Ref Expr;
+};
+
+// Definitions. Ident is the identifier of the Definition, and Abstract, Getter and Setter
+// have an identifier of their own as well, like their nodes.
+
+struct Abstract
+{
+	static constexpr NodeKind Kind = NodeKind::Abstract;
+	Node Header;
+	Token Ident;
+	Token OwnIdent;
+	List<Parameter> Params;
+	Ref ReturnType;
+	uint8_t IsReturnConst;
+	uint8_t IsConst;
+	uint8_t Reserved[2];
+};
+
+struct ClassDefinition
+{
+	static constexpr NodeKind Kind = NodeKind::ClassDefinition;
+	Node Header;
+	Token Ident;
+	List<Identifier> Bases;
+	List<Ref> Public;
+	List<Ref> Protected;
+	List<Ref> Private;
+};
+
+struct EnumDefinition
+{
+	static constexpr NodeKind Kind = NodeKind::EnumDefinition;
+	Node Header;
+	Token Ident;
+	List<Token> Elements;
+};
+
+struct OperatorOverload
+{
+	static constexpr NodeKind Kind = NodeKind::OperatorOverload;
+	Node Header;
+	Token Ident;
+	Token Operator;
+	Parameter Left;
+	Parameter Right;
+	Ref ExecBlock;
+	Ref ReturnType;
+	uint8_t IsUnary;
+	uint8_t Reserved[3];
+};
+
+struct Constructor
+{
+	static constexpr NodeKind Kind = NodeKind::Constructor;
+	Node Header;
+	Token Ident;
+	List<Parameter> Params;
+	Ref ExecBlock;
+};
+
+struct Getter
+{
+	static constexpr NodeKind Kind = NodeKind::Getter;
+	Node Header;
+	Token Ident;
+	Token OwnIdent;
+	Ref GetType;
+	Ref ExecBlock;
+};
+
+struct Setter
+{
+	static constexpr NodeKind Kind = NodeKind::Setter;
+	Node Header;
+	Token Ident;
+	Token OwnIdent;
+	Parameter SetParam;
+	Ref ExecBlock;
+};
+
+struct VarDefinition
+{
+	static constexpr NodeKind Kind = NodeKind::VarDefinition;
+	Node Header;
+	Token Ident;
+	Token VarType;
+	Ref DataType;
+	Ref Value;
+};
+
+struct FunctionDefinition
+{
+	static constexpr NodeKind Kind = NodeKind::FunctionDefinition;
+	Node Header;
+	Token Ident;
+	Ref Func;
+};
+
+struct Method
+{
+	static constexpr NodeKind Kind = NodeKind::Method;
+	Node Header;
+	Token Ident;
+	Ref Def;
+	uint8_t IsStatic;
+	uint8_t IsConst;
+	uint8_t Reserved[2];
+};
+
+// Statements.
+
+struct Block
+{
+	static constexpr NodeKind Kind = NodeKind::Block;
+	Node Header;
+	List<Ref> Statements;
+};
+
+struct Break
+{
+	static constexpr NodeKind Kind = NodeKind::Break;
+	Node Header;
+};
+
+struct Continue
+{
+	static constexpr NodeKind Kind = NodeKind::Continue;
+	Node Header;
+};
+
+struct Return
+{
+	static constexpr NodeKind Kind = NodeKind::Return;
+	Node Header;
+	Ref Value;
+};
+
+struct ExpressionStatement
+{
+	static constexpr NodeKind Kind = NodeKind::ExpressionStatement;
+	Node Header;
+	Ref Expr;
+};
+
+struct While
+{
+	static constexpr NodeKind Kind = NodeKind::While;
+	Node Header;
+	Ref Condition;
+	Ref ExecBlock;
+};
+
+struct ConditionFor
+{
+	static constexpr NodeKind Kind = NodeKind::ConditionFor;
+	Node Header;
+
+	/// An expression or a definition.
+	Ref Initializer;
+	Ref Condition;
+	Ref Increment;
+	Ref ExecBlock;
+};
+
+struct RangeFor
+{
+	static constexpr NodeKind Kind = NodeKind::RangeFor;
+	Node Header;
+	Token Ident;
+	Ref Range;
+	Ref ExecBlock;
+};
+
+struct If
+{
+	static constexpr NodeKind Kind = NodeKind::If;
+	Node Header;
+	Ref Condition;
+	Ref True;
+	List<ElseIf> ElseIfs;
+	Ref Else;
+};
+
+struct Try
+{
+	static constexpr NodeKind Kind = NodeKind::Try;
+	Node Header;
+	Ref ExecBlock;
+	List<Catch> Catches;
+};
+
+struct Throw
+{
+	static constexpr NodeKind Kind = NodeKind::Throw;
+	Node Header;
+	Ref Value;
+};
+
+// Expressions.
+
+struct Function
+{
+	static constexpr NodeKind Kind = NodeKind::Function;
+	Node Header;
+	List<Parameter> Params;
+	Ref ReturnType;
+	Ref ExecBlock;
+	uint8_t IsReturnConst;
+	uint8_t IsVariadic;
+	uint8_t Reserved[2];
+};
+
+struct Assignment
+{
+	static constexpr NodeKind Kind = NodeKind::Assignment;
+	Node Header;
+	Identifier Var;
+	Ref Value;
+};
+
+struct Logical
+{
+	static constexpr NodeKind Kind = NodeKind::Logical;
+	Node Header;
+	Ref Left;
+	Token Operator;
+	Ref Right;
+};
+
+struct Binary
+{
+	static constexpr NodeKind Kind = NodeKind::Binary;
+	Node Header;
+	Ref Left;
+	Token Operator;
+	Ref Right;
+};
+
+struct Unary
+{
+	static constexpr NodeKind Kind = NodeKind::Unary;
+	Node Header;
+	Token Operator;
+	Ref Right;
+};
+
+struct Call
+{
+	static constexpr NodeKind Kind = NodeKind::Call;
+	Node Header;
+	Ref Callee;
+	List<Ref> Args;
+};
+
+struct Literal
+{
+	static constexpr NodeKind Kind = NodeKind::Literal;
+	Node Header;
+	Token Value;
+};
+
+struct Group
+{
+	static constexpr NodeKind Kind = NodeKind::Group;
+	Node Header;
+	Ref Expr;
+};
+
+struct InitializerList
+{
+	static constexpr NodeKind Kind = NodeKind::InitializerList;
+	Node Header;
+	List<Ref> Data;
+};
+
+struct VarAccess
+{
+	static constexpr NodeKind Kind = NodeKind::VarAccess;
+	Node Header;
+	Identifier Var;
+	uint8_t IsCopy;
+	uint8_t Reserved[3];
+};
+
+struct ArrayIndex
+{
+	static constexpr NodeKind Kind = NodeKind::ArrayIndex;
+	Node Header;
+	Identifier Var;
+	uint8_t IsCopy;
+	uint8_t Reserved[3];
+	Ref Index;
+};
+
+}
+
+/// Read-only view of a serialized module, which walks the records in place.
+/// Every access is checked against the bounds of the buffer, so a damaged buffer
+/// gives null records and empty lists instead of reading out of bounds.
+class BinaryModule
+{
+public:
+	/// Contiguous records of a list.
+	template<typename T>
+	struct Records
+	{
+		const T* Data = nullptr;
+		uint32_t Count = 0;
+
+		const T* begin() const { return Data; }
+		const T* end() const { return Data + Count; }
+		const T& operator[](uint32_t index) const { return Data[index]; }
+	};
+
+	/// Check the header of a serialized module. The buffer is not copied, and must outlive the view.
+	///
+	/// \param data Start of the buffer, aligned to 8 bytes.
+	/// \param size Size of the buffer.
+	BinaryModule(const char* data, uint64_t size);
+
+	/// Check if the buffer holds a module of this version of the format.
+	///
+	/// \return If the module can be read.
+	bool IsValid() const { return m_Module != nullptr; }
+
+	/// Get the module record.
+	///
+	/// \return The record, which must be valid.
+	const ASTFormat::Module& GetModule() const { return *m_Module; }
+
+	/// Get the kind of a node.
+	///
+	/// \param ref The node.
+	/// 
+	/// \return The kind, or NodeKind::Count if there is no such node.
+	NodeKind GetKind(ASTFormat::Ref ref) const;
+
+	/// Get a node record.
+	///
+	/// \tparam T The record type.
+	/// \param ref The node.
+	/// 
+	/// \return The record, or nullptr if there is no such node or it is of another kind.
+	template<typename T>
+	const T* Get(ASTFormat::Ref ref) const
+	{
+		if (GetKind(ref) != T::Kind || !Fits(ref, sizeof(T), alignof(T))) { return nullptr; }
+		return reinterpret_cast<const T*>(m_Data + ref);
+	}
+
+	/// Get the records of a list.
+	///
+	/// \param list The list.
+	/// 
+	/// \return The records, empty if the list does not fit in the buffer.
+	template<typename T>
+	Records<T> Get(const ASTFormat::List<T>& list) const
+	{
+		if (list.Count == 0 || !Fits(list.Offset, static_cast<uint64_t>(list.Count) * sizeof(T), alignof(T))) { return {}; }
+		return { reinterpret_cast<const T*>(m_Data + list.Offset), list.Count };
+	}
+
+	/// Get a string from the string table.
+	///
+	/// \param index Index of the string, like the Value of an identifier token.
+	/// 
+	/// \return The string, empty if there is no such string.
+	std::string_view GetString(uint32_t index) const;
+
+private:
+	/// Check if a record lies within the buffer.
+	///
+	/// \param offset Offset of the record.
+	/// \param size Size of the record.
+	/// \param alignment Alignment of the record.
+	/// 
+	/// \return If the record can be read.
+	bool Fits(uint64_t offset, uint64_t size, uint64_t alignment) const
+	{
+		return offset != 0 && offset % alignment == 0 && offset <= m_Size && size <= m_Size - offset;
+	}
+
+	const char* m_Data;
+	uint64_t m_Size;
+	const ASTFormat::Module* m_Module = nullptr;
+	Records<ASTFormat::String> m_Strings;
+};
+
+/// Serialize a module in the binary AST format.
+///
+/// \param module The module.
+/// \param symbols The symbol table its identifiers and strings are interned in.
+/// \param data Set to the serialized module.
+/// \param limit Largest buffer to write, capped at ASTFormat::MaxSize.
+/// 
+/// \return If the module was written, false if it would not fit in the limit.
+bool SerializeModule(const Module& module, const SymbolTable& symbols, std::string& data, uint64_t limit = ASTFormat::MaxSize);
+
+/// Build the AST of a serialized module.
+///
+/// \param context The context to intern identifiers and strings in.
+/// \param file The file every token of the module is placed in.
+/// \param data Start of the buffer, aligned to 8 bytes.
+/// \param size Size of the buffer.
+/// 
+/// \return The module, or nullptr if the buffer does not hold a valid module.
+up<Module> DeserializeModule(CompileContext& context, FileID file, const char* data, uint64_t size);
+
+}
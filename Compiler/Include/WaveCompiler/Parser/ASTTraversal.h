@@ -0,0 +1,137 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+
+#include "AST.h"
+
+namespace Wave {
+
+/// Walks an AST in pre-order or post-order with an explicit stack instead of recursion,
+/// so arbitrarily deep trees can be walked. Children are walked in source order.
+/// Interned types are walked under every node that refers to them.
+///
+/// The stack is kept between walks, so a traversal reused across modules stops allocating
+/// once it has grown to the depth of the largest tree:
+///
+///     ASTTraversal walk(ASTTraversal::Order::PreOrder);
+///     for (auto& module : modules)
+///     {
+///         walk.Reset(*module);
+///         for (ASTNode node : walk) { ... }
+///     }
+class ASTTraversal
+{
+public:
+	/// Order nodes are walked in.
+	enum class Order
+	{
+		/// Every node before its children.
+		PreOrder,
+
+		/// Every node after its children.
+		PostOrder
+	};
+
+	/// Decides if the children of a node are skipped. The node itself is still walked.
+	using PruneFunction = std::function<bool(const ASTNode&)>;
+
+	/// Input iterator over the nodes of a traversal, which advances the traversal itself.
+	class Iterator
+	{
+	public:
+		Iterator(ASTTraversal* traversal) : m_Traversal(traversal) {}
+
+		ASTNode operator*() const { return m_Traversal->GetNode(); }
+
+		Iterator& operator++()
+		{
+			if (!m_Traversal->Next()) { m_Traversal = nullptr; }
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const { return m_Traversal == other.m_Traversal; }
+		bool operator!=(const Iterator& other) const { return m_Traversal != other.m_Traversal; }
+
+	private:
+		ASTTraversal* m_Traversal;
+	};
+
+	/// Create a traversal, which walks nothing until it is reset.
+	///
+	/// \param order Order to walk nodes in.
+	/// \param prune Function deciding which subtrees to skip, or empty to walk every node.
+	ASTTraversal(Order order, PruneFunction prune = {});
+
+	/// Start walking every global definition of a module, in order.
+	///
+	/// \param module The module.
+	void Reset(Module& module);
+
+	/// Start walking a tree.
+	///
+	/// \param root The root of the tree.
+	void Reset(const ASTNode& root);
+
+	/// Move to the next node.
+	///
+	/// \return If there was a next node, false once every node has been walked.
+	bool Next();
+
+	/// Get the node the traversal is at.
+	///
+	/// \return The node, which must have been moved to with Next.
+	const ASTNode& GetNode() const { return m_Node; }
+
+	/// Skip the children of the node the traversal is at.
+	/// Only has an effect in pre-order, as in post-order the children have already been walked.
+	void SkipChildren() { m_Skip = true; }
+
+	/// Start iterating, moving to the first node.
+	///
+	/// \return Iterator at the first node.
+	Iterator begin() { return Iterator(Next() ? this : nullptr); }
+
+	/// Get the end of iteration.
+	///
+	/// \return Iterator past the last node.
+	Iterator end() { return Iterator(nullptr); }
+
+private:
+	struct Entry
+	{
+		ASTNode Node;
+
+		/// If the children of the node have been pushed, in post-order.
+		bool Expanded;
+	};
+
+	/// Push the children of a node, so that they are popped in source order.
+	///
+	/// \param node The node.
+	void PushChildren(const ASTNode& node);
+
+	Order m_Order;
+	PruneFunction m_Prune;
+	std::vector<Entry> m_Stack;
+	ASTNode m_Node;
+
+	/// If the children of m_Node are still to be pushed, in pre-order.
+	bool m_Pending = false;
+	bool m_Skip = false;
+};
+
+}
@@ -0,0 +1,518 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <tuple>
+
+#include "AST.h"
+
+namespace Wave {
+
+/// Index of a node in a FlatModule.
+using NodeIndex = uint32_t;
+
+/// Index of a missing node, like an if statement without an else block.
+constexpr NodeIndex NoNode = ~NodeIndex(0);
+
+/// Nodes of the flat AST, an alternative form of the AST in AST.h.
+///
+/// Each node type has a record with the same fields as its AST node, except that
+/// children are NodeIndexes instead of pointers, and lists of children are ranges
+/// of one of the shared lists of the FlatModule. Records have no virtual functions,
+/// and every record of a type is stored in one array.
+namespace FlatAST {
+
+/// Elements of a shared list of a FlatModule.
+template<typename T>
+struct Range
+{
+	/// Index of the first element.
+	uint32_t Begin = 0;
+
+	/// Number of elements.
+	uint32_t Count = 0;
+};
+
+/// Tokens of an identifier path.
+using Identifier = Range<Token>;
+
+struct Parameter
+{
+	Token Ident;
+	NodeIndex DataType = NoNode;
+	bool IsConst = false;
+};
+
+struct ElseIf
+{
+	NodeIndex Condition = NoNode;
+	NodeIndex True = NoNode;
+};
+
+struct Catch
+{
+	NodeIndex ExecBlock = NoNode;
+	Parameter Param;
+};
+
+struct GlobalDefinition
+{
+	NodeIndex Def = NoNode;
+	bool Exported = false;
+};
+
+struct Abstract
+{
+	static constexpr NodeKind Kind = NodeKind::Abstract;
+	Token Ident;
+	Token OwnIdent;
+	Range<Parameter> Params;
+	NodeIndex ReturnType = NoNode;
+	bool IsReturnConst = false;
+	bool IsConst = false;
+};
+
+struct ArrayIndex
+{
+	static constexpr NodeKind Kind = NodeKind::ArrayIndex;
+	Identifier Var;
+	bool IsCopy = false;
+	NodeIndex Index = NoNode;
+};
+
+struct ArrayType
+{
+	static constexpr NodeKind Kind = NodeKind::ArrayType;
+	Token Tok;
+	NodeIndex HoldType = NoNode;
+	NodeIndex Size = NoNode;
+};
+
+struct Assignment
+{
+	static constexpr NodeKind Kind = NodeKind::Assignment;
+	Identifier Var;
+	NodeIndex Value = NoNode;
+};
+
+struct Binary
+{
+	static constexpr NodeKind Kind = NodeKind::Binary;
+	NodeIndex Left = NoNode;
+	Token Operator;
+	NodeIndex Right = NoNode;
+};
+
+struct Block
+{
+	static constexpr NodeKind Kind = NodeKind::Block;
+	Range<NodeIndex> Statements;
+};
+
+struct Break
+{
+	static constexpr NodeKind Kind = NodeKind::Break;
+};
+
+struct Call
+{
+	static constexpr NodeKind Kind = NodeKind::Call;
+	NodeIndex Callee = NoNode;
+	Range<NodeIndex> Args;
+};
+
+struct ClassDefinition
+{
+	static constexpr NodeKind Kind = NodeKind::ClassDefinition;
+	Token Ident;
+	Range<Identifier> Bases;
+	Range<NodeIndex> Public;
+	Range<NodeIndex> Protected;
+	Range<NodeIndex> Private;
+};
+
+struct ClassType
+{
+	static constexpr NodeKind Kind = NodeKind::ClassType;
+	Token Tok;
+	Identifier Ident;
+};
+
+struct ConditionFor
+{
+	static constexpr NodeKind Kind = NodeKind::ConditionFor;
+
+	/// Either an expression or a variable definition.
+	NodeIndex Initializer = NoNode;
+	NodeIndex Condition = NoNode;
+	NodeIndex Increment = NoNode;
+	NodeIndex ExecBlock = NoNode;
+};
+
+struct Constructor
+{
+	static constexpr NodeKind Kind = NodeKind::Constructor;
+	Token Ident;
+	Range<Parameter> Params;
+	NodeIndex ExecBlock = NoNode;
+};
+
+struct Continue
+{
+	static constexpr NodeKind Kind = NodeKind::Continue;
+};
+
+struct EnumDefinition
+{
+	static constexpr NodeKind Kind = NodeKind::EnumDefinition;
+	Token Ident;
+	Range<Token> Elements;
+};
+
+struct ExpressionStatement
+{
+	static constexpr NodeKind Kind = NodeKind::ExpressionStatement;
+	NodeIndex Expr = NoNode;
+};
+
+struct Function
+{
+	static constexpr NodeKind Kind = NodeKind::Function;
+	Range<Parameter> Params;
+	NodeIndex ReturnType = NoNode;
+	bool IsReturnConst = false;
+	bool IsVariadic = false;
+	NodeIndex ExecBlock = NoNode;
+};
+
+struct FunctionDefinition
+{
+	static constexpr NodeKind Kind = NodeKind::FunctionDefinition;
+	Token Ident;
+	NodeIndex Func = NoNode;
+};
+
+struct FuncType
+{
+	static constexpr NodeKind Kind = NodeKind::FuncType;
+	Token Tok;
+	NodeIndex ReturnType = NoNode;
+	Range<NodeIndex> ParamTypes;
+};
+
+struct Getter
+{
+	static constexpr NodeKind Kind = NodeKind::Getter;
+	Token Ident;
+	Token OwnIdent;
+	NodeIndex GetType = NoNode;
+	NodeIndex ExecBlock = NoNode;
+};
+
+struct Group
+{
+	static constexpr NodeKind Kind = NodeKind::Group;
+	NodeIndex Expr = NoNode;
+};
+
+struct If
+{
+	static constexpr NodeKind Kind = NodeKind::If;
+	NodeIndex Condition = NoNode;
+	NodeIndex True = NoNode;
+	Range<ElseIf> ElseIfs;
+	NodeIndex Else = NoNode;
+};
+
+struct InitializerList
+{
+	static constexpr NodeKind Kind = NodeKind::InitializerList;
+	Range<NodeIndex> Data;
+};
+
+struct Literal
+{
+	static constexpr NodeKind Kind = NodeKind::Literal;
+	Token Value;
+};
+
+struct Logical
+{
+	static constexpr NodeKind Kind = NodeKind::Logical;
+	NodeIndex Left = NoNode;
+	Token Operator;
+	NodeIndex Right = NoNode;
+};
+
+struct Method
+{
+	static constexpr NodeKind Kind = NodeKind::Method;
+	Token Ident;
+	bool IsStatic = false;
+	bool IsConst = false;
+	NodeIndex Def = NoNode;
+};
+
+struct OperatorOverload
+{
+	static constexpr NodeKind Kind = NodeKind::OperatorOverload;
+	Token Ident;
+	Token Operator;
+	bool IsUnary = false;
+	Parameter Left;
+	Parameter Right;
+	NodeIndex ExecBlock = NoNode;
+	NodeIndex ReturnType = NoNode;
+};
+
+struct RangeFor
+{
+	static constexpr NodeKind Kind = NodeKind::RangeFor;
+	Token Ident;
+	NodeIndex Range = NoNode;
+	NodeIndex ExecBlock = NoNode;
+};
+
+struct Return
+{
+	static constexpr NodeKind Kind = NodeKind::Return;
+	NodeIndex Value = NoNode;
+};
+
+struct Setter
+{
+	static constexpr NodeKind Kind = NodeKind::Setter;
+	Token Ident;
+	Token OwnIdent;
+	Parameter SetParam;
+	NodeIndex ExecBlock = NoNode;
+};
+
+struct SimpleType
+{
+	static constexpr NodeKind Kind = NodeKind::SimpleType;
+	Token Tok;
+	Wave::SimpleType::TypeType T = Wave::SimpleType::TypeType::Int;
+};
+
+struct Throw
+{
+	static constexpr NodeKind Kind = NodeKind::Throw;
+	NodeIndex Value = NoNode;
+};
+
+struct Try
+{
+	static constexpr NodeKind Kind = NodeKind::Try;
+	NodeIndex ExecBlock = NoNode;
+	Range<Catch> Catches;
+};
+
+struct TupleType
+{
+	static constexpr NodeKind Kind = NodeKind::TupleType;
+	Token Tok;
+	Range<NodeIndex> Types;
+};
+
+struct TypeOf
+{
+	static constexpr NodeKind Kind = NodeKind::TypeOf;
+	Token Tok;
+	NodeIndex Expr = NoNode;
+};
+
+struct Unary
+{
+	static constexpr NodeKind Kind = NodeKind::Unary;
+	Token Operator;
+	NodeIndex Right = NoNode;
+};
+
+struct VarAccess
+{
+	static constexpr NodeKind Kind = NodeKind::VarAccess;
+	Identifier Var;
+	bool IsCopy = false;
+};
+
+struct VarDefinition
+{
+	static constexpr NodeKind Kind = NodeKind::VarDefinition;
+	Token Ident;
+	Token VarType;
+	NodeIndex DataType = NoNode;
+	NodeIndex Value = NoNode;
+};
+
+struct While
+{
+	static constexpr NodeKind Kind = NodeKind::While;
+	NodeIndex Condition = NoNode;
+	NodeIndex ExecBlock = NoNode;
+};
+
+}
+
+/// A module in the flat AST form.
+///
+/// The kind of every node is kept in one array, and the index of its record in the array of its type
+/// in another, parallel to it. Children are stored before their parents, in the order a parser finishes them,
+/// so a pass that does not care about the tree structure can stream through the kinds,
+/// or through every record of one type, without chasing any pointers.
+/// An interned type is one record, whose index is shared by every node referring to it.
+///
+/// Tokens are the same as in the AST, so number literals refer to the LiteralTable of the module.
+class FlatModule
+{
+public:
+	/// Contiguous elements of a shared list.
+	template<typename T>
+	struct Span
+	{
+		const T* Data = nullptr;
+		uint32_t Count = 0;
+
+		const T* begin() const { return Data; }
+		const T* end() const { return Data + Count; }
+		const T& operator[](uint32_t index) const { return Data[index]; }
+	};
+
+	/// Get the number of nodes.
+	///
+	/// \return The number of nodes.
+	uint32_t GetSize() const { return static_cast<uint32_t>(m_Kinds.size()); }
+
+	/// Get the kind of every node, indexed by NodeIndex.
+	///
+	/// \return The kinds.
+	const std::vector<NodeKind>& GetKinds() const { return m_Kinds; }
+
+	/// Get the kind of a node.
+	///
+	/// \param node The node, which must not be NoNode.
+	/// 
+	/// \return The kind.
+	NodeKind GetKind(NodeIndex node) const { return m_Kinds[node]; }
+
+	/// Get the record of a node.
+	///
+	/// \tparam T The record type, which must match the kind of the node.
+	/// \param node The node.
+	/// 
+	/// \return The record.
+	template<typename T>
+	const T& Get(NodeIndex node) const { return GetRecords<T>()[m_Slots[node]]; }
+
+	/// Get every record of a type, in the order their nodes were added.
+	///
+	/// \tparam T The record type.
+	/// 
+	/// \return The records.
+	template<typename T>
+	const std::vector<T>& GetRecords() const { return std::get<std::vector<T>>(m_Records); }
+
+	/// Get the elements of a range of a shared list.
+	///
+	/// \param range The range.
+	/// 
+	/// \return The elements.
+	template<typename T>
+	Span<T> Get(FlatAST::Range<T> range) const { return { std::get<std::vector<T>>(m_Lists).data() + range.Begin, range.Count }; }
+
+	/// Get the global definitions of the module.
+	///
+	/// \return The definitions.
+	const std::vector<FlatAST::GlobalDefinition>& GetDefinitions() const { return m_Definitions; }
+
+	/// Reserve space for the kinds and record indexes of a number of nodes.
+	///
+	/// \param nodes The number of nodes.
+	void Reserve(uint64_t nodes)
+	{
+		m_Kinds.reserve(nodes);
+		m_Slots.reserve(nodes);
+	}
+
+	/// Add a node. Its children must already have been added.
+	///
+	/// \param record The record of the node.
+	/// 
+	/// \return The index of the node.
+	template<typename T>
+	NodeIndex Add(const T& record)
+	{
+		auto& records = std::get<std::vector<T>>(m_Records);
+		m_Kinds.push_back(T::Kind);
+		m_Slots.push_back(static_cast<uint32_t>(records.size()));
+		records.push_back(record);
+		return static_cast<NodeIndex>(m_Kinds.size() - 1);
+	}
+
+	/// Add elements to a shared list.
+	///
+	/// \param data The elements.
+	/// \param count The number of elements.
+	/// 
+	/// \return The range of the elements.
+	template<typename T>
+	FlatAST::Range<T> AddList(const T* data, size_t count)
+	{
+		auto& list = std::get<std::vector<T>>(m_Lists);
+		FlatAST::Range<T> range{ static_cast<uint32_t>(list.size()), static_cast<uint32_t>(count) };
+		list.insert(list.end(), data, data + count);
+		return range;
+	}
+
+	/// Add a global definition.
+	///
+	/// \param def The definition.
+	void AddDefinition(const FlatAST::GlobalDefinition& def) { m_Definitions.push_back(def); }
+
+private:
+	std::vector<NodeKind> m_Kinds;
+	std::vector<uint32_t> m_Slots;
+	std::vector<FlatAST::GlobalDefinition> m_Definitions;
+
+	std::tuple<
+		std::vector<FlatAST::Abstract>, std::vector<FlatAST::ArrayIndex>, std::vector<FlatAST::ArrayType>,
+		std::vector<FlatAST::Assignment>, std::vector<FlatAST::Binary>, std::vector<FlatAST::Block>,
+		std::vector<FlatAST::Break>, std::vector<FlatAST::Call>, std::vector<FlatAST::ClassDefinition>,
+		std::vector<FlatAST::ClassType>, std::vector<FlatAST::ConditionFor>, std::vector<FlatAST::Constructor>,
+		std::vector<FlatAST::Continue>, std::vector<FlatAST::EnumDefinition>, std::vector<FlatAST::ExpressionStatement>,
+		std::vector<FlatAST::Function>, std::vector<FlatAST::FunctionDefinition>, std::vector<FlatAST::FuncType>,
+		std::vector<FlatAST::Getter>, std::vector<FlatAST::Group>, std::vector<FlatAST::If>,
+		std::vector<FlatAST::InitializerList>, std::vector<FlatAST::Literal>, std::vector<FlatAST::Logical>,
+		std::vector<FlatAST::Method>, std::vector<FlatAST::OperatorOverload>, std::vector<FlatAST::RangeFor>,
+		std::vector<FlatAST::Return>, std::vector<FlatAST::Setter>, std::vector<FlatAST::SimpleType>,
+		std::vector<FlatAST::Throw>, std::vector<FlatAST::Try>, std::vector<FlatAST::TupleType>,
+		std::vector<FlatAST::TypeOf>, std::vector<FlatAST::Unary>, std::vector<FlatAST::VarAccess>,
+		std::vector<FlatAST::VarDefinition>, std::vector<FlatAST::While>
+	> m_Records;
+
+	std::tuple<
+		std::vector<NodeIndex>, std::vector<Token>, std::vector<FlatAST::Parameter>,
+		std::vector<FlatAST::ElseIf>, std::vector<FlatAST::Catch>, std::vector<FlatAST::Identifier>
+	> m_Lists;
+};
+
+/// Build the flat form of a module.
+///
+/// \param module The module.
+/// 
+/// \return The flat module.
+FlatModule FlattenModule(const Module& module);
+
+}
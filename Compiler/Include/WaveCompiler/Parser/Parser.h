@@ -15,6 +15,7 @@
 #pragma once
 
 #include "AST.h"
+#include "WaveCompiler/TokenStream.h"
 
 namespace Wave {
 
@@ -22,11 +23,17 @@ namespace Wave {
 class Parser
 {
 public:
-	/// Construct a parser.
+	/// Construct a parser over the token list of a lexer.
 	///
 	/// \param lexer Lexer which has run.
 	Parser(CompileContext& context, const Lexer& lexer);
 
+	/// Construct a parser which pulls tokens from a stream as it needs them,
+	/// so lexing and parsing are interleaved.
+	///
+	/// \param stream Stream over a lexer which has not run.
+	Parser(CompileContext& context, TokenStream& stream);
+
 	/// Parse to form an AST.
 	void Parse();
 
@@ -58,137 +65,112 @@ private:
 	/// Parse a definition. Expects cursor to be at first token of definition.
 	///
 	/// \return The definition.
-	up<Definition> ParseDefinition();
+	Definition* ParseDefinition();
 
 	/// Parse a function definition. Expects cursor to be after func keyword.
 	///
 	/// \return The function definition.
-	up<FunctionDefinition> ParseFunctionDefinition();
+	FunctionDefinition* ParseFunctionDefinition();
 
 	/// Parse a variable definition. Expects cursor to be at after var, const, or static.
 	///
 	/// \return The variable definition.
-	up<VarDefinition> ParseVarDefinition();
+	VarDefinition* ParseVarDefinition();
 
 	/// Parse a class definition. Expects cursor to be after class keyword.
 	///
 	/// \return The class definition.
-	up<ClassDefinition> ParseClassDefinition();
+	ClassDefinition* ParseClassDefinition();
 
 	/// Parse an enum definition. Expects cursor to be after enum keyword.
 	///
 	/// \return The enum definition.
-	up<EnumDefinition> ParseEnumDefinition();
+	EnumDefinition* ParseEnumDefinition();
 
 	/// Parse a class method. Expects cursor to be at first token.
 	///
 	/// \return The method.
-	up<Method> ParseMethod();
+	Method* ParseMethod();
 
 	/// Parse an abstract function. Expects cursor to be after abstract keyword.
 	///
 	/// \return The abstract function.
-	up<Abstract> ParseAbstract();
+	Abstract* ParseAbstract();
 
 	/// Parse a getter or a setter. Expects cursor to be at the identifier.
 	///
 	/// \return The getter or setter.
-	up<Definition> ParseGetterOrSetter();
+	Definition* ParseGetterOrSetter();
 
 	/// Parse an operator overload. Expects cursor to be after op keyword.
 	///
 	/// \return the overload.
-	up<OperatorOverload> ParseOperator();
+	OperatorOverload* ParseOperator();
 
 	/// Parse a constructor. Expects cursor to be after the construct.
 	///
 	/// \return The constructor.
-	up<Constructor> ParseConstructor();
+	Constructor* ParseConstructor();
 
 	/// Parse a type. Expects cursor to be at the type keyword.
 	///
 	/// \return The type.
-	up<Type> ParseType();
+	Type* ParseType();
 
 	/// Parse a typeof expression. Expects cursor to be after typeof keyword.
 	///
 	/// \return The type.
-	up<TypeOf> ParseTypeOf();
+	TypeOf* ParseTypeOf();
 
 	/// Parse a tuple type. Expects cursor to be after tuple keyword.
 	///
 	/// \return The tuple.
-	up<TupleType> ParseTuple();
+	TupleType* ParseTuple();
 
 	/// Parse a function type. Expects cursor to be after the func keyword.
 	///
 	/// \return The function type;
-	up<FuncType> ParseFuncType();
+	FuncType* ParseFuncType();
 
 	/// Parse an expression. Expects cursor to be at the first token of the expression.
 	///
 	/// \return The parsed expression.
-	up<Expression> ParseExpression();
-
-	/// Parse an assignment. Expects cursor to be at the first token of the expression.
-	///
-	/// \return The assignment.
-	up<Expression> ParseAssignment();
-
-	/// Parse a logical or expression. Expects cursor to be at the first token of the expression.
-	///
-	/// \return The expression.
-	up<Expression> ParseOr();
-
-	/// Parse a logical and expression. Expects cursor to be at the first token of the expression.
-	///
-	/// \return The expression.
-	up<Expression> ParseAnd();
+	Expression* ParseExpression();
 
-	/// Parse an equality expression. Expects cursor to be at the first token of the expression.
-	///
-	/// \return The expression.
-	up<Expression> ParseEquality();
-
-	/// Parse a comparison expression. Expects cursor to be at the first token of the expression.
-	///
-	/// \return The expression.
-	up<Expression> ParseComparision();
-
-	/// Parse a term expression. Expects cursor to be at the first token of the expression.
-	///
-	/// \return The expression.
-	up<Expression> ParseTerm();
-
-	/// Parse a factor expression. Expects cursor to be at the first token of the expression.
+	/// Parse the operands and binary operators of an expression, by precedence climbing.
+	/// Expects cursor to be at the first token of the expression.
 	///
+	/// \param precedence The weakest operator precedence to take into the expression.
+	/// Operators binding more weakly are left for the caller.
+	/// 
 	/// \return The expression.
-	up<Expression> ParseFactor();
+	Expression* ParseBinary(uint8_t precedence);
 
 	/// Parse a unary expression. Expects cursor to be at the first token of the expression.
 	///
 	/// \return The expression.
-	up<Expression> ParseUnary();
+	Expression* ParseUnary();
 
 	/// Parse a call expression. Expects cursor to be at the first token of the expression.
 	///
 	/// \return The expression.
-	up<Expression> ParseCall();
+	Expression* ParseCall();
 
 	/// Parse a primary expression. Expects cursor to be at the first token of the expression.
 	///
 	/// \return The expression.
-	up<Expression> ParsePrimary();
+	Expression* ParsePrimary();
 
-	/// Check if the expression is a function.
+	/// Check if the expression is a function, by looking at most three tokens ahead.
+	/// Expects cursor to be after the opening parenthesis, and does not move it.
 	///
-	/// \return If the function is a function.
+	/// \return If the expression is a function.
 	bool IsFunction();
 
 	/// Parse an anonymous function. Expects cursor to be on the first token of the function.
 	///
 	/// \return Function parsed.
-	up<Function> ParseFunction();
+	Function* ParseFunction();
 
 	/// Parse a function parameter. Expects cursor to be on the first token of the parameter.
 	///
@@ -198,42 +180,59 @@ private:
 	/// Parse a block of statements. Expects cursor to be on the first token of the block.
 	///
 	/// \return The parsed block.
-	up<Block> ParseBlock();
+	Block* ParseBlock();
 
 	/// Parse a statement. Expects cursor to be on the first token of the statement.
 	///
 	/// \return The parsed statement.
-	up<Statement> ParseStatement();
+	Statement* ParseStatement();
 
 	/// Parse a while loop. Expects cursor to be after the while token.
 	///
 	/// \return The parsed loop.
-	up<While> ParseWhile();
+	While* ParseWhile();
 
 	/// Parse a for loop. Expects cursor to be after the for token.
 	///
 	/// \return The parsed loop.
-	up<Statement> ParseFor();
+	Statement* ParseFor();
 
 	/// Parse an if statement. Expects cursor to be after the if token.
 	///
 	/// \return The parsed if.
-	up<If> ParseIf();
+	If* ParseIf();
 
 	/// Parse a try-catch block. Expects cursor to be after the try token.
 	///
 	/// \return The parsed block.
-	up<Try> ParseTry();
+	Try* ParseTry();
 
 	/// Check if the expression is a definition
 	///
 	/// \return If the function is a definition.
 	bool IsDefinition();
 
+	/// Get a token from the token list or the stream.
+	///
+	/// \param index Index of the token.
+	/// 
+	/// \return The token.
+	Token GetToken(uint64_t index)
+	{
+		if (m_Stream) { return m_Stream->Get(index); }
+
+		// Clamp to the Null token at the end, in case the cursor has run past it.
+		return index < m_Tokens->size() ? (*m_Tokens)[index] : m_Tokens->back();
+	}
+
+	/// Let the stream reuse the slots of tokens well behind the cursor.
+	/// Only called between statements and definitions, where no rewind is pending.
+	void Release();
+
 	/// Get token and advance cursor. Does no bounds-checking.
 	///
 	/// \return The token at the cursor before advancing.
-	const Token& Advance();
+	Token Advance();
 
 	/// Peek at the token and advance if it matches type.
 	///
@@ -245,34 +244,86 @@ private:
 	/// Peek at the current token without advancing the cursor. Does no bounds-checking.
 	///
 	/// \return The current token.
-	const Token& Peek();
+	Token Peek();
 
 	/// Get the previous token. Does no bounds-checking.
 	///
 	/// \return The previous token.
-	const Token& Previous();
+	Token Previous();
 
-	/// Check if the token stream has more tokens.
+	/// Check if the token stream has more tokens, and the parser is not in panic mode.
 	///
 	/// \return If it is safe to call Advance().
 	bool IsGood();
 
+	/// Get the token an error at the cursor should point to.
+	///
+	/// \return The current token, or the last one if the file has ended.
+	Token GetOffending();
+
 	/// Ensure the current token is of type, and advance. 
-	/// Advances even if the check fails.
+	/// Does not advance if the check fails.
 	/// 
 	/// \param type Type to check for.
 	/// \param message Error message.
 	/// 
-	/// \return The current token.
+	/// \return The current token, or a Null token if the check failed.
+	Token Ensure(TokenType type, const std::string& message);
+
+	/// Report an error and enter panic mode.
+	/// In panic mode, Check() and Ensure() always fail without reporting anything,
+	/// so the parse functions return up to the nearest point which can synchronize.
+	///
+	/// \param token Token the error is about.
+	/// \param message Error message.
+	void Error(const Token& token, const std::string& message);
+
+	/// Leave panic mode, and skip the rest of a statement which failed to parse.
+	/// Stops after a semicolon ';', or before a closing brace '}' or the start of another statement.
+	///
+	/// \param start Cursor at the start of the statement.
+	/// If nothing has been consumed since, one token is skipped so parsing always makes progress.
+	void SynchronizeStatement(uint64_t start);
+
+	/// Leave panic mode, and skip the rest of a definition which failed to parse.
+	/// Stops after a semicolon ';' or a block, or before an unmatched closing brace '}'
+	/// or the start of another definition.
+	///
+	/// \param start Cursor at the start of the definition.
+	/// If nothing has been consumed since, one token is skipped so parsing always makes progress.
+	void SynchronizeDefinition(uint64_t start);
+
+	/// Create an AST node in the module's arena.
+	///
+	/// \tparam T Type of the node.
 	/// 
-	/// \throw int if the check fails.
-	const Token& Ensure(TokenType type, const std::string& message);
+	/// \return The node, owned by the module.
+	template<typename T>
+	T* Make() { return m_Module->Nodes.Make<T>(); }
+
+	/// Step the cursor back by one token, to look at the previous token again.
+	void Rewind()
+	{
+		m_Tok--;
+		m_Rewinds++;
+	}
+
+	/// Add the counts of the parse to the statistics of the context.
+	void RecordStatistics();
 
 	CompileContext& m_Context;
 	up<Module> m_Module;
-	const std::vector<Token>& m_Tokens;
+	const Lexer& m_Lexer;
+	const std::vector<Token>* m_Tokens = nullptr;
+	TokenStream* m_Stream = nullptr;
 	uint64_t m_Tok = 0;
 	std::vector<Diagnostic> m_Diagnostics;
+	Symbol m_OperatorSymbol;
+	bool m_Panic = false;
+	uint32_t m_ExpressionDepth = 0;
+
+	uint64_t m_Rewinds = 0;
+	uint64_t m_FunctionLookaheads = 0;
 };
 
 }
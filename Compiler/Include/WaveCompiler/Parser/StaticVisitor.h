@@ -0,0 +1,122 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "AST.h"
+
+namespace Wave {
+
+/// Visitor of the AST which is dispatched on the kind of a node instead of through virtual calls,
+/// so the compiler can inline the visit into the dispatch.
+///
+/// The derived visitor implements Visit for the node types it handles. Visit can return a Result
+/// and take any extra arguments, which Dispatch forwards with their own types.
+/// Every node type that can be dispatched to must have a matching Visit, but overloads
+/// for Statement, Definition, Expression or Type can be used to handle every other node of that base.
+///
+/// \tparam Derived The derived visitor.
+/// \tparam Result What Visit returns.
+template<typename Derived, typename Result = void>
+class StaticVisitor
+{
+public:
+	/// Visit a statement or definition with the Visit of its concrete type.
+	///
+	/// \param node The node.
+	/// \param args Extra arguments to pass on to Visit.
+	/// 
+	/// \return What Visit returned.
+	template<typename... Args>
+	Result Dispatch(Statement& node, Args&&... args)
+	{
+		auto& self = static_cast<Derived&>(*this);
+		switch (node.Kind)
+		{
+		case NodeKind::Abstract: return self.Visit(static_cast<Abstract&>(node), std::forward<Args>(args)...);
+		case NodeKind::Block: return self.Visit(static_cast<Block&>(node), std::forward<Args>(args)...);
+		case NodeKind::Break: return self.Visit(static_cast<Break&>(node), std::forward<Args>(args)...);
+		case NodeKind::ClassDefinition: return self.Visit(static_cast<ClassDefinition&>(node), std::forward<Args>(args)...);
+		case NodeKind::ConditionFor: return self.Visit(static_cast<ConditionFor&>(node), std::forward<Args>(args)...);
+		case NodeKind::Constructor: return self.Visit(static_cast<Constructor&>(node), std::forward<Args>(args)...);
+		case NodeKind::Continue: return self.Visit(static_cast<Continue&>(node), std::forward<Args>(args)...);
+		case NodeKind::EnumDefinition: return self.Visit(static_cast<EnumDefinition&>(node), std::forward<Args>(args)...);
+		case NodeKind::ExpressionStatement: return self.Visit(static_cast<ExpressionStatement&>(node), std::forward<Args>(args)...);
+		case NodeKind::FunctionDefinition: return self.Visit(static_cast<FunctionDefinition&>(node), std::forward<Args>(args)...);
+		case NodeKind::Getter: return self.Visit(static_cast<Getter&>(node), std::forward<Args>(args)...);
+		case NodeKind::If: return self.Visit(static_cast<If&>(node), std::forward<Args>(args)...);
+		case NodeKind::Method: return self.Visit(static_cast<Method&>(node), std::forward<Args>(args)...);
+		case NodeKind::OperatorOverload: return self.Visit(static_cast<OperatorOverload&>(node), std::forward<Args>(args)...);
+		case NodeKind::RangeFor: return self.Visit(static_cast<RangeFor&>(node), std::forward<Args>(args)...);
+		case NodeKind::Return: return self.Visit(static_cast<Return&>(node), std::forward<Args>(args)...);
+		case NodeKind::Setter: return self.Visit(static_cast<Setter&>(node), std::forward<Args>(args)...);
+		case NodeKind::Throw: return self.Visit(static_cast<Throw&>(node), std::forward<Args>(args)...);
+		case NodeKind::Try: return self.Visit(static_cast<Try&>(node), std::forward<Args>(args)...);
+		case NodeKind::VarDefinition: return self.Visit(static_cast<VarDefinition&>(node), std::forward<Args>(args)...);
+		case NodeKind::While: return self.Visit(static_cast<While&>(node), std::forward<Args>(args)...);
+		default: return Result();
+		}
+	}
+
+	/// Visit an expression with the Visit of its concrete type.
+	///
+	/// \param node The node.
+	/// \param args Extra arguments to pass on to Visit.
+	/// 
+	/// \return What Visit returned.
+	template<typename... Args>
+	Result Dispatch(Expression& node, Args&&... args)
+	{
+		auto& self = static_cast<Derived&>(*this);
+		switch (node.Kind)
+		{
+		case NodeKind::ArrayIndex: return self.Visit(static_cast<ArrayIndex&>(node), std::forward<Args>(args)...);
+		case NodeKind::Assignment: return self.Visit(static_cast<Assignment&>(node), std::forward<Args>(args)...);
+		case NodeKind::Binary: return self.Visit(static_cast<Binary&>(node), std::forward<Args>(args)...);
+		case NodeKind::Call: return self.Visit(static_cast<Call&>(node), std::forward<Args>(args)...);
+		case NodeKind::Function: return self.Visit(static_cast<Function&>(node), std::forward<Args>(args)...);
+		case NodeKind::Group: return self.Visit(static_cast<Group&>(node), std::forward<Args>(args)...);
+		case NodeKind::InitializerList: return self.Visit(static_cast<InitializerList&>(node), std::forward<Args>(args)...);
+		case NodeKind::Literal: return self.Visit(static_cast<Literal&>(node), std::forward<Args>(args)...);
+		case NodeKind::Logical: return self.Visit(static_cast<Logical&>(node), std::forward<Args>(args)...);
+		case NodeKind::Unary: return self.Visit(static_cast<Unary&>(node), std::forward<Args>(args)...);
+		case NodeKind::VarAccess: return self.Visit(static_cast<VarAccess&>(node), std::forward<Args>(args)...);
+		default: return Result();
+		}
+	}
+
+	/// Visit a type with the Visit of its concrete type.
+	///
+	/// \param node The node.
+	/// \param args Extra arguments to pass on to Visit.
+	/// 
+	/// \return What Visit returned.
+	template<typename... Args>
+	Result Dispatch(Type& node, Args&&... args)
+	{
+		auto& self = static_cast<Derived&>(*this);
+		switch (node.Kind)
+		{
+		case NodeKind::ArrayType: return self.Visit(static_cast<ArrayType&>(node), std::forward<Args>(args)...);
+		case NodeKind::ClassType: return self.Visit(static_cast<ClassType&>(node), std::forward<Args>(args)...);
+		case NodeKind::FuncType: return self.Visit(static_cast<FuncType&>(node), std::forward<Args>(args)...);
+		case NodeKind::SimpleType: return self.Visit(static_cast<SimpleType&>(node), std::forward<Args>(args)...);
+		case NodeKind::TupleType: return self.Visit(static_cast<TupleType&>(node), std::forward<Args>(args)...);
+		case NodeKind::TypeOf: return self.Visit(static_cast<TypeOf&>(node), std::forward<Args>(args)...);
+		default: return Result();
+		}
+	}
+};
+
+}
@@ -0,0 +1,233 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Wave {
+
+/// Vector which keeps its first N elements inside itself, and only allocates once it grows past them.
+/// Meant for the short lists of the AST, which usually hold a handful of elements.
+/// Has the interface of std::vector that the compiler uses, so it can replace one directly.
+///
+/// \tparam T Type of the elements.
+/// \tparam N Number of elements stored inline.
+template<typename T, uint32_t N>
+class SmallVector
+{
+	static_assert(N > 0, "SmallVector needs inline storage, use std::vector instead");
+	static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "over-aligned elements are not supported");
+
+public:
+	using value_type = T;
+	using size_type = size_t;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	SmallVector() = default;
+
+	SmallVector(std::initializer_list<T> elements) { Append(elements.begin(), elements.end()); }
+
+	SmallVector(const SmallVector& other) { Append(other.begin(), other.end()); }
+
+	SmallVector(SmallVector&& other) noexcept { Take(other); }
+
+	SmallVector& operator=(const SmallVector& other)
+	{
+		if (this != &other)
+		{
+			clear();
+			Append(other.begin(), other.end());
+		}
+
+		return *this;
+	}
+
+	SmallVector& operator=(SmallVector&& other) noexcept
+	{
+		if (this != &other)
+		{
+			clear();
+			Free();
+			Take(other);
+		}
+
+		return *this;
+	}
+
+	~SmallVector()
+	{
+		clear();
+		Free();
+	}
+
+	T* data() { return m_Data; }
+	const T* data() const { return m_Data; }
+
+	T* begin() { return m_Data; }
+	T* end() { return m_Data + m_Size; }
+	const T* begin() const { return m_Data; }
+	const T* end() const { return m_Data + m_Size; }
+
+	std::reverse_iterator<T*> rbegin() { return std::reverse_iterator<T*>(end()); }
+	std::reverse_iterator<T*> rend() { return std::reverse_iterator<T*>(begin()); }
+	std::reverse_iterator<const T*> rbegin() const { return std::reverse_iterator<const T*>(end()); }
+	std::reverse_iterator<const T*> rend() const { return std::reverse_iterator<const T*>(begin()); }
+
+	size_t size() const { return m_Size; }
+	size_t capacity() const { return m_Capacity; }
+	bool empty() const { return m_Size == 0; }
+
+	/// Check if the elements have moved out of the inline storage.
+	///
+	/// \return If the elements are on the heap.
+	bool IsOnHeap() const { return m_Data != Inline(); }
+
+	T& operator[](size_t index) { return m_Data[index]; }
+	const T& operator[](size_t index) const { return m_Data[index]; }
+
+	T& front() { return m_Data[0]; }
+	T& back() { return m_Data[m_Size - 1]; }
+	const T& front() const { return m_Data[0]; }
+	const T& back() const { return m_Data[m_Size - 1]; }
+
+	void push_back(const T& element) { emplace_back(element); }
+	void push_back(T&& element) { emplace_back(std::move(element)); }
+
+	template<typename... Args>
+	T& emplace_back(Args&&... args)
+	{
+		if (m_Size == m_Capacity)
+		{
+			// The arguments may refer to an element, so construct the new one before moving the old ones.
+			auto capacity = m_Capacity * 2;
+			auto elements = Allocate(capacity);
+			new (elements + m_Size) T(std::forward<Args>(args)...);
+			MoveTo(elements, capacity);
+		}
+		else
+		{
+			new (m_Data + m_Size) T(std::forward<Args>(args)...);
+		}
+
+		return m_Data[m_Size++];
+	}
+
+	void pop_back() { m_Data[--m_Size].~T(); }
+
+	void clear()
+	{
+		std::destroy(begin(), end());
+		m_Size = 0;
+	}
+
+	void reserve(size_t capacity)
+	{
+		if (capacity > m_Capacity) { MoveTo(Allocate(capacity), static_cast<uint32_t>(capacity)); }
+	}
+
+	void resize(size_t size)
+	{
+		if (size < m_Size)
+		{
+			std::destroy(begin() + size, end());
+		}
+		else
+		{
+			reserve(size);
+			std::uninitialized_value_construct(end(), begin() + size);
+		}
+
+		m_Size = static_cast<uint32_t>(size);
+	}
+
+	bool operator==(const SmallVector& other) const
+	{
+		if (m_Size != other.m_Size) { return false; }
+
+		for (uint32_t i = 0; i < m_Size; i++)
+		{
+			if (!(m_Data[i] == other.m_Data[i])) { return false; }
+		}
+
+		return true;
+	}
+
+	bool operator!=(const SmallVector& other) const { return !(*this == other); }
+
+private:
+	T* Inline() { return reinterpret_cast<T*>(m_Inline); }
+	const T* Inline() const { return reinterpret_cast<const T*>(m_Inline); }
+
+	static T* Allocate(size_t capacity) { return static_cast<T*>(::operator new(capacity * sizeof(T))); }
+
+	void Free()
+	{
+		if (IsOnHeap()) { ::operator delete(m_Data); }
+		m_Data = Inline();
+		m_Capacity = N;
+	}
+
+	/// Move the elements to new storage, and free the old storage.
+	void MoveTo(T* elements, uint32_t capacity)
+	{
+		std::uninitialized_move(begin(), end(), elements);
+		std::destroy(begin(), end());
+		Free();
+
+		m_Data = elements;
+		m_Capacity = capacity;
+	}
+
+	template<typename It>
+	void Append(It first, It last)
+	{
+		reserve(m_Size + static_cast<size_t>(last - first));
+		std::uninitialized_copy(first, last, end());
+		m_Size += static_cast<uint32_t>(last - first);
+	}
+
+	/// Take the elements of another vector, stealing its heap storage if it has any.
+	void Take(SmallVector& other)
+	{
+		if (other.IsOnHeap())
+		{
+			m_Data = other.m_Data;
+			m_Size = other.m_Size;
+			m_Capacity = other.m_Capacity;
+			other.m_Data = other.Inline();
+			other.m_Size = 0;
+			other.m_Capacity = N;
+			return;
+		}
+
+		std::uninitialized_move(other.begin(), other.end(), Inline());
+		m_Size = other.m_Size;
+		other.clear();
+	}
+
+	T* m_Data = Inline();
+	uint32_t m_Size = 0;
+	uint32_t m_Capacity = N;
+	alignas(T) unsigned char m_Inline[N * sizeof(T)];
+};
+
+}
@@ -0,0 +1,91 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <filesystem>
+#include <istream>
+#include <string>
+
+#include "Global.h"
+
+namespace Wave {
+
+/// The contents of a source file, held in one contiguous buffer.
+/// Files are memory-mapped where the platform allows it, and read in one go otherwise.
+class SourceBuffer
+{
+public:
+	/// Smallest file which is mapped. Smaller files are read, which is as fast,
+	/// and does not use up one of the limited number of mappings of the process.
+	static constexpr uint64_t MinMapSize = 64 * 1024;
+
+	/// Load a file into a buffer.
+	///
+	/// \param filePath The path of the file.
+	/// \param map If the file may be mapped, and not only read.
+	SourceBuffer(const std::filesystem::path& filePath, bool map = true);
+
+	/// Read an entire input stream into a buffer.
+	///
+	/// \param filePath The path of the file the stream was opened from.
+	/// \param stream std::istream to read from.
+	SourceBuffer(const std::filesystem::path& filePath, std::istream& stream);
+
+	/// Unmap or free the buffer.
+	~SourceBuffer();
+
+	SourceBuffer(const SourceBuffer&) = delete;
+	SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+	/// Check if the file could be loaded.
+	///
+	/// \return If the buffer holds the file contents.
+	bool IsValid() const { return m_Valid; }
+
+	/// Check if the file is mapped into memory.
+	///
+	/// \return If the buffer is a mapping of the file.
+	bool IsMapped() const { return m_Mapped; }
+
+	/// Get the first character of the buffer.
+	///
+	/// \return Pointer to the start of the buffer.
+	const char* GetData() const { return m_Data; }
+
+	/// Get the size of the buffer.
+	///
+	/// \return The number of characters in the buffer.
+	uint64_t GetSize() const { return m_Size; }
+
+	/// Get the path of the file.
+	///
+	/// \return The path.
+	const std::filesystem::path& GetPath() const { return m_Path; }
+
+private:
+	/// Map the file into memory, if the platform allows it and the file is large enough.
+	///
+	/// \return If the file was mapped.
+	bool Map();
+
+	std::filesystem::path m_Path;
+	const char* m_Data = "";
+	uint64_t m_Size = 0;
+	bool m_Valid = false;
+	bool m_Mapped = false;
+	std::string m_Storage;
+};
+
+}
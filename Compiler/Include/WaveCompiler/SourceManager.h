@@ -0,0 +1,130 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "Global.h"
+#include "Diagnostic.h"
+#include "SourceBuffer.h"
+
+namespace Wave {
+
+/// A line and column in a source file, both starting at 1.
+struct SourceLocation
+{
+	uint32_t Line = 1;
+	uint32_t Column = 1;
+};
+
+/// Owner of the contents of every source file being compiled.
+/// Files are loaded once, and a table of line starts is built the first time
+/// a location in the file is looked up.
+class SourceManager
+{
+public:
+	SourceManager() = default;
+
+	SourceManager(const SourceManager&) = delete;
+	SourceManager& operator=(const SourceManager&) = delete;
+
+	/// Most files that can be registered, as many as a FileID can tell apart.
+	static constexpr size_t MaxFiles = static_cast<size_t>(std::numeric_limits<FileID>::max()) + 1;
+
+	/// Size of the largest file that can be lexed, as positions in a file are 32-bit.
+	static constexpr uint64_t MaxFileSize = std::numeric_limits<uint32_t>::max();
+
+	/// Most files that are mapped into memory, the rest are read.
+	/// Keeps well under the limit on mappings of a process, which the heap needs too.
+	static constexpr size_t MaxMappedFiles = 16384;
+
+	/// Load a source file and register it.
+	/// The file is registered even if it could not be read, check the buffer for validity.
+	/// At most MaxFiles files can be registered.
+	///
+	/// \param filePath The path of the file.
+	/// 
+	/// \return The ID of the file.
+	FileID AddFile(const std::filesystem::path& filePath);
+
+	/// Register a source file which has already been loaded.
+	/// At most MaxFiles files can be registered.
+	///
+	/// \param buffer The contents of the file.
+	/// 
+	/// \return The ID of the file.
+	FileID AddFile(std::unique_ptr<SourceBuffer> buffer);
+
+	/// Get the number of registered source files.
+	///
+	/// \return The number of files.
+	size_t GetFileCount() const { return m_Files.size(); }
+
+	/// Get the contents of a registered source file.
+	///
+	/// \param file The ID of the file.
+	/// 
+	/// \return The buffer.
+	const SourceBuffer& GetBuffer(FileID file) const { return *m_Files[file].Buffer; }
+
+	/// Get the path of a registered source file.
+	///
+	/// \param file The ID of the file.
+	/// 
+	/// \return The path.
+	const std::filesystem::path& GetPath(FileID file) const { return m_Files[file].Buffer->GetPath(); }
+
+	/// Get the line and column of a position in a source file.
+	///
+	/// \param file The ID of the file.
+	/// \param pos Offset of the character in the file.
+	/// 
+	/// \return The location.
+	SourceLocation GetLocation(FileID file, uint32_t pos) const;
+
+	/// Get a line of a source file.
+	///
+	/// \param file The ID of the file.
+	/// \param line The line, starting at 1.
+	/// 
+	/// \return The line, without the line ending. Empty if the line does not exist.
+	std::string_view GetLine(FileID file, uint32_t line) const;
+
+private:
+	struct File
+	{
+		std::unique_ptr<SourceBuffer> Buffer;
+		mutable std::once_flag LinesBuilt;
+		mutable std::vector<uint32_t> LineStarts;
+	};
+
+	/// Get the line starts of a file, building them if needed.
+	///
+	/// \param file The file.
+	/// 
+	/// \return Offsets of the first character of every line.
+	const std::vector<uint32_t>& GetLineStarts(const File& file) const;
+
+	std::deque<File> m_Files;
+	size_t m_MappedFiles = 0;
+};
+
+}
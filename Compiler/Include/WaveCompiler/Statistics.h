@@ -0,0 +1,104 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "Global.h"
+
+namespace Wave {
+
+/// Thread-safe named counters describing what the compiler saw and did,
+/// such as the number of tokens of each type, or of AST nodes of each kind.
+/// Counters are kept in groups, and are only updated once enabled.
+///
+/// Taking a lock for every token or node would be too slow, so phases count locally,
+/// and add their totals once they are done with a file.
+class Statistics
+{
+public:
+	Statistics() = default;
+
+	Statistics(const Statistics&) = delete;
+	Statistics& operator=(const Statistics&) = delete;
+
+	/// Start or stop collecting statistics.
+	///
+	/// \param on If statistics should be collected.
+	void SetEnabled(bool on) { m_Enabled = on; }
+
+	/// Check if statistics are being collected.
+	///
+	/// \return If collecting is on.
+	bool IsEnabled() const { return m_Enabled; }
+
+	/// Add to a counter, which starts at 0.
+	///
+	/// \param group The group of the counter.
+	/// \param name The name of the counter.
+	/// \param value The value to add.
+	void Add(std::string_view group, std::string_view name, uint64_t value = 1);
+
+	/// Raise a counter to at least a value.
+	///
+	/// \param group The group of the counter.
+	/// \param name The name of the counter.
+	/// \param value The value.
+	void Max(std::string_view group, std::string_view name, uint64_t value);
+
+	/// Set a statistic which is not a count, like a time or a ratio.
+	///
+	/// \param group The group of the statistic.
+	/// \param name The name of the statistic.
+	/// \param value The value.
+	void Set(std::string_view group, std::string_view name, double value);
+
+	/// Print every statistic as a table, by group.
+	///
+	/// \param stream Stream to print to.
+	void Print(std::ostream& stream) const;
+
+	/// Write every statistic as a JSON object of groups.
+	///
+	/// \param stream Stream to write to.
+	void WriteJSON(std::ostream& stream) const;
+
+private:
+	struct Value
+	{
+		uint64_t Count = 0;
+		double Real = 0.0;
+		bool IsReal = false;
+	};
+
+	/// Get a statistic, creating it if it does not exist yet. The mutex must be held.
+	///
+	/// \param group The group of the statistic.
+	/// \param name The name of the statistic.
+	/// 
+	/// \return The statistic.
+	Value& Get(std::string_view group, std::string_view name);
+
+	bool m_Enabled = false;
+	mutable std::mutex m_Mutex;
+	std::map<std::string, std::map<std::string, Value, std::less<>>, std::less<>> m_Groups;
+};
+
+}
@@ -0,0 +1,81 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Global.h"
+
+namespace Wave {
+
+/// ID of an interned string.
+using Symbol = uint32_t;
+
+/// Symbol that no string is interned as.
+/// Tokens that failed to parse have it, so they never alias a real name.
+constexpr Symbol InvalidSymbol = 0;
+
+/// Thread-safe table of interned identifiers and string literals.
+/// Each distinct string is stored once, and is referred to by its Symbol,
+/// so comparing two strings interned in the same table is an integer compare.
+class SymbolTable
+{
+public:
+	SymbolTable() = default;
+
+	SymbolTable(const SymbolTable&) = delete;
+	SymbolTable& operator=(const SymbolTable&) = delete;
+
+	/// Intern a string.
+	///
+	/// \param string The string to intern.
+	/// 
+	/// \return The symbol of the string, the same for every equal string.
+	Symbol Intern(std::string_view string);
+
+	/// Get the string a symbol refers to.
+	///
+	/// \param symbol The symbol, which must have been returned by Intern() or be InvalidSymbol.
+	/// 
+	/// \return The string, which lives as long as the table. Empty for InvalidSymbol.
+	std::string_view GetString(Symbol symbol) const;
+
+	/// Get the number of distinct strings in the table.
+	///
+	/// \return The number of symbols.
+	uint32_t GetSize() const;
+
+private:
+	/// Copy a string into the table's storage.
+	///
+	/// \param string The string to copy.
+	/// 
+	/// \return View of the copy.
+	std::string_view Store(std::string_view string);
+
+	mutable std::shared_mutex m_Mutex;
+	std::unordered_map<std::string_view, Symbol> m_Symbols;
+	std::vector<std::string_view> m_Strings = { std::string_view() };
+	std::vector<std::unique_ptr<char[]>> m_Blocks;
+	uint64_t m_BlockUsed = 0;
+	uint64_t m_BlockSize = 0;
+};
+
+}
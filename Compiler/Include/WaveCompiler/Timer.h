@@ -0,0 +1,222 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Global.h"
+#include "Diagnostic.h"
+
+namespace Wave {
+
+class SourceManager;
+
+/// Wall and CPU time spent in a phase, summed over every time it ran.
+struct TimeRecord
+{
+	/// Wall time, in seconds.
+	double Wall = 0.0;
+
+	/// CPU time of the threads the phase ran on, in seconds.
+	double CPU = 0.0;
+
+	/// Number of times the phase ran.
+	uint64_t Count = 0;
+};
+
+/// Thread-safe tree of phase timers, filled in by ScopedTimer.
+/// A timer started while another is running on the same thread is recorded as its child,
+/// so phases nest the same way the code that runs them does.
+///
+/// Timers can also be traced: every timed scope is kept as an event of the thread it ran on,
+/// and written out in the Chrome trace event format.
+class TimerRegistry
+{
+public:
+	TimerRegistry() = default;
+
+	TimerRegistry(const TimerRegistry&) = delete;
+	TimerRegistry& operator=(const TimerRegistry&) = delete;
+
+	/// Start or stop recording the time report. Timers cost nothing while nothing is recorded.
+	///
+	/// \param on If timers should record.
+	void SetEnabled(bool on);
+
+	/// Check if the time report is being recorded.
+	///
+	/// \return If recording is on.
+	bool IsEnabled() const { return m_Enabled; }
+
+	/// Start or stop tracing timed scopes.
+	///
+	/// \param on If scopes should be traced.
+	/// \param granularity Scopes shorter than this many microseconds are left out.
+	void SetTraceEnabled(bool on, uint32_t granularity = 0);
+
+	/// Check if timed scopes are being traced.
+	///
+	/// \return If tracing is on.
+	bool IsTraceEnabled() const { return m_Trace; }
+
+	/// Name the calling thread in the trace.
+	///
+	/// \param name The name.
+	void SetThreadName(const std::string& name);
+
+	/// Write the traced scopes as Chrome trace event JSON,
+	/// which can be opened in chrome://tracing or Perfetto.
+	/// No timer may be running.
+	///
+	/// \param stream Stream to write to.
+	/// \param sources Source files, to name files by.
+	void WriteTrace(std::ostream& stream, const SourceManager& sources) const;
+
+	/// Print the recorded times as a table,
+	/// with every phase under its parent, followed by the slowest files.
+	///
+	/// \param stream Stream to print to.
+	/// \param sources Source files, to name files by.
+	void Print(std::ostream& stream, const SourceManager& sources) const;
+
+private:
+	friend class ScopedTimer;
+
+	struct Node
+	{
+		std::string Name;
+		TimeRecord Time;
+		std::vector<std::unique_ptr<Node>> Children;
+	};
+
+	struct TraceEvent
+	{
+		const char* Name;
+		std::string Detail;
+		FileID File;
+		bool HasFile;
+		double Start;
+		double Duration;
+	};
+
+	struct ThreadTrace
+	{
+		uint32_t ID;
+		std::string Name;
+		std::vector<TraceEvent> Events;
+	};
+
+	/// Get the trace of the calling thread, adding one the first time a thread asks.
+	///
+	/// \return The trace, which only the calling thread may add to.
+	ThreadTrace& GetThreadTrace();
+
+	/// Find the child of a node with a name, adding it if there is none.
+	///
+	/// \param parent The parent node, or null for a top level phase.
+	/// \param name The name of the phase.
+	/// 
+	/// \return The node.
+	Node* GetNode(Node* parent, const char* name);
+
+	/// Add time to a node.
+	///
+	/// \param node The node.
+	/// \param wall Wall time, in seconds.
+	/// \param cpu CPU time, in seconds.
+	/// \param file The file the time was spent on, if it is a top level phase of one.
+	void Record(Node* node, double wall, double cpu, const FileID* file);
+
+	/// Add an event to the trace of the calling thread.
+	///
+	/// \param event The event, with its start relative to when tracing started.
+	void Trace(TraceEvent&& event);
+
+	/// Print a node and its children.
+	///
+	/// \param stream Stream to print to.
+	/// \param node The node.
+	/// \param total Time all percentages are relative to.
+	/// \param depth Indentation of the node.
+	void PrintNode(std::ostream& stream, const Node& node, const TimeRecord& total, uint32_t depth) const;
+
+	/// Trace of the calling thread, cached so adding an event does not lock.
+	static thread_local ThreadTrace* s_Thread;
+	static thread_local const TimerRegistry* s_ThreadOwner;
+
+	bool m_Enabled = false;
+	bool m_Trace = false;
+	double m_Granularity = 0.0;
+	std::chrono::steady_clock::time_point m_Start;
+	std::chrono::steady_clock::time_point m_TraceStart;
+	mutable std::mutex m_Mutex;
+	Node m_Root;
+	std::map<FileID, TimeRecord> m_Files;
+	std::vector<std::unique_ptr<ThreadTrace>> m_Threads;
+};
+
+/// Times the scope it lives in, recording it as a phase of a TimerRegistry.
+class ScopedTimer
+{
+public:
+	/// Start timing a phase.
+	///
+	/// \param registry The registry to record in.
+	/// \param name The name of the phase, which must outlive the registry.
+	ScopedTimer(TimerRegistry& registry, const char* name);
+
+	/// Start timing a phase of a single file.
+	/// The time of top level phases is added to the total of the file.
+	///
+	/// \param registry The registry to record in.
+	/// \param name The name of the phase, which must outlive the registry.
+	/// \param file The file.
+	ScopedTimer(TimerRegistry& registry, const char* name, FileID file);
+
+	/// Stop timing, and record the time.
+	~ScopedTimer();
+
+	/// Describe what the scope is working on, such as the name of a definition.
+	/// Only shows up in the trace.
+	///
+	/// \param detail The description.
+	void SetDetail(std::string_view detail);
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+	/// Innermost timer running on this thread, which new timers are children of.
+	static thread_local TimerRegistry::Node* s_Current;
+
+	TimerRegistry* m_Registry = nullptr;
+	const char* m_Name = nullptr;
+	std::string m_Detail;
+	TimerRegistry::Node* m_Node = nullptr;
+	TimerRegistry::Node* m_Parent = nullptr;
+	FileID m_File = 0;
+	bool m_HasFile = false;
+	std::chrono::steady_clock::time_point m_Wall;
+	double m_CPU = 0.0;
+};
+
+}
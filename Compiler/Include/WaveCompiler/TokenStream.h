@@ -0,0 +1,89 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cassert>
+
+#include "Lexer.h"
+
+namespace Wave {
+
+/// Pull-based view of the tokens of a lexer, which lexes them on demand.
+/// Tokens are kept in a ring buffer from the oldest one not yet released
+/// to the furthest one looked at, so memory stays bounded by the lookahead
+/// of the consumer instead of the size of the file.
+/// With a tee, every token is also printed as it is lexed,
+/// giving the same output as Lexer::Lex() does with debug output.
+class TokenStream
+{
+public:
+	/// Construct a token stream.
+	///
+	/// \param lexer Lexer to pull tokens from, which should not have run.
+	/// \param capacity Initial number of tokens the ring buffer can hold, rounded up to a power of two.
+	/// \param tee If tokens should be printed to standard output as they are lexed.
+	TokenStream(Lexer& lexer, uint32_t capacity = 64, bool tee = false);
+
+	/// Get a token, lexing up to it if it has not been lexed yet.
+	/// The ring buffer grows if the token does not fit in it.
+	/// Any index past the end of the file gets the Null token ending it.
+	///
+	/// \param index Index of the token in the file, which must not have been released.
+	/// 
+	/// \return The token, valid until the next call to Get().
+	const Token& Get(uint64_t index)
+	{
+		assert(index >= m_Begin && "token has been released");
+
+		// Most gets are for tokens the parser has already looked at.
+		if (index < m_End) { return m_Ring[index & m_Mask]; }
+		return LexTo(index);
+	}
+
+	/// Allow the slots of all tokens before an index to be reused.
+	///
+	/// \param index Index of the first token that is still needed.
+	void Release(uint64_t index);
+
+	/// Get the lexer tokens are pulled from.
+	///
+	/// \return The lexer.
+	Lexer& GetLexer() { return m_Lexer; }
+
+	/// Get the number of tokens the ring buffer can hold.
+	///
+	/// \return The capacity.
+	uint64_t GetCapacity() const { return m_Ring.size(); }
+
+private:
+	/// Lex tokens until one has been lexed, or the end of the file has.
+	///
+	/// \param index Index of the token, which has not been lexed yet.
+	///
+	/// \return The token, or the Null token if it is past the end.
+	const Token& LexTo(uint64_t index);
+
+	/// Double the capacity of the ring buffer.
+	void Grow();
+
+	Lexer& m_Lexer;
+	std::vector<Token> m_Ring;
+	uint64_t m_Mask;
+	uint64_t m_Begin = 0;
+	uint64_t m_End = 0;
+	bool m_Tee;
+};
+
+}
@@ -0,0 +1,51 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Arena.h"
+
+#include <algorithm>
+
+namespace Wave {
+
+namespace {
+
+constexpr uint64_t BlockSize = 64 * 1024;
+
+}
+
+Arena::~Arena()
+{
+	// The list is newest first, so objects are destroyed in reverse order of creation.
+	for (auto destructor = m_Destructors; destructor; destructor = destructor->Next)
+	{
+		destructor->Destroy(destructor->Object);
+	}
+}
+
+void* Arena::AllocateBlock(uint64_t size)
+{
+	// Objects larger than a block get a block of their own.
+	// new[] memory is aligned for any fundamental type, so no padding is needed at the start.
+	uint64_t blockSize = std::max(BlockSize, size);
+	m_Blocks.emplace_back(new char[blockSize]);
+
+	char* memory = m_Blocks.back().get();
+	m_Cur = memory + size;
+	m_End = memory + blockSize;
+	m_BytesUsed += size;
+
+	return memory;
+}
+
+}
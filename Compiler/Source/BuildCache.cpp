@@ -0,0 +1,375 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BuildCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string_view>
+
+#include "CompileContext.h"
+
+#ifndef WAVE_VERSION
+#define WAVE_VERSION "unknown"
+#endif
+
+namespace Wave {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// Version of the entry format. Bump it whenever the lexer or the parser change what they report,
+/// as well as when the format changes, so that entries of older compilers are never used.
+constexpr uint32_t CacheFormat = 1;
+
+constexpr char EntryMagic[4] = { 'W', 'V', 'C', 'E' };
+constexpr const char* EntryExtension = ".wvc";
+
+constexpr uint64_t HashPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t HashPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t HashPrime3 = 0x165667B19E3779F9ull;
+
+uint64_t RotateLeft(uint64_t value, uint32_t count)
+{
+	return (value << count) | (value >> (64 - count));
+}
+
+uint64_t MixWord(uint64_t hash, uint64_t word)
+{
+	hash ^= RotateLeft(word * HashPrime2, 31) * HashPrime1;
+	return RotateLeft(hash, 27) * HashPrime1 + HashPrime3;
+}
+
+bool IsSymbol(TokenType type)
+{
+	return type == TokenType::Identifier || type == TokenType::String;
+}
+
+/// Appends the fields of an entry to a buffer.
+class EntryWriter
+{
+public:
+	template<typename T>
+	void Write(T value)
+	{
+		char bytes[sizeof(T)];
+		memcpy(bytes, &value, sizeof(T));
+		m_Data.append(bytes, sizeof(T));
+	}
+
+	void Write(std::string_view string)
+	{
+		Write(static_cast<uint32_t>(string.size()));
+		m_Data.append(string);
+	}
+
+	void Write(const Token& token, const SymbolTable& symbols)
+	{
+		Write(token.Pos);
+		Write(token.Length);
+		Write(static_cast<uint8_t>(token.Type));
+		if (IsSymbol(token.Type)) { Write(symbols.GetString(static_cast<Symbol>(token.Value))); }
+		else { Write(token.Value); }
+	}
+
+	void Write(const Identifier& identifier, const SymbolTable& symbols)
+	{
+		Write(static_cast<uint32_t>(identifier.Path.size()));
+		for (auto& token : identifier.Path) { Write(token, symbols); }
+	}
+
+	const std::string& GetData() const { return m_Data; }
+
+private:
+	std::string m_Data;
+};
+
+/// Reads the fields of an entry back. Reading past the end fails every later read.
+class EntryReader
+{
+public:
+	EntryReader(std::string_view data) : m_Data(data) {}
+
+	template<typename T>
+	bool Read(T& value)
+	{
+		if (!m_Good || m_Data.size() < sizeof(T)) { return m_Good = false; }
+
+		memcpy(&value, m_Data.data(), sizeof(T));
+		m_Data.remove_prefix(sizeof(T));
+		return true;
+	}
+
+	bool Read(std::string_view& string)
+	{
+		uint32_t size;
+		if (!Read(size) || m_Data.size() < size) { return m_Good = false; }
+
+		string = m_Data.substr(0, size);
+		m_Data.remove_prefix(size);
+		return true;
+	}
+
+	bool Read(Token& token, FileID file, SymbolTable& symbols)
+	{
+		uint8_t type;
+		if (!Read(token.Pos) || !Read(token.Length) || !Read(type) || type > static_cast<uint8_t>(TokenType::Null))
+		{
+			return m_Good = false;
+		}
+
+		token.Type = static_cast<TokenType>(type);
+		token.File = file;
+		if (IsSymbol(token.Type))
+		{
+			std::string_view string;
+			if (!Read(string)) { return false; }
+			token.Value = symbols.Intern(string);
+			return true;
+		}
+
+		return Read(token.Value);
+	}
+
+	bool Read(Identifier& identifier, FileID file, SymbolTable& symbols)
+	{
+		uint32_t count;
+		if (!Read(count) || count > m_Data.size()) { return m_Good = false; }
+
+		identifier.Path.resize(count);
+		for (auto& token : identifier.Path)
+		{
+			if (!Read(token, file, symbols)) { return false; }
+		}
+		return true;
+	}
+
+	bool IsDone() const { return m_Good && m_Data.empty(); }
+
+private:
+	std::string_view m_Data;
+	bool m_Good = true;
+};
+
+}
+
+BuildCache::BuildCache(CompileContext& context, const fs::path& directory, uint64_t maxSize)
+	: m_Context(context), m_Directory(directory), m_MaxSize(maxSize)
+{
+	constexpr std::string_view version = "wavec " WAVE_VERSION;
+	m_Seed = Hash(version.data(), version.size(), CacheFormat);
+	m_TempID = (static_cast<uint64_t>(std::random_device()()) << 32) | std::random_device()();
+
+	std::error_code error;
+	fs::create_directories(m_Directory, error);
+	m_Valid = fs::is_directory(m_Directory, error);
+}
+
+uint64_t BuildCache::Hash(const char* data, uint64_t size, uint64_t seed)
+{
+	uint64_t hash = seed + HashPrime3 + size * HashPrime1;
+
+	uint64_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, data + i, 8);
+		hash = MixWord(hash, word);
+	}
+
+	if (i < size)
+	{
+		uint64_t word = 0;
+		memcpy(&word, data + i, size - i);
+		hash = MixWord(hash, word);
+	}
+
+	hash ^= hash >> 33;
+	hash *= HashPrime2;
+	hash ^= hash >> 29;
+	hash *= HashPrime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+bool BuildCache::Load(FileID file, CachedFile& result)
+{
+	auto path = GetEntryPath(file);
+	std::string data;
+	{
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream)
+		{
+			m_Misses++;
+			return false;
+		}
+		data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+
+	auto& buffer = m_Context.GetSources().GetBuffer(file);
+	auto& symbols = m_Context.GetSymbols();
+	EntryReader reader(data);
+	CachedFile entry;
+
+	char magic[4];
+	uint32_t format;
+	uint64_t size;
+	uint8_t failed, parsed;
+	bool good = reader.Read(magic) && memcmp(magic, EntryMagic, 4) == 0 &&
+		reader.Read(format) && format == CacheFormat &&
+		reader.Read(size) && size == buffer.GetSize() &&
+		reader.Read(failed) && reader.Read(parsed) &&
+		reader.Read(entry.Name, file, symbols);
+
+	uint32_t imports = 0, diagnostics = 0;
+	good = good && reader.Read(imports) && imports <= data.size();
+	for (uint32_t i = 0; good && i < imports; i++)
+	{
+		auto& import = entry.Imports.emplace_back();
+		good = reader.Read(import.Imported, file, symbols) && reader.Read(import.As, file, symbols);
+	}
+
+	good = good && reader.Read(diagnostics) && diagnostics <= data.size();
+	for (uint32_t i = 0; good && i < diagnostics; i++)
+	{
+		uint8_t severity;
+		FileMarker marker(file);
+		std::string_view message;
+		good = reader.Read(severity) && severity <= static_cast<uint8_t>(DiagnosticSeverity::Fatal) &&
+			reader.Read(marker.Pos) && reader.Read(marker.Length) && reader.Read(message);
+		if (good) { entry.Diagnostics.emplace_back(marker, static_cast<DiagnosticSeverity>(severity), std::string(message)); }
+	}
+
+	std::error_code error;
+	if (!good || !reader.IsDone())
+	{
+		// A damaged entry is as good as none, and is replaced once the file is compiled.
+		fs::remove(path, error);
+		m_Misses++;
+		return false;
+	}
+
+	entry.Failed = failed != 0;
+	entry.Parsed = parsed != 0;
+	result = std::move(entry);
+
+	// Mark the entry as recently used, for Prune().
+	fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+	m_Hits++;
+	return true;
+}
+
+void BuildCache::Store(FileID file, const CachedFile& result)
+{
+	auto& buffer = m_Context.GetSources().GetBuffer(file);
+	auto& symbols = m_Context.GetSymbols();
+
+	EntryWriter writer;
+	for (char c : EntryMagic) { writer.Write(c); }
+	writer.Write(CacheFormat);
+	writer.Write(buffer.GetSize());
+	writer.Write(static_cast<uint8_t>(result.Failed));
+	writer.Write(static_cast<uint8_t>(result.Parsed));
+	writer.Write(result.Name, symbols);
+
+	writer.Write(static_cast<uint32_t>(result.Imports.size()));
+	for (auto& import : result.Imports)
+	{
+		writer.Write(import.Imported, symbols);
+		writer.Write(import.As, symbols);
+	}
+
+	writer.Write(static_cast<uint32_t>(result.Diagnostics.size()));
+	for (auto& diagnostic : result.Diagnostics)
+	{
+		writer.Write(static_cast<uint8_t>(diagnostic.Severity));
+		writer.Write(diagnostic.Marker.Pos);
+		writer.Write(diagnostic.Marker.Length);
+		writer.Write(std::string_view(diagnostic.Message));
+	}
+
+	// Write to a file of our own and move it in place, so that no one ever reads half an entry.
+	auto path = GetEntryPath(file);
+	auto temp = path;
+	temp += "." + std::to_string(m_TempID) + "." + std::to_string(m_NextTemp++) + ".tmp";
+
+	auto& data = writer.GetData();
+	{
+		std::ofstream stream(temp, std::ios::binary);
+		stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+		if (!stream)
+		{
+			std::error_code error;
+			fs::remove(temp, error);
+			return;
+		}
+	}
+
+	std::error_code error;
+	fs::rename(temp, path, error);
+	if (error) { fs::remove(temp, error); }
+	else { m_BytesWritten += data.size(); }
+}
+
+void BuildCache::Prune()
+{
+	struct Entry
+	{
+		fs::path Path;
+		fs::file_time_type Time;
+		uint64_t Size;
+	};
+
+	std::error_code error;
+	std::vector<Entry> entries;
+	uint64_t total = 0;
+	for (auto& file : fs::directory_iterator(m_Directory, error))
+	{
+		if (file.path().extension() != EntryExtension) { continue; }
+
+		std::error_code fileError;
+		Entry entry{ file.path(), file.last_write_time(fileError), file.file_size(fileError) };
+		if (fileError) { continue; }
+
+		total += entry.Size;
+		entries.emplace_back(std::move(entry));
+	}
+	if (total <= m_MaxSize) { return; }
+
+	std::sort(entries.begin(), entries.end(), [](auto& a, auto& b) { return a.Time < b.Time; });
+	for (auto& entry : entries)
+	{
+		if (total <= m_MaxSize) { break; }
+		if (fs::remove(entry.Path, error))
+		{
+			total -= entry.Size;
+			m_Evictions++;
+		}
+	}
+}
+
+fs::path BuildCache::GetEntryPath(FileID file) const
+{
+	auto& buffer = m_Context.GetSources().GetBuffer(file);
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(Hash(buffer.GetData(), buffer.GetSize(), m_Seed)));
+	return m_Directory / (std::string(name) + EntryExtension);
+}
+
+}
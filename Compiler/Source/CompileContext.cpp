@@ -21,4 +21,9 @@ void CompileContext::SetDebugOutput(bool on)
 	m_DebugOutput = on;
 }
 
+void CompileContext::SetFusedLexParse(bool on)
+{
+	m_FusedLexParse = on;
+}
+
 }
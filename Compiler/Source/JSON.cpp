@@ -0,0 +1,38 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "JSON.h"
+
+#include <cstdio>
+
+namespace Wave {
+
+void WriteJSONString(std::ostream& stream, std::string_view string)
+{
+	stream << '"';
+	for (char c : string)
+	{
+		if (c == '"' || c == '\\') { stream << '\\' << c; }
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			char escape[8];
+			snprintf(escape, sizeof(escape), "\\u%04x", c);
+			stream << escape;
+		}
+		else { stream << c; }
+	}
+	stream << '"';
+}
+
+}
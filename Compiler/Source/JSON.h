@@ -0,0 +1,28 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+namespace Wave {
+
+/// Write a string as a quoted JSON string, escaping quotes, backslashes and control characters.
+///
+/// \param stream Stream to write to.
+/// \param string The string.
+void WriteJSONString(std::ostream& stream, std::string_view string);
+
+}
@@ -0,0 +1,29 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "WaveCompiler/Lexer.h"
+
+namespace Wave {
+
+/// Match a word against the keywords, with a perfect hash built at compile time.
+///
+/// \param word The first character of the word.
+/// \param length The length of the word.
+///
+/// \return The type of the keyword, or TokenType::Identifier if the word is not reserved.
+TokenType MatchKeyword(const char* word, uint64_t length);
+
+}
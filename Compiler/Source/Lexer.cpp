@@ -14,16 +14,60 @@
 
 #include "Lexer.h"
 
+#include "Keywords.h"
+#include "MemoryTracker.h"
+#include "ScanKernels.h"
+
+#include <cstring>
+#include <iterator>
 #include <iostream>
-#include <map>
 #include <sstream>
+#include <string_view>
 
 namespace Wave {
 
 Lexer::Lexer(CompileContext& context, const std::filesystem::path& filePath, std::istream& stream)
-	: m_Context(context), m_Marker(filePath), m_Stream(stream)
+	: Lexer(context, context.GetSources().AddFile(std::make_unique<SourceBuffer>(filePath, stream)))
 {}
 
+Lexer::Lexer(CompileContext& context, FileID file)
+	: m_Context(context), m_Source(&context.GetSources().GetBuffer(file)), m_File(file), m_Kernels(&GetScanKernels())
+{
+	m_Begin = m_Source->GetData();
+	m_End = m_Begin + m_Source->GetSize();
+	m_Cur = m_Begin;
+	m_Start = m_Begin;
+
+	// Positions in tokens and markers are 32-bit, so a larger file is not lexed at all.
+	if (m_Source->GetSize() > SourceManager::MaxFileSize)
+	{
+		m_Diagnostics.emplace_back(
+			FileMarker(m_File),
+			DiagnosticSeverity::Fatal,
+			"file is too large, source files can be at most 4 GiB"
+		);
+		m_End = m_Begin;
+	}
+}
+
+const char* GetTokenTypeName(TokenType type)
+{
+	static constexpr const char* Names[] = {
+		"LeftParenthesis", "RightParenthesis", "LeftBrace", "RightBrace", "LeftIndex", "RightIndex",
+		"Comma", "Period", "Minus", "Plus", "Colon", "Semicolon", "Slash", "Star", "Percentage",
+		"MinusEqual", "PlusEqual", "SlashEqual", "StarEqual", "PercentageEqual", "Not", "NotEqual",
+		"Equal", "EqualEqual", "Greater", "GreaterEqual", "Lesser", "LesserEqual", "Identifier",
+		"String", "Integer", "Real", "And", "Or", "If", "Else", "True", "False", "For", "In", "While",
+		"Break", "Continue", "Try", "Catch", "Throw", "Enum", "Tuple", "Class", "Construct",
+		"Abstract", "Static", "Const", "Copy", "Public", "Private", "Protected", "Self", "Super",
+		"Function", "Return", "Variable", "Type", "TypeOf", "IntegerType", "RealType", "CharType",
+		"BoolType", "Module", "Import", "Extern", "As", "Export", "Null"
+	};
+	static_assert(sizeof(Names) / sizeof(Names[0]) == static_cast<size_t>(TokenType::Null) + 1, "Every token type needs a name");
+
+	return Names[static_cast<size_t>(type)];
+}
+
 bool IsAlphabet(char c)
 {
 	return (c >= 'A' && c <= 'Z') ||
@@ -33,8 +77,42 @@ bool IsAlphabet(char c)
 
 void Lexer::Lex()
 {
-	while (m_Stream.good())
 	{
+		ScopedTimer timer(m_Context.GetTimers(), "Lex", m_File);
+		ScopedMemoryPhase phase(MemoryPhase::Lexer);
+		do
+		{
+			m_Tokens.emplace_back(Next());
+		} while (m_Tokens.back().Type != TokenType::Null);
+	}
+
+	if (MemoryTracker::IsEnabled()) { MemoryTracker::AddItems(MemoryPhase::Lexer, m_Tokens.size()); }
+
+	if (m_Context.GetStatistics().IsEnabled())
+	{
+		auto& stats = m_Context.GetStatistics();
+		stats.Max("Lexer", "Peak token vector size", m_Tokens.size());
+		stats.Max("Lexer", "Peak token vector bytes", m_Tokens.capacity() * sizeof(Token));
+	}
+
+	if (m_Context.IsDebugOutputEnabled()) 
+	{
+		std::cout << "LEXER OUTPUT: \n\n";
+		PrettyPrint(); 
+	}
+}
+
+Token Lexer::Next()
+{
+	m_HasToken = false;
+	while (!m_HasToken)
+	{
+		if (m_Finished || m_Cur >= m_End)
+		{
+			EndFile();
+			break;
+		}
+
 		char c = GetChar();
 
 		switch (c)
@@ -83,25 +161,20 @@ void Lexer::Lex()
 		case '/':
 			if (LookAhead('/'))
 			{
-				char c;
-				do { c = GetChar(); } while (c != '\n' && m_Stream.good());
-
-				m_Marker.Pos += m_Marker.Length;
-				m_Marker.Length = 0;
+				m_Cur = m_Kernels->FindLineEnd(m_Cur, m_End);
+				if (m_Cur != m_End) { m_Cur++; }
+				Skip();
 			}
 			else if (LookAhead('*'))
 			{
-				FileMarker marker = m_Marker;
+				FileMarker marker = GetMarker();
 
-				bool star, slash;
-				do 
-				{
-					star = GetChar() == '*';
-					slash = LookAhead('/');
-				} while (!(star && slash) && m_Stream.good());
+				m_Cur = m_Kernels->FindCommentEnd(m_Cur, m_End);
+				bool ended = m_Cur != m_End;
+				if (ended) { m_Cur += 2; }
 
-				// We hit the end of the stream.
-				if (!slash || !star)
+				// We hit the end of the buffer.
+				if (!ended)
 				{
 					m_Diagnostics.emplace_back(
 						marker,
@@ -110,8 +183,7 @@ void Lexer::Lex()
 					);
 				}
 
-				m_Marker.Pos += m_Marker.Length;
-				m_Marker.Length = 0;
+				Skip();
 			}
 			else if (LookAhead('=')) { PushToken(TokenType::SlashEqual); }
 			else { PushToken(TokenType::Slash); }
@@ -128,59 +200,85 @@ void Lexer::Lex()
 		case '6':
 		case '7':
 		case '8':
-		case '9': NumberLiteral(c); break;
+		case '9': NumberLiteral(); break;
 		// Whitespace
 		case ' ':
 		case '\r':
 		case '\t':
 		case '\n':
-			m_Marker.Pos += m_Marker.Length;
-			m_Marker.Length = 0;
+			m_Cur = m_Kernels->SkipWhitespace(m_Cur, m_End);
+			Skip();
 			break;
+		// The end of the buffer is checked above, so this is a stray null byte in the file.
+		// A run of them is reported once, as binary files are full of them.
 		case '\0':
-			PushToken(TokenType::Null);
-			goto End;
+			while (m_Cur != m_End && *m_Cur == '\0') { m_Cur++; }
+			m_Diagnostics.emplace_back(
+				GetMarker(),
+				DiagnosticSeverity::Error,
+				"unexpected null character"
+			);
+			Skip();
+			break;
 		default:
-			if (IsAlphabet(c)) { Identifier(c); }
+			if (IsAlphabet(c)) { Identifier(); }
 			else
 			{
 				std::ostringstream ss;
 				ss << "Unexpected character '" << c << "'";
 
 				m_Diagnostics.emplace_back(
-					m_Marker,
+					GetMarker(),
 					DiagnosticSeverity::Error,
 					ss.str()
 				);
-				m_Marker.Pos += m_Marker.Length;
-				m_Marker.Length = 0;
+				Skip();
 			}
 		}
 	}
 
+	return m_Token;
+}
+
+void Lexer::EndFile()
+{
+	bool ended = m_Finished;
+	m_Finished = true;
 	PushToken(TokenType::Null);
 
-	End:
+	// Whether the tokens went to the token list or a stream, this is where the file ends.
+	if (!ended && m_Context.GetStatistics().IsEnabled()) { RecordStatistics(); }
+}
 
-	if (m_Context.IsDebugOutputEnabled()) 
+void Lexer::RecordStatistics()
+{
+	auto& stats = m_Context.GetStatistics();
+	uint64_t tokens = 0;
+	for (size_t i = 0; i < std::size(m_TypeCounts); i++)
 	{
-		std::cout << "LEXER OUTPUT: \n\n";
-		PrettyPrint(); 
+		if (m_TypeCounts[i]) { stats.Add("Tokens", GetTokenTypeName(static_cast<TokenType>(i)), m_TypeCounts[i]); }
+		tokens += m_TypeCounts[i];
 	}
+
+	stats.Add("Lexer", "Files lexed");
+	stats.Add("Lexer", "Bytes read", m_Source->GetSize());
+	stats.Add("Lexer", "Tokens", tokens);
 }
 
 void Lexer::PrettyPrint()
 {
-	for (auto& token : m_Tokens)
-	{
-		std::cout << "Pos: " << token.Marker.Pos << ", Length: " << token.Marker.Length << "\n";
-		PrettyPrint(token);
+	for (auto& token : m_Tokens) { Print(token); }
+}
 
-		std::cout << "\n\n";
-	}
+void Lexer::Print(const Token& token) const
+{
+	std::cout << "Pos: " << token.Pos << ", Length: " << token.Length << "\n";
+	PrettyPrint(token);
+
+	std::cout << "\n\n";
 }
 
-void Lexer::PrettyPrint(const Token& token)
+void Lexer::PrettyPrint(const Token& token) const
 {
 	switch (token.Type)
 	{
@@ -212,10 +310,10 @@ void Lexer::PrettyPrint(const Token& token)
 	case TokenType::GreaterEqual: std::cout << ">="; break;
 	case TokenType::Lesser: std::cout << "<"; break;
 	case TokenType::LesserEqual: std::cout << "<="; break;
-	case TokenType::Identifier: std::visit([](auto& val) { std::cout << val; }, token.Value); break;
-	case TokenType::String: std::visit([](auto& val) { std::cout << val; }, token.Value); break;
-	case TokenType::Integer: std::visit([](auto& val) { std::cout << val; }, token.Value); break;
-	case TokenType::Real: std::visit([](auto& val) { std::cout << val; }, token.Value); break;
+	case TokenType::Identifier: std::cout << m_Context.GetSymbols().GetString(token.Value); break;
+	case TokenType::String: std::cout << m_Context.GetSymbols().GetString(token.Value); break;
+	case TokenType::Integer: std::cout << m_Literals.GetInteger(token); break;
+	case TokenType::Real: std::cout << m_Literals.GetReal(token); break;
 	case TokenType::And: std::cout << "and"; break;
 	case TokenType::Or: std::cout << "or"; break;
 	case TokenType::If: std::cout << "if"; break;
@@ -273,51 +371,72 @@ const std::vector<Wave::Token>& Lexer::GetTokens() const
 
 char Lexer::GetChar()
 {
-	char c;
-	m_Stream.get(c);
-
-	m_Marker.Length++;
-	
-	return c;
+	if (m_Cur == m_End) { return '\0'; }
+	return *m_Cur++;
 }
 
 bool Lexer::LookAhead(char c)
 {
-	char next;
-	m_Stream.get(next);
-
-	if (next == c)
+	if (m_Cur != m_End && *m_Cur == c)
 	{
-		m_Marker.Length++;
+		m_Cur++;
 		return true;
 	}
-	else
-	{
-		m_Stream.seekg(-1, std::ios_base::cur);
-		return false;
-	}
+
+	return false;
 }
 
 char Lexer::Peek()
 {
-	char next;
-	m_Stream.get(next);
-	m_Stream.seekg(-1, std::ios_base::cur);
-	return next;
+	return m_Cur != m_End ? *m_Cur : '\0';
+}
+
+FileMarker Lexer::GetMarker() const
+{
+	return FileMarker(
+		m_File,
+		static_cast<uint32_t>(m_Start - m_Begin),
+		static_cast<uint32_t>(m_Cur - m_Start)
+	);
+}
+
+void Lexer::Skip()
+{
+	m_Start = m_Cur;
 }
 
 void Lexer::PushToken(TokenType type)
 {
-	m_Tokens.emplace_back(m_Marker, type);
-	m_Marker.Pos += m_Marker.Length;
-	m_Marker.Length = 0;
+	m_Token.Pos = static_cast<uint32_t>(m_Start - m_Begin);
+	m_Token.Length = static_cast<uint32_t>(m_Cur - m_Start);
+	m_Token.Value = 0;
+	m_Token.File = m_File;
+	m_Token.Type = type;
+	m_HasToken = true;
+	m_TypeCounts[static_cast<size_t>(type)]++;
+
+	m_Start = m_Cur;
+}
+
+void Lexer::PushToken(TokenType type, std::string_view value)
+{
+	auto symbol = m_Context.GetSymbols().Intern(value);
+	PushToken(type);
+	m_Token.Value = symbol;
 }
 
-void Lexer::PushToken(TokenType type, const std::variant<std::string, int64_t, double>& value)
+void Lexer::PushToken(int64_t value)
 {
-	m_Tokens.emplace_back(m_Marker, type, value);
-	m_Marker.Pos += m_Marker.Length;
-	m_Marker.Length = 0;
+	m_Literals.Integers.emplace_back(value);
+	PushToken(TokenType::Integer);
+	m_Token.Value = static_cast<uint32_t>(m_Literals.Integers.size() - 1);
+}
+
+void Lexer::PushToken(double value)
+{
+	m_Literals.Reals.emplace_back(value);
+	PushToken(TokenType::Real);
+	m_Token.Value = static_cast<uint32_t>(m_Literals.Reals.size() - 1);
 }
 
 void Lexer::StringLiteral()
@@ -327,13 +446,14 @@ void Lexer::StringLiteral()
 
 	do
 	{
-		if (LookAhead('\n'))
+		if (LookAhead('\n') || m_Cur == m_End)
 		{
 			m_Diagnostics.emplace_back(
-				m_Marker,
+				GetMarker(),
 				DiagnosticSeverity::Error,
 				"string not terminated"
 			);
+			Skip();
 			return;
 		}
 
@@ -353,16 +473,6 @@ void Lexer::StringLiteral()
 		}
 	} while (!quote || (quote && slash));
 
-	if (!m_Stream.good())
-	{
-		m_Diagnostics.emplace_back(
-			m_Marker,
-			DiagnosticSeverity::Error,
-			"string not terminated"
-		);
-		return;
-	}
-
 	std::string value;
 
 	// Unescaping other stuff now
@@ -378,7 +488,7 @@ void Lexer::StringLiteral()
 			case '\\': value += '\\'; break;
 			default:
 				std::ostringstream ss;
-				FileMarker marker = m_Marker;
+				FileMarker marker = GetMarker();
 				marker.Pos += i + 2;
 				marker.Length = 2;
 				ss << "unrecognized escape sequence '\\" << source[i + 1] << '\'';
@@ -399,15 +509,11 @@ void Lexer::StringLiteral()
 	PushToken(TokenType::String, value);
 }
 
-void Lexer::NumberLiteral(char c)
+void Lexer::NumberLiteral()
 {
-	std::string literal;
-	literal += c;
-
 	char n = Peek();
 	while (n >= '0' && n <= '9')
 	{
-		literal += n;
 		GetChar();
 		n = Peek();
 	}
@@ -418,33 +524,36 @@ void Lexer::NumberLiteral(char c)
 		GetChar();
 		isDecimal = true;
 
-		literal += n;
 		n = Peek();
 		while (n >= '0' && n <= '9')
 		{
-			literal += n;
 			GetChar();
 			n = Peek();
 		}
 	}
 
+	std::string literal(m_Start, m_Cur);
+
 	if (isDecimal)
 	{
-		PushToken(TokenType::Real, std::stod(literal));
+		PushToken(std::stod(literal));
 	}
 	else
 	{
-		PushToken(TokenType::Integer, std::stoll(literal));
+		PushToken(static_cast<int64_t>(std::stoll(literal)));
 	}
 }
 
-bool IsAlphanumeric(char c)
+namespace {
+
+/// A reserved word.
+struct Keyword
 {
-	return IsAlphabet(c) ||
-		(c >= '0' && c <= '9');
-}
+	std::string_view Name;
+	TokenType Type = TokenType::Identifier;
+};
 
-static std::map<std::string, TokenType> s_Reserved =
+constexpr Keyword Keywords[] =
 {
 	{ "and", TokenType::And },
 	{ "or", TokenType::Or },
@@ -489,26 +598,76 @@ static std::map<std::string, TokenType> s_Reserved =
 	{ "export", TokenType::Export }
 };
 
-void Lexer::Identifier(char c)
+constexpr uint64_t KeywordSlots = 128;
+
+/// Hash of a word, which is perfect over the keywords.
+/// Words must be at least two characters long.
+constexpr uint64_t HashKeyword(const char* word, uint64_t length)
 {
-	std::string literal;
-	literal += c;
+	auto first = static_cast<unsigned char>(word[0]);
+	auto second = static_cast<unsigned char>(word[1]);
+	auto last = static_cast<unsigned char>(word[length - 1]);
 
-	char n = Peek();
-	while (IsAlphanumeric(n))
+	return (first * 7 + second + last * 36 + length) % KeywordSlots;
+}
+
+/// Keywords laid out by their hash.
+struct KeywordTable
+{
+	Keyword Slots[KeywordSlots] = {};
+	uint64_t MinLength = ~0ull;
+	uint64_t MaxLength = 0;
+	bool IsPerfect = true;
+};
+
+constexpr KeywordTable BuildKeywordTable()
+{
+	KeywordTable table;
+	for (auto& keyword : Keywords)
 	{
-		literal += n;
-		GetChar();
-		n = Peek();
+		auto& slot = table.Slots[HashKeyword(keyword.Name.data(), keyword.Name.size())];
+		if (!slot.Name.empty()) { table.IsPerfect = false; }
+		slot = keyword;
+
+		if (keyword.Name.size() < table.MinLength) { table.MinLength = keyword.Name.size(); }
+		if (keyword.Name.size() > table.MaxLength) { table.MaxLength = keyword.Name.size(); }
+	}
+
+	return table;
+}
+
+constexpr KeywordTable s_Keywords = BuildKeywordTable();
+
+static_assert(s_Keywords.IsPerfect, "keyword hash has collisions, change HashKeyword");
+static_assert(s_Keywords.MinLength >= 2, "HashKeyword needs at least two characters");
+
+}
+
+TokenType MatchKeyword(const char* word, uint64_t length)
+{
+	if (length < s_Keywords.MinLength || length > s_Keywords.MaxLength) { return TokenType::Identifier; }
+
+	auto& slot = s_Keywords.Slots[HashKeyword(word, length)];
+	if (slot.Name.size() == length && memcmp(slot.Name.data(), word, length) == 0)
+	{
+		return slot.Type;
 	}
 
-	if (s_Reserved.count(literal))
+	return TokenType::Identifier;
+}
+
+void Lexer::Identifier()
+{
+	m_Cur = m_Kernels->SkipIdentifier(m_Cur, m_End);
+
+	auto type = MatchKeyword(m_Start, m_Cur - m_Start);
+	if (type != TokenType::Identifier)
 	{
-		PushToken(s_Reserved[literal]);
+		PushToken(type);
 	}
 	else
 	{
-		PushToken(TokenType::Identifier, literal);
+		PushToken(TokenType::Identifier, std::string_view(m_Start, m_Cur - m_Start));
 	}
 }
 
@@ -0,0 +1,150 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "MemoryTracker.h"
+
+#include <cstdio>
+#include <iterator>
+#include <string>
+
+namespace Wave {
+
+namespace {
+
+/// Counters of one phase. Hooks run before static constructors, so all of these are zero-initialized.
+struct PhaseCounters
+{
+	std::atomic<uint64_t> Allocations;
+	std::atomic<uint64_t> Bytes;
+	std::atomic<uint64_t> Frees;
+	std::atomic<uint64_t> FreedBytes;
+	std::atomic<int64_t> Peak;
+	std::atomic<uint64_t> Items;
+};
+
+constexpr const char* PhaseNames[] = { "Other", "Lexer", "Parser", "Diagnostics" };
+static_assert(std::size(PhaseNames) == static_cast<size_t>(MemoryPhase::Count), "missing phase name");
+
+PhaseCounters s_Phases[static_cast<size_t>(MemoryPhase::Count)];
+std::atomic<int64_t> s_Live;
+std::atomic<int64_t> s_Peak;
+
+void RaiseTo(std::atomic<int64_t>& peak, int64_t value)
+{
+	int64_t current = peak.load(std::memory_order_relaxed);
+	while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+std::string FormatBytes(double bytes)
+{
+	char text[32];
+	if (bytes < 0) { snprintf(text, sizeof(text), "-%s", FormatBytes(-bytes).c_str()); }
+	else if (bytes < 1024.0) { snprintf(text, sizeof(text), "%.0f B", bytes); }
+	else if (bytes < 1024.0 * 1024.0) { snprintf(text, sizeof(text), "%.1f KiB", bytes / 1024.0); }
+	else { snprintf(text, sizeof(text), "%.1f MiB", bytes / (1024.0 * 1024.0)); }
+	return text;
+}
+
+}
+
+std::atomic<bool> MemoryTracker::s_Enabled;
+thread_local MemoryPhase MemoryTracker::s_Phase = MemoryPhase::Other;
+
+void MemoryTracker::Allocated(uint64_t size)
+{
+	auto& phase = s_Phases[static_cast<size_t>(s_Phase)];
+	phase.Allocations.fetch_add(1, std::memory_order_relaxed);
+	phase.Bytes.fetch_add(size, std::memory_order_relaxed);
+
+	int64_t live = s_Live.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+	RaiseTo(phase.Peak, live);
+	RaiseTo(s_Peak, live);
+}
+
+void MemoryTracker::Freed(uint64_t size)
+{
+	auto& phase = s_Phases[static_cast<size_t>(s_Phase)];
+	phase.Frees.fetch_add(1, std::memory_order_relaxed);
+	phase.FreedBytes.fetch_add(size, std::memory_order_relaxed);
+	s_Live.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+
+void MemoryTracker::AddItems(MemoryPhase phase, uint64_t count)
+{
+	s_Phases[static_cast<size_t>(phase)].Items.fetch_add(count, std::memory_order_relaxed);
+}
+
+MemoryPhaseStats MemoryTracker::GetStats(MemoryPhase phase)
+{
+	auto& counters = s_Phases[static_cast<size_t>(phase)];
+
+	MemoryPhaseStats stats;
+	stats.Allocations = counters.Allocations.load(std::memory_order_relaxed);
+	stats.Bytes = counters.Bytes.load(std::memory_order_relaxed);
+	stats.Frees = counters.Frees.load(std::memory_order_relaxed);
+	stats.FreedBytes = counters.FreedBytes.load(std::memory_order_relaxed);
+	stats.Items = counters.Items.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void MemoryTracker::Print(std::ostream& stream)
+{
+	stream << "===" << std::string(73, '-') << "===\n";
+	stream << "                          Wave compiler memory report\n";
+	stream << "===" << std::string(73, '-') << "===\n";
+
+	uint64_t allocations = 0;
+	for (auto& phase : s_Phases) { allocations += phase.Allocations.load(std::memory_order_relaxed); }
+	if (allocations == 0)
+	{
+		stream << "  No allocations were tracked, the allocation hooks are not installed.\n\n";
+		return;
+	}
+
+	char row[160];
+	snprintf(row, sizeof(row), "  Peak live heap: %s, live at exit: %s\n\n",
+		FormatBytes(static_cast<double>(s_Peak.load(std::memory_order_relaxed))).c_str(),
+		FormatBytes(static_cast<double>(s_Live.load(std::memory_order_relaxed))).c_str());
+	stream << row;
+
+	stream << "  Items are tokens for the lexer, AST nodes for the parser, and diagnostics for the reporter.\n\n";
+	snprintf(row, sizeof(row), "  %12s  %12s  %12s  %12s  %10s  %11s  %s\n",
+		"Allocations", "Allocated", "Retained", "Peak live", "Items", "Allocs/item", "Phase");
+	stream << row;
+
+	for (size_t i = 0; i < std::size(s_Phases); i++)
+	{
+		auto& phase = s_Phases[i];
+		uint64_t count = phase.Allocations.load(std::memory_order_relaxed);
+		uint64_t bytes = phase.Bytes.load(std::memory_order_relaxed);
+		uint64_t freed = phase.FreedBytes.load(std::memory_order_relaxed);
+		uint64_t items = phase.Items.load(std::memory_order_relaxed);
+
+		char perItem[32] = "-";
+		if (items) { snprintf(perItem, sizeof(perItem), "%.3g", static_cast<double>(count) / static_cast<double>(items)); }
+
+		snprintf(row, sizeof(row), "  %12llu  %12s  %12s  %12s  %10llu  %11s  %s\n",
+			static_cast<unsigned long long>(count),
+			FormatBytes(static_cast<double>(bytes)).c_str(),
+			FormatBytes(static_cast<double>(bytes) - static_cast<double>(freed)).c_str(),
+			FormatBytes(static_cast<double>(phase.Peak.load(std::memory_order_relaxed))).c_str(),
+			static_cast<unsigned long long>(items),
+			perItem,
+			PhaseNames[i]);
+		stream << row;
+	}
+	stream << "\n";
+}
+
+}
@@ -0,0 +1,324 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ModuleGraph.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace Wave {
+
+namespace {
+
+constexpr uint32_t Unvisited = ~0u;
+
+std::vector<Symbol> GetSymbols(const Identifier& identifier)
+{
+	std::vector<Symbol> symbols;
+	symbols.reserve(identifier.Path.size());
+	for (auto& token : identifier.Path) { symbols.push_back(static_cast<Symbol>(token.Value)); }
+	return symbols;
+}
+
+bool IsNamed(const Identifier& identifier)
+{
+	if (identifier.Path.empty()) { return false; }
+	for (auto& token : identifier.Path)
+	{
+		// Parts that failed to parse have no symbol.
+		if (static_cast<Symbol>(token.Value) == InvalidSymbol) { return false; }
+	}
+	return true;
+}
+
+FileMarker GetMarker(const Identifier& identifier)
+{
+	auto& first = identifier.Path.front();
+	auto& last = identifier.Path.back();
+	return FileMarker(first.File, first.Pos, last.Pos + last.Length - first.Pos);
+}
+
+}
+
+ModuleGraph::ModuleGraph(CompileContext& context)
+	: m_Context(context)
+{}
+
+uint32_t ModuleGraph::AddModule(const Identifier& name, const std::vector<ModuleImport>& imports)
+{
+	uint32_t node = static_cast<uint32_t>(m_Nodes.size());
+	auto& added = m_Nodes.emplace_back();
+	added.Name = name;
+	added.Declared = imports;
+
+	// A module without a name cannot be imported, but can still import others.
+	if (!IsNamed(name)) { return node; }
+
+	auto [it, inserted] = m_Names.emplace(GetSymbols(name), node);
+	if (!inserted)
+	{
+		m_Diagnostics.emplace_back(
+			GetMarker(name),
+			DiagnosticSeverity::Error,
+			"module '" + GetName(node) + "' is defined more than once"
+		);
+		m_Diagnostics.emplace_back(
+			GetMarker(m_Nodes[it->second].Name),
+			DiagnosticSeverity::Note,
+			"first defined here"
+		);
+	}
+
+	return node;
+}
+
+void ModuleGraph::Link()
+{
+	for (auto& node : m_Nodes)
+	{
+		auto& imports = node.Declared;
+		for (uint32_t i = 0; i < imports.size(); i++)
+		{
+			if (!IsNamed(imports[i].Imported)) { continue; }
+
+			auto it = m_Names.find(GetSymbols(imports[i].Imported));
+			if (it == m_Names.end()) { continue; }
+			if (std::find(node.Imports.begin(), node.Imports.end(), it->second) != node.Imports.end()) { continue; }
+
+			node.Imports.push_back(it->second);
+			node.ImportSites.push_back(i);
+			m_EdgeCount++;
+		}
+	}
+
+	FindComponents();
+
+	std::vector<uint32_t> componentSize(m_Nodes.size(), 0);
+	for (auto& node : m_Nodes) { componentSize[node.Component]++; }
+
+	for (uint32_t i = 0; i < m_Nodes.size(); i++)
+	{
+		auto& node = m_Nodes[i];
+		node.InCycle = componentSize[node.Component] > 1;
+
+		for (uint32_t j = 0; j < node.Imports.size(); j++)
+		{
+			uint32_t imported = node.Imports[j];
+			if (m_Nodes[imported].Component == node.Component)
+			{
+				node.InCycle = true;
+				continue;
+			}
+
+			node.Dependencies.push_back(imported);
+			node.DependencySites.push_back(node.ImportSites[j]);
+			m_Nodes[imported].Dependents.push_back(i);
+		}
+	}
+
+	// The order has dependencies first, so a node's level is final once it is reached.
+	std::vector<uint32_t> width;
+	for (uint32_t node : m_Order)
+	{
+		auto& n = m_Nodes[node];
+		for (uint32_t dependency : n.Dependencies) { n.Level = std::max(n.Level, m_Nodes[dependency].Level + 1); }
+
+		if (n.Level >= width.size()) { width.resize(n.Level + 1, 0); }
+		m_MaxWidth = std::max(m_MaxWidth, ++width[n.Level]);
+	}
+
+	// Report each cycle once, from the first module of it that was added.
+	std::vector<bool> reported(m_Nodes.size(), false);
+	for (uint32_t i = 0; i < m_Nodes.size(); i++)
+	{
+		auto& node = m_Nodes[i];
+		if (!node.InCycle || reported[node.Component]) { continue; }
+
+		reported[node.Component] = true;
+		m_CycleCount++;
+		ReportCycle(i);
+	}
+}
+
+const ModuleImport& ModuleGraph::GetImport(uint32_t node, uint32_t index) const
+{
+	auto& n = m_Nodes[node];
+	return n.Declared[n.DependencySites[index]];
+}
+
+std::vector<uint32_t> ModuleGraph::GetCriticalPath() const
+{
+	uint32_t last = Unvisited;
+	for (uint32_t node = 0; node < m_Nodes.size(); node++)
+	{
+		if (last == Unvisited || m_Nodes[node].Level > m_Nodes[last].Level) { last = node; }
+	}
+
+	// Every node above level 0 has a dependency one level down, which is the next link of the chain.
+	std::vector<uint32_t> path;
+	for (uint32_t node = last; node != Unvisited;)
+	{
+		path.push_back(node);
+
+		uint32_t next = Unvisited;
+		for (uint32_t dependency : m_Nodes[node].Dependencies)
+		{
+			if (m_Nodes[dependency].Level + 1 == m_Nodes[node].Level) { next = dependency; break; }
+		}
+		node = next;
+	}
+
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+std::string ModuleGraph::GetName(uint32_t node) const
+{
+	std::string name;
+	for (auto& token : m_Nodes[node].Name.Path)
+	{
+		if (!name.empty()) { name += '.'; }
+		name += m_Context.GetSymbols().GetString(static_cast<Symbol>(token.Value));
+	}
+	return name;
+}
+
+void ModuleGraph::FindComponents()
+{
+	// Tarjan's algorithm, with an explicit stack so long import chains cannot overflow.
+	// A component is complete only once every component it imports is,
+	// so components come out dependencies first.
+	struct Frame
+	{
+		uint32_t Node;
+		uint32_t Edge;
+	};
+
+	uint32_t count = static_cast<uint32_t>(m_Nodes.size());
+	std::vector<uint32_t> index(count, Unvisited);
+	std::vector<uint32_t> low(count, 0);
+	std::vector<bool> onStack(count, false);
+	std::vector<uint32_t> stack;
+	std::vector<Frame> frames;
+	uint32_t next = 0;
+	uint32_t component = 0;
+
+	m_Order.clear();
+	m_Order.reserve(count);
+
+	for (uint32_t root = 0; root < count; root++)
+	{
+		if (index[root] != Unvisited) { continue; }
+
+		index[root] = low[root] = next++;
+		stack.push_back(root);
+		onStack[root] = true;
+		frames.push_back({ root, 0 });
+
+		while (!frames.empty())
+		{
+			auto& frame = frames.back();
+			uint32_t node = frame.Node;
+			auto& imports = m_Nodes[node].Imports;
+
+			if (frame.Edge < imports.size())
+			{
+				uint32_t imported = imports[frame.Edge++];
+				if (index[imported] == Unvisited)
+				{
+					index[imported] = low[imported] = next++;
+					stack.push_back(imported);
+					onStack[imported] = true;
+					frames.push_back({ imported, 0 });
+				}
+				else if (onStack[imported])
+				{
+					low[node] = std::min(low[node], index[imported]);
+				}
+				continue;
+			}
+
+			frames.pop_back();
+			if (!frames.empty())
+			{
+				uint32_t parent = frames.back().Node;
+				low[parent] = std::min(low[parent], low[node]);
+			}
+
+			if (low[node] != index[node]) { continue; }
+
+			// Root of a component, which is everything above it on the stack.
+			size_t begin = m_Order.size();
+			uint32_t member;
+			do
+			{
+				member = stack.back();
+				stack.pop_back();
+				onStack[member] = false;
+				m_Nodes[member].Component = component;
+				m_Order.push_back(member);
+			} while (member != node);
+
+			std::sort(m_Order.begin() + begin, m_Order.end());
+			component++;
+		}
+	}
+}
+
+void ModuleGraph::ReportCycle(uint32_t start)
+{
+	// Shortest way back to the start, through modules in the same cycle.
+	uint32_t component = m_Nodes[start].Component;
+	std::vector<uint32_t> previous(m_Nodes.size(), Unvisited);
+	std::deque<uint32_t> queue = { start };
+	uint32_t end = Unvisited;
+
+	while (!queue.empty() && end == Unvisited)
+	{
+		uint32_t node = queue.front();
+		queue.pop_front();
+
+		for (uint32_t imported : m_Nodes[node].Imports)
+		{
+			if (m_Nodes[imported].Component != component) { continue; }
+			if (imported == start)
+			{
+				end = node;
+				break;
+			}
+			if (previous[imported] != Unvisited) { continue; }
+
+			previous[imported] = node;
+			queue.push_back(imported);
+		}
+	}
+
+	std::vector<uint32_t> path = { start };
+	for (uint32_t node = end; node != start; node = previous[node]) { path.push_back(node); }
+	std::reverse(path.begin() + 1, path.end());
+
+	std::string message = "import cycle: ";
+	for (uint32_t node : path) { message += GetName(node) + " -> "; }
+	message += GetName(start);
+
+	// Point at the import which starts the cycle.
+	uint32_t second = path.size() > 1 ? path[1] : start;
+	auto& node = m_Nodes[start];
+	auto site = std::find(node.Imports.begin(), node.Imports.end(), second) - node.Imports.begin();
+	auto& import = node.Declared[node.ImportSites[site]];
+
+	m_Diagnostics.emplace_back(GetMarker(import.Imported), DiagnosticSeverity::Error, message);
+}
+
+}
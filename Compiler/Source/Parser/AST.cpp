@@ -14,196 +14,158 @@
 
 #include "Parser/AST.h"
 
-namespace Wave {
-
-void FuncType::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
-
-void ClassType::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
-
-void Abstract::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
-
-void ClassDefinition::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
-
-void Block::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
-
-void Constructor::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
+#include "Parser/StaticVisitor.h"
 
-void Getter::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
-
-void Setter::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
-
-void Break::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
-
-void Continue::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
+namespace Wave {
 
-void Return::Accept(ASTVisitor& visitor, std::any& context)
+const char* GetNodeKindName(NodeKind kind)
 {
-	visitor.Visit(*this, context);
-}
+	static constexpr const char* Names[] = {
+		"Abstract", "ArrayIndex", "ArrayType", "Assignment", "Binary", "Block", "Break", "Call",
+		"ClassDefinition", "ClassType", "ConditionFor", "Constructor", "Continue", "EnumDefinition",
+		"ExpressionStatement", "Function", "FunctionDefinition", "FuncType", "Getter", "Group", "If",
+		"InitializerList", "Literal", "Logical", "Method", "OperatorOverload", "RangeFor", "Return",
+		"Setter", "SimpleType", "Throw", "Try", "TupleType", "TypeOf", "Unary", "VarAccess", "VarDefinition", "While"
+	};
+	static_assert(sizeof(Names) / sizeof(Names[0]) == static_cast<size_t>(NodeKind::Count), "Every node kind needs a name");
 
-void VarDefinition::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
+	return Names[static_cast<size_t>(kind)];
 }
 
-void ExpressionStatement::Accept(ASTVisitor& visitor, std::any& context)
+bool Identifier::operator==(const Identifier& other) const
 {
-	visitor.Visit(*this, context);
-}
+	if (Path.size() != other.Path.size()) { return false; }
 
-void While::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
+	for (uint64_t i = 0; i < Path.size(); i++)
+	{
+		if (Path[i].Value != other.Path[i].Value) { return false; }
+	}
 
-void ConditionFor::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
+	return true;
 }
 
-void RangeFor::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
+namespace {
 
-void If::Accept(ASTVisitor& visitor, std::any& context)
+/// Mix a value into a hash.
+uint64_t Combine(uint64_t hash, uint64_t value)
 {
-	visitor.Visit(*this, context);
+	return hash ^ (value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2));
 }
 
-void Function::Accept(ASTVisitor& visitor, std::any& context)
+uint64_t HashTypes(uint64_t hash, const SmallVector<Type*, 4>& types)
 {
-	visitor.Visit(*this, context);
+	for (auto type : types) { hash = Combine(hash, reinterpret_cast<uintptr_t>(type)); }
+	return hash;
 }
 
-void FunctionDefinition::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
 }
 
-void Method::Accept(ASTVisitor& visitor, std::any& context)
+template<typename T, typename Equal, typename Fill>
+T* TypeContext::Intern(uint64_t hash, const Token& tok, const Equal& equal, const Fill& fill)
 {
-	visitor.Visit(*this, context);
-}
+	hash = Combine(hash, static_cast<uint64_t>(T::Kind));
 
-void Assignment::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
+	auto [begin, end] = m_Types.equal_range(hash);
+	for (auto it = begin; it != end; ++it)
+	{
+		if (it->second->Kind == T::Kind && equal(static_cast<const T&>(*it->second))) { return static_cast<T*>(it->second); }
+	}
 
-void Logical::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
+	auto type = m_Arena.Make<T>();
+	type->Tok = tok;
+	fill(*type);
+	m_Types.emplace(hash, type);
+	m_TypeCount++;
+	return type;
 }
 
-void Binary::Accept(ASTVisitor& visitor, std::any& context)
+SimpleType* TypeContext::GetSimple(SimpleType::TypeType type, const Token& tok)
 {
-	visitor.Visit(*this, context);
-}
+	auto& simple = m_Simple[static_cast<size_t>(type)];
+	if (!simple)
+	{
+		simple = m_Arena.Make<SimpleType>();
+		simple->Tok = tok;
+		simple->T = type;
+		m_TypeCount++;
+	}
 
-void Unary::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
+	return simple;
 }
 
-void Call::Accept(ASTVisitor& visitor, std::any& context)
+ArrayType* TypeContext::GetArray(Type* holdType, const Token& tok)
 {
-	visitor.Visit(*this, context);
+	return Intern<ArrayType>(
+		reinterpret_cast<uintptr_t>(holdType), tok,
+		[&](const ArrayType& array) { return !array.Size && array.HoldType == holdType; },
+		[&](ArrayType& array) { array.HoldType = holdType; }
+	);
 }
 
-void Literal::Accept(ASTVisitor& visitor, std::any& context)
+TupleType* TypeContext::GetTuple(const SmallVector<Type*, 4>& types, const Token& tok)
 {
-	visitor.Visit(*this, context);
+	return Intern<TupleType>(
+		HashTypes(0, types), tok,
+		[&](const TupleType& tuple) { return tuple.Types == types; },
+		[&](TupleType& tuple) { tuple.Types = types; }
+	);
 }
 
-void Group::Accept(ASTVisitor& visitor, std::any& context)
+FuncType* TypeContext::GetFunc(const SmallVector<Type*, 4>& paramTypes, Type* returnType, const Token& tok)
 {
-	visitor.Visit(*this, context);
+	return Intern<FuncType>(
+		HashTypes(reinterpret_cast<uintptr_t>(returnType), paramTypes), tok,
+		[&](const FuncType& func) { return func.ReturnType == returnType && func.ParamTypes == paramTypes; },
+		[&](FuncType& func)
+		{
+			func.ReturnType = returnType;
+			func.ParamTypes = paramTypes;
+		}
+	);
 }
 
-void VarAccess::Accept(ASTVisitor& visitor, std::any& context)
+ClassType* TypeContext::GetClass(const Identifier& ident, const Token& tok)
 {
-	visitor.Visit(*this, context);
-}
+	uint64_t hash = 0;
+	for (auto& part : ident.Path) { hash = Combine(hash, part.Value); }
 
-void Try::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
+	return Intern<ClassType>(
+		hash, tok,
+		[&](const ClassType& type) { return type.Ident == ident; },
+		[&](ClassType& type) { type.Ident = ident; }
+	);
 }
 
-void TypeOf::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
-
-void Throw::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
+namespace {
 
-void ArrayType::Accept(ASTVisitor& visitor, std::any& context)
+/// Calls an ASTVisitor from the static dispatch, so both visit nodes the same way.
+class VisitorAdapter : public StaticVisitor<VisitorAdapter>
 {
-	visitor.Visit(*this, context);
-}
+public:
+	VisitorAdapter(ASTVisitor& visitor) : m_Visitor(visitor) {}
 
-void ArrayIndex::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
+	template<typename T>
+	void Visit(T& node, std::any& context) { m_Visitor.Visit(node, context); }
 
-void EnumDefinition::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
-}
+private:
+	ASTVisitor& m_Visitor;
+};
 
-void InitializerList::Accept(ASTVisitor& visitor, std::any& context)
-{
-	visitor.Visit(*this, context);
 }
 
-void TupleType::Accept(ASTVisitor& visitor, std::any& context)
+void Statement::Accept(ASTVisitor& visitor, std::any& context)
 {
-	visitor.Visit(*this, context);
+	VisitorAdapter(visitor).Dispatch(*this, context);
 }
 
-void SimpleType::Accept(ASTVisitor& visitor, std::any& context)
+void Expression::Accept(ASTVisitor& visitor, std::any& context)
 {
-	visitor.Visit(*this, context);
+	VisitorAdapter(visitor).Dispatch(*this, context);
 }
 
-void OperatorOverload::Accept(ASTVisitor& visitor, std::any& context)
+void Type::Accept(ASTVisitor& visitor, std::any& context)
 {
-	visitor.Visit(*this, context);
+	VisitorAdapter(visitor).Dispatch(*this, context);
 }
 
 }
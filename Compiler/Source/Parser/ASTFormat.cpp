@@ -0,0 +1,1267 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Parser/ASTFormat.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+#include "Parser/StaticVisitor.h"
+
+namespace Wave {
+
+using ASTFormat::Header;
+using ASTFormat::List;
+using ASTFormat::Ref;
+
+namespace {
+
+bool IsSymbol(TokenType type)
+{
+	return type == TokenType::Identifier || type == TokenType::String;
+}
+
+/// Writes the records of a module. Nodes are written from a worklist instead of recursively,
+/// as left-associative chains can be very deep: a node's record is written first,
+/// and the Refs to its children are patched in once their records are written.
+class ModuleWriter : public StaticVisitor<ModuleWriter>
+{
+public:
+	ModuleWriter(const SymbolTable& symbols, uint64_t limit) : m_Symbols(symbols), m_Limit(limit) {}
+
+	bool Write(const Module& module, std::string& data)
+	{
+		Header header{};
+		Append(header);
+
+		ASTFormat::Module record{};
+		record.Def = WriteIdentifier(module.Def);
+
+		std::vector<ASTFormat::ModuleImport> imports;
+		for (auto& import : module.Imports) { imports.push_back({ WriteIdentifier(import.Imported), WriteIdentifier(import.As) }); }
+		record.Imports = AppendList(imports);
+
+		std::vector<Token> cImports;
+		for (auto& import : module.CImports) { cImports.push_back(Map(import.Path)); }
+		record.CImports = AppendList(cImports);
+
+		std::vector<ASTFormat::GlobalDefinition> definitions(module.Definitions.size());
+		for (size_t i = 0; i < definitions.size(); i++) { definitions[i].Exported = module.Definitions[i].Exported; }
+		record.Definitions = AppendList(definitions);
+		for (size_t i = 0; i < definitions.size(); i++)
+		{
+			Refer(Field(record.Definitions, i, offsetof(ASTFormat::GlobalDefinition, Def)), module.Definitions[i].Def);
+		}
+
+		while (!m_Pending.empty() && !m_TooLarge)
+		{
+			auto [field, node] = m_Pending.back();
+			m_Pending.pop_back();
+
+			// Interned types are shared, and only written the first time they are seen.
+			auto type = std::get_if<Type*>(&node);
+			if (type)
+			{
+				auto written = m_Types.find(*type);
+				if (written != m_Types.end())
+				{
+					Patch(field, written->second);
+					continue;
+				}
+			}
+
+			std::visit([this](auto n) { Dispatch(*n); }, node);
+			Patch(field, m_Written);
+			if (type) { m_Types.emplace(*type, m_Written); }
+		}
+
+		m_Path = module.FilePath.string();
+		record.FilePath = AddString(m_Path);
+		record.Strings = WriteStrings();
+		record.Integers = AppendList(module.Literals.Integers);
+		record.Reals = AppendList(module.Literals.Reals);
+
+		memcpy(header.Magic, ASTFormat::Magic, sizeof(header.Magic));
+		header.ByteOrder = ASTFormat::ByteOrderMark;
+		header.Version = ASTFormat::Version;
+		header.Module = Append(record);
+		header.Size = Narrow(m_Data.size());
+		if (m_TooLarge) { return false; }
+
+		memcpy(m_Data.data(), &header, sizeof(header));
+		data = std::move(m_Data);
+		return true;
+	}
+
+	void Visit(Abstract& node)
+	{
+		auto record = Begin<ASTFormat::Abstract>();
+		record.Ident = Map(node.Definition::Ident);
+		record.OwnIdent = Map(node.Ident);
+		record.Params = WriteParams(node.Params);
+		record.IsReturnConst = node.IsReturnConst;
+		record.IsConst = node.IsConst;
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Abstract, ReturnType), node.ReturnType);
+	}
+
+	void Visit(ArrayIndex& node)
+	{
+		auto record = Begin<ASTFormat::ArrayIndex>();
+		record.Var = WriteIdentifier(node.Var);
+		record.IsCopy = node.IsCopy;
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::ArrayIndex, Index), node.Index);
+	}
+
+	void Visit(ArrayType& node)
+	{
+		auto record = Begin<ASTFormat::ArrayType>();
+		record.Tok = Map(node.Tok);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::ArrayType, HoldType), node.HoldType);
+		Refer(offset + offsetof(ASTFormat::ArrayType, Size), node.Size);
+	}
+
+	void Visit(Assignment& node)
+	{
+		auto record = Begin<ASTFormat::Assignment>();
+		record.Var = WriteIdentifier(node.Var);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Assignment, Value), node.Value);
+	}
+
+	void Visit(Binary& node)
+	{
+		auto record = Begin<ASTFormat::Binary>();
+		record.Operator = Map(node.Operator);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Binary, Left), node.Left);
+		Refer(offset + offsetof(ASTFormat::Binary, Right), node.Right);
+	}
+
+	void Visit(Block& node)
+	{
+		auto record = Begin<ASTFormat::Block>();
+		record.Statements = WriteRefs(node.Statements);
+		End(record);
+	}
+
+	void Visit(Break&) { End(Begin<ASTFormat::Break>()); }
+
+	void Visit(Call& node)
+	{
+		auto record = Begin<ASTFormat::Call>();
+		record.Args = WriteRefs(node.Args);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Call, Callee), node.Callee);
+	}
+
+	void Visit(ClassDefinition& node)
+	{
+		auto record = Begin<ASTFormat::ClassDefinition>();
+		record.Ident = Map(node.Ident);
+
+		std::vector<ASTFormat::Identifier> bases;
+		for (auto& base : node.Bases) { bases.push_back(WriteIdentifier(base)); }
+		record.Bases = AppendList(bases);
+
+		record.Public = WriteRefs(node.Public);
+		record.Protected = WriteRefs(node.Protected);
+		record.Private = WriteRefs(node.Private);
+		End(record);
+	}
+
+	void Visit(ClassType& node)
+	{
+		auto record = Begin<ASTFormat::ClassType>();
+		record.Tok = Map(node.Tok);
+		record.Ident = WriteIdentifier(node.Ident);
+		End(record);
+	}
+
+	void Visit(ConditionFor& node)
+	{
+		auto record = Begin<ASTFormat::ConditionFor>();
+		auto offset = End(record);
+		std::visit([&](auto init) { Refer(offset + offsetof(ASTFormat::ConditionFor, Initializer), init); }, node.Condition.Initializer);
+		Refer(offset + offsetof(ASTFormat::ConditionFor, Condition), node.Condition.Condition);
+		Refer(offset + offsetof(ASTFormat::ConditionFor, Increment), node.Condition.Increment);
+		Refer(offset + offsetof(ASTFormat::ConditionFor, ExecBlock), node.ExecBlock);
+	}
+
+	void Visit(Constructor& node)
+	{
+		auto record = Begin<ASTFormat::Constructor>();
+		record.Ident = Map(node.Ident);
+		record.Params = WriteParams(node.Params);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Constructor, ExecBlock), node.ExecBlock);
+	}
+
+	void Visit(Continue&) { End(Begin<ASTFormat::Continue>()); }
+
+	void Visit(EnumDefinition& node)
+	{
+		auto record = Begin<ASTFormat::EnumDefinition>();
+		record.Ident = Map(node.Ident);
+
+		std::vector<Token> elements;
+		for (auto& element : node.Elements) { elements.push_back(Map(element)); }
+		record.Elements = AppendList(elements);
+		End(record);
+	}
+
+	void Visit(ExpressionStatement& node)
+	{
+		auto offset = End(Begin<ASTFormat::ExpressionStatement>());
+		Refer(offset + offsetof(ASTFormat::ExpressionStatement, Expr), node.Expr);
+	}
+
+	void Visit(Function& node)
+	{
+		auto record = Begin<ASTFormat::Function>();
+		record.Params = WriteParams(node.Params);
+		record.IsReturnConst = node.IsReturnConst;
+		record.IsVariadic = node.IsVariadic;
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Function, ReturnType), node.ReturnType);
+		Refer(offset + offsetof(ASTFormat::Function, ExecBlock), node.ExecBlock);
+	}
+
+	void Visit(FunctionDefinition& node)
+	{
+		auto record = Begin<ASTFormat::FunctionDefinition>();
+		record.Ident = Map(node.Ident);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::FunctionDefinition, Func), node.Func);
+	}
+
+	void Visit(FuncType& node)
+	{
+		auto record = Begin<ASTFormat::FuncType>();
+		record.Tok = Map(node.Tok);
+		record.ParamTypes = WriteRefs(node.ParamTypes);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::FuncType, ReturnType), node.ReturnType);
+	}
+
+	void Visit(Getter& node)
+	{
+		auto record = Begin<ASTFormat::Getter>();
+		record.Ident = Map(node.Definition::Ident);
+		record.OwnIdent = Map(node.Ident);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Getter, GetType), node.GetType);
+		Refer(offset + offsetof(ASTFormat::Getter, ExecBlock), node.ExecBlock);
+	}
+
+	void Visit(Group& node)
+	{
+		auto offset = End(Begin<ASTFormat::Group>());
+		Refer(offset + offsetof(ASTFormat::Group, Expr), node.Expr);
+	}
+
+	void Visit(If& node)
+	{
+		auto record = Begin<ASTFormat::If>();
+		record.ElseIfs = AppendList(std::vector<ASTFormat::ElseIf>(node.ElseIfs.size()));
+		for (size_t i = 0; i < node.ElseIfs.size(); i++)
+		{
+			Refer(Field(record.ElseIfs, i, offsetof(ASTFormat::ElseIf, Condition)), node.ElseIfs[i].Condition);
+			Refer(Field(record.ElseIfs, i, offsetof(ASTFormat::ElseIf, True)), node.ElseIfs[i].True);
+		}
+
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::If, Condition), node.Condition);
+		Refer(offset + offsetof(ASTFormat::If, True), node.True);
+		Refer(offset + offsetof(ASTFormat::If, Else), node.Else);
+	}
+
+	void Visit(InitializerList& node)
+	{
+		auto record = Begin<ASTFormat::InitializerList>();
+		record.Data = WriteRefs(node.Data);
+		End(record);
+	}
+
+	void Visit(Literal& node)
+	{
+		auto record = Begin<ASTFormat::Literal>();
+		record.Value = Map(node.Value);
+		End(record);
+	}
+
+	void Visit(Logical& node)
+	{
+		auto record = Begin<ASTFormat::Logical>();
+		record.Operator = Map(node.Operator);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Logical, Left), node.Left);
+		Refer(offset + offsetof(ASTFormat::Logical, Right), node.Right);
+	}
+
+	void Visit(Method& node)
+	{
+		auto record = Begin<ASTFormat::Method>();
+		record.Ident = Map(node.Ident);
+		record.IsStatic = node.IsStatic;
+		record.IsConst = node.IsConst;
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Method, Def), node.Def);
+	}
+
+	void Visit(OperatorOverload& node)
+	{
+		auto record = Begin<ASTFormat::OperatorOverload>();
+		record.Ident = Map(node.Ident);
+		record.Operator = Map(node.Operator);
+		record.Left = MapParam(node.Left);
+		record.Right = MapParam(node.Right);
+		record.IsUnary = node.IsUnary;
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::OperatorOverload, Left) + offsetof(ASTFormat::Parameter, DataType), node.Left.DataType);
+		Refer(offset + offsetof(ASTFormat::OperatorOverload, Right) + offsetof(ASTFormat::Parameter, DataType), node.Right.DataType);
+		Refer(offset + offsetof(ASTFormat::OperatorOverload, ExecBlock), node.ExecBlock);
+		Refer(offset + offsetof(ASTFormat::OperatorOverload, ReturnType), node.ReturnType);
+	}
+
+	void Visit(RangeFor& node)
+	{
+		auto record = Begin<ASTFormat::RangeFor>();
+		record.Ident = Map(node.Condition.Ident);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::RangeFor, Range), node.Condition.Range);
+		Refer(offset + offsetof(ASTFormat::RangeFor, ExecBlock), node.ExecBlock);
+	}
+
+	void Visit(Return& node)
+	{
+		auto offset = End(Begin<ASTFormat::Return>());
+		Refer(offset + offsetof(ASTFormat::Return, Value), node.Value);
+	}
+
+	void Visit(Setter& node)
+	{
+		auto record = Begin<ASTFormat::Setter>();
+		record.Ident = Map(node.Definition::Ident);
+		record.OwnIdent = Map(node.Ident);
+		record.SetParam = MapParam(node.SetParam);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Setter, SetParam) + offsetof(ASTFormat::Parameter, DataType), node.SetParam.DataType);
+		Refer(offset + offsetof(ASTFormat::Setter, ExecBlock), node.ExecBlock);
+	}
+
+	void Visit(SimpleType& node)
+	{
+		auto record = Begin<ASTFormat::SimpleType>();
+		record.Tok = Map(node.Tok);
+		record.T = static_cast<uint8_t>(node.T);
+		End(record);
+	}
+
+	void Visit(Throw& node)
+	{
+		auto offset = End(Begin<ASTFormat::Throw>());
+		Refer(offset + offsetof(ASTFormat::Throw, Value), node.Value);
+	}
+
+	void Visit(Try& node)
+	{
+		auto record = Begin<ASTFormat::Try>();
+		std::vector<ASTFormat::Catch> catches;
+		for (auto& c : node.Catches) { catches.push_back({ 0, MapParam(c.Param) }); }
+		record.Catches = AppendList(catches);
+		for (size_t i = 0; i < node.Catches.size(); i++)
+		{
+			Refer(Field(record.Catches, i, offsetof(ASTFormat::Catch, ExecBlock)), node.Catches[i].ExecBlock);
+			Refer(Field(record.Catches, i, offsetof(ASTFormat::Catch, Param) + offsetof(ASTFormat::Parameter, DataType)), node.Catches[i].Param.DataType);
+		}
+
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Try, ExecBlock), node.ExecBlock);
+	}
+
+	void Visit(TupleType& node)
+	{
+		auto record = Begin<ASTFormat::TupleType>();
+		record.Tok = Map(node.Tok);
+		record.Types = WriteRefs(node.Types);
+		End(record);
+	}
+
+	void Visit(TypeOf& node)
+	{
+		auto record = Begin<ASTFormat::TypeOf>();
+		record.Tok = Map(node.Tok);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::TypeOf, Expr), node.Expr);
+	}
+
+	void Visit(Unary& node)
+	{
+		auto record = Begin<ASTFormat::Unary>();
+		record.Operator = Map(node.Operator);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::Unary, Right), node.Right);
+	}
+
+	void Visit(VarAccess& node)
+	{
+		auto record = Begin<ASTFormat::VarAccess>();
+		record.Var = WriteIdentifier(node.Var);
+		record.IsCopy = node.IsCopy;
+		End(record);
+	}
+
+	void Visit(VarDefinition& node)
+	{
+		auto record = Begin<ASTFormat::VarDefinition>();
+		record.Ident = Map(node.Ident);
+		record.VarType = Map(node.VarType);
+		auto offset = End(record);
+		Refer(offset + offsetof(ASTFormat::VarDefinition, DataType), node.DataType);
+		Refer(offset + offsetof(ASTFormat::VarDefinition, Value), node.Value);
+	}
+
+	void Visit(While& node)
+	{
+		auto offset = End(Begin<ASTFormat::While>());
+		Refer(offset + offsetof(ASTFormat::While, Condition), node.Condition);
+		Refer(offset + offsetof(ASTFormat::While, ExecBlock), node.ExecBlock);
+	}
+
+private:
+	using Node = std::variant<Statement*, Expression*, Type*>;
+
+	/// Narrow an offset, size or count to the 32 bits records store it in.
+	/// A value past the limit makes the module too large to write.
+	uint32_t Narrow(uint64_t value)
+	{
+		if (value > m_Limit)
+		{
+			m_TooLarge = true;
+			return 0;
+		}
+
+		return static_cast<uint32_t>(value);
+	}
+
+	template<typename T>
+	uint32_t Append(const T& record)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "records must be trivially copyable");
+
+		// Every record is aligned to at least 4 bytes, so that Refs can be read in place.
+		constexpr size_t alignment = alignof(T) < 4 ? 4 : alignof(T);
+		m_Data.resize((m_Data.size() + alignment - 1) & ~(alignment - 1));
+
+		auto offset = Narrow(m_Data.size());
+		m_Data.append(reinterpret_cast<const char*>(&record), sizeof(T));
+		return offset;
+	}
+
+	template<typename T>
+	List<T> AppendList(const std::vector<T>& records)
+	{
+		if (records.empty()) { return {}; }
+
+		List<T> list;
+		list.Offset = Append(records[0]);
+		list.Count = Narrow(records.size());
+		m_Data.append(reinterpret_cast<const char*>(records.data() + 1), (records.size() - 1) * sizeof(T));
+		return list;
+	}
+
+	template<typename T>
+	T Begin()
+	{
+		T record{};
+		record.Header.Kind = T::Kind;
+		return record;
+	}
+
+	template<typename T>
+	uint32_t End(const T& record)
+	{
+		m_Written = Append(record);
+		return m_Written;
+	}
+
+	/// Get the offset of a field of a record in a list.
+	template<typename T>
+	uint32_t Field(const List<T>& list, size_t index, size_t field)
+	{
+		return Narrow(list.Offset + index * sizeof(T) + field);
+	}
+
+	void Patch(uint32_t field, Ref ref) { memcpy(&m_Data[field], &ref, sizeof(ref)); }
+
+	void Refer(uint32_t field, Statement* node) { if (node) { m_Pending.emplace_back(field, node); } }
+	void Refer(uint32_t field, Expression* node) { if (node) { m_Pending.emplace_back(field, node); } }
+	void Refer(uint32_t field, Type* node) { if (node) { m_Pending.emplace_back(field, node); } }
+
+	template<typename Nodes>
+	List<Ref> WriteRefs(const Nodes& nodes)
+	{
+		auto list = AppendList(std::vector<Ref>(nodes.size()));
+		for (size_t i = 0; i < nodes.size(); i++) { Refer(Field(list, i, 0), nodes[i]); }
+		return list;
+	}
+
+	ASTFormat::Parameter MapParam(const Parameter& param)
+	{
+		ASTFormat::Parameter record{};
+		record.Ident = Map(param.Ident);
+		record.IsConst = param.IsConst;
+		return record;
+	}
+
+	List<ASTFormat::Parameter> WriteParams(const SmallVector<Parameter, 4>& params)
+	{
+		std::vector<ASTFormat::Parameter> records;
+		for (auto& param : params) { records.push_back(MapParam(param)); }
+
+		auto list = AppendList(records);
+		for (size_t i = 0; i < params.size(); i++)
+		{
+			Refer(Field(list, i, offsetof(ASTFormat::Parameter, DataType)), params[i].DataType);
+		}
+		return list;
+	}
+
+	ASTFormat::Identifier WriteIdentifier(const Identifier& identifier)
+	{
+		std::vector<Token> tokens;
+		for (auto& token : identifier.Path) { tokens.push_back(Map(token)); }
+		return AppendList(tokens);
+	}
+
+	Token Map(Token token)
+	{
+		token.File = 0;
+		if (IsSymbol(token.Type)) { token.Value = AddSymbol(static_cast<Symbol>(token.Value)); }
+		return token;
+	}
+
+	uint32_t AddSymbol(Symbol symbol)
+	{
+		auto [it, added] = m_SymbolStrings.emplace(symbol, 0);
+		if (added) { it->second = AddString(m_Symbols.GetString(symbol)); }
+		return it->second;
+	}
+
+	uint32_t AddString(std::string_view string)
+	{
+		m_Strings.push_back(string);
+		return Narrow(m_Strings.size() - 1);
+	}
+
+	List<ASTFormat::String> WriteStrings()
+	{
+		std::vector<ASTFormat::String> table(m_Strings.size());
+		for (size_t i = 0; i < m_Strings.size(); i++)
+		{
+			table[i].Offset = Narrow(m_Data.size());
+			table[i].Length = Narrow(m_Strings[i].size());
+			m_Data.append(m_Strings[i]);
+		}
+		return AppendList(table);
+	}
+
+	const SymbolTable& m_Symbols;
+	uint64_t m_Limit;
+	bool m_TooLarge = false;
+	std::string m_Data;
+	std::vector<std::pair<uint32_t, Node>> m_Pending;
+	Ref m_Written = 0;
+	std::unordered_map<const Type*, Ref> m_Types;
+
+	std::unordered_map<Symbol, uint32_t> m_SymbolStrings;
+	std::vector<std::string_view> m_Strings;
+	std::string m_Path;
+};
+
+/// Builds the AST of a serialized module, from a worklist like ModuleWriter.
+/// Each pending Ref knows the field its node goes in, and the base type that field holds.
+/// Types are read bottom-up instead, and interned in the TypeContext of the module like the parser does.
+class ModuleReader
+{
+public:
+	ModuleReader(CompileContext& context, FileID file, const char* data, uint64_t size)
+		: m_View(data, size), m_Context(context), m_File(file), m_NodeLimit(size / sizeof(ASTFormat::Node))
+	{}
+
+	up<Module> Read()
+	{
+		if (!m_View.IsValid()) { return nullptr; }
+
+		auto& record = m_View.GetModule();
+		m_Module = std::make_unique<Module>();
+
+		m_Module->Literals.Integers = ReadList(record.Integers);
+		m_Module->Literals.Reals = ReadList(record.Reals);
+
+		auto strings = m_View.Get(record.Strings);
+		if (strings.Count != record.Strings.Count) { return nullptr; }
+		m_StringSymbols.resize(strings.Count);
+		for (uint32_t i = 0; i < strings.Count; i++) { m_StringSymbols[i] = m_Context.GetSymbols().Intern(m_View.GetString(i)); }
+		m_Module->FilePath = std::string(m_View.GetString(record.FilePath));
+
+		ReadIdentifier(record.Def, m_Module->Def);
+
+		auto imports = ReadList(record.Imports);
+		m_Module->Imports.resize(imports.size());
+		for (size_t i = 0; i < imports.size(); i++)
+		{
+			ReadIdentifier(imports[i].Imported, m_Module->Imports[i].Imported);
+			ReadIdentifier(imports[i].As, m_Module->Imports[i].As);
+		}
+
+		for (auto& path : ReadList(record.CImports)) { m_Module->CImports.push_back({ Unmap(path) }); }
+
+		auto definitions = ReadList(record.Definitions);
+		m_Module->Definitions.resize(definitions.size());
+		for (size_t i = 0; i < definitions.size(); i++)
+		{
+			m_Module->Definitions[i].Exported = definitions[i].Exported != 0;
+			Refer(definitions[i].Def, m_Module->Definitions[i].Def);
+		}
+
+		while (m_Good && !m_Pending.empty())
+		{
+			auto pending = m_Pending.back();
+			m_Pending.pop_back();
+			ReadNode(pending);
+		}
+
+		if (!m_Good) { return nullptr; }
+		return std::move(m_Module);
+	}
+
+private:
+	/// Base type of the field a node goes in.
+	enum class Slot : uint8_t
+	{
+		Statement, Definition, Block, FunctionDefinition, Expression, Function, Type, Initializer
+	};
+
+	struct Pending
+	{
+		Ref Node;
+		Slot Kind;
+		void* Field;
+	};
+
+	template<typename T>
+	static constexpr Slot GetSlot()
+	{
+		if constexpr (std::is_same_v<T, Statement>) { return Slot::Statement; }
+		else if constexpr (std::is_same_v<T, Definition>) { return Slot::Definition; }
+		else if constexpr (std::is_same_v<T, Wave::Block>) { return Slot::Block; }
+		else if constexpr (std::is_same_v<T, Wave::FunctionDefinition>) { return Slot::FunctionDefinition; }
+		else if constexpr (std::is_same_v<T, Expression>) { return Slot::Expression; }
+		else if constexpr (std::is_same_v<T, Wave::Function>) { return Slot::Function; }
+		else
+		{
+			static_assert(std::is_same_v<T, Type>, "unknown node field type");
+			return Slot::Type;
+		}
+	}
+
+	template<typename T>
+	void Refer(Ref ref, T*& field)
+	{
+		if (ref) { m_Pending.push_back({ ref, GetSlot<T>(), &field }); }
+	}
+
+	void Refer(Ref ref, std::variant<Expression*, Definition*>& field)
+	{
+		if (ref) { m_Pending.push_back({ ref, Slot::Initializer, &field }); }
+	}
+
+	template<typename Base, typename T>
+	void Store(void* field, T* node)
+	{
+		if constexpr (std::is_convertible_v<T*, Base*>) { *static_cast<Base**>(field) = node; }
+		else { m_Good = false; }
+	}
+
+	template<typename T>
+	void Assign(const Pending& pending, T* node)
+	{
+		switch (pending.Kind)
+		{
+		case Slot::Statement: Store<Statement>(pending.Field, node); break;
+		case Slot::Definition: Store<Definition>(pending.Field, node); break;
+		case Slot::Block: Store<Wave::Block>(pending.Field, node); break;
+		case Slot::FunctionDefinition: Store<Wave::FunctionDefinition>(pending.Field, node); break;
+		case Slot::Expression: Store<Expression>(pending.Field, node); break;
+		case Slot::Function: Store<Wave::Function>(pending.Field, node); break;
+		case Slot::Type: Store<Type>(pending.Field, node); break;
+		case Slot::Initializer:
+		{
+			auto& initializer = *static_cast<std::variant<Expression*, Definition*>*>(pending.Field);
+			if constexpr (std::is_convertible_v<T*, Definition*>) { initializer = static_cast<Definition*>(node); }
+			else if constexpr (std::is_convertible_v<T*, Expression*>) { initializer = static_cast<Expression*>(node); }
+			else { m_Good = false; }
+			break;
+		}
+		}
+	}
+
+	/// Create the node of a record, and put it in the field waiting for it.
+	template<typename T, typename R>
+	void Make(const Pending& pending)
+	{
+		auto record = m_View.Get<R>(pending.Node);
+		if (!record || m_NodeCount++ == m_NodeLimit)
+		{
+			m_Good = false;
+			return;
+		}
+
+		auto node = m_Module->Nodes.Make<T>();
+		Fill(*node, *record);
+		Assign(pending, node);
+	}
+
+	void ReadNode(const Pending& pending)
+	{
+		if (pending.Kind == Slot::Type)
+		{
+			Store<Type>(pending.Field, ReadType(pending.Node));
+			return;
+		}
+
+		switch (m_View.GetKind(pending.Node))
+		{
+		case NodeKind::Abstract: Make<Wave::Abstract, ASTFormat::Abstract>(pending); break;
+		case NodeKind::ArrayIndex: Make<Wave::ArrayIndex, ASTFormat::ArrayIndex>(pending); break;
+		case NodeKind::Assignment: Make<Wave::Assignment, ASTFormat::Assignment>(pending); break;
+		case NodeKind::Binary: Make<Wave::Binary, ASTFormat::Binary>(pending); break;
+		case NodeKind::Block: Make<Wave::Block, ASTFormat::Block>(pending); break;
+		case NodeKind::Break: Make<Wave::Break, ASTFormat::Break>(pending); break;
+		case NodeKind::Call: Make<Wave::Call, ASTFormat::Call>(pending); break;
+		case NodeKind::ClassDefinition: Make<Wave::ClassDefinition, ASTFormat::ClassDefinition>(pending); break;
+		case NodeKind::ConditionFor: Make<Wave::ConditionFor, ASTFormat::ConditionFor>(pending); break;
+		case NodeKind::Constructor: Make<Wave::Constructor, ASTFormat::Constructor>(pending); break;
+		case NodeKind::Continue: Make<Wave::Continue, ASTFormat::Continue>(pending); break;
+		case NodeKind::EnumDefinition: Make<Wave::EnumDefinition, ASTFormat::EnumDefinition>(pending); break;
+		case NodeKind::ExpressionStatement: Make<Wave::ExpressionStatement, ASTFormat::ExpressionStatement>(pending); break;
+		case NodeKind::Function: Make<Wave::Function, ASTFormat::Function>(pending); break;
+		case NodeKind::FunctionDefinition: Make<Wave::FunctionDefinition, ASTFormat::FunctionDefinition>(pending); break;
+		case NodeKind::Getter: Make<Wave::Getter, ASTFormat::Getter>(pending); break;
+		case NodeKind::Group: Make<Wave::Group, ASTFormat::Group>(pending); break;
+		case NodeKind::If: Make<Wave::If, ASTFormat::If>(pending); break;
+		case NodeKind::InitializerList: Make<Wave::InitializerList, ASTFormat::InitializerList>(pending); break;
+		case NodeKind::Literal: Make<Wave::Literal, ASTFormat::Literal>(pending); break;
+		case NodeKind::Logical: Make<Wave::Logical, ASTFormat::Logical>(pending); break;
+		case NodeKind::Method: Make<Wave::Method, ASTFormat::Method>(pending); break;
+		case NodeKind::OperatorOverload: Make<Wave::OperatorOverload, ASTFormat::OperatorOverload>(pending); break;
+		case NodeKind::RangeFor: Make<Wave::RangeFor, ASTFormat::RangeFor>(pending); break;
+		case NodeKind::Return: Make<Wave::Return, ASTFormat::Return>(pending); break;
+		case NodeKind::Setter: Make<Wave::Setter, ASTFormat::Setter>(pending); break;
+		case NodeKind::Throw: Make<Wave::Throw, ASTFormat::Throw>(pending); break;
+		case NodeKind::Try: Make<Wave::Try, ASTFormat::Try>(pending); break;
+		case NodeKind::Unary: Make<Wave::Unary, ASTFormat::Unary>(pending); break;
+		case NodeKind::VarAccess: Make<Wave::VarAccess, ASTFormat::VarAccess>(pending); break;
+		case NodeKind::VarDefinition: Make<Wave::VarDefinition, ASTFormat::VarDefinition>(pending); break;
+		case NodeKind::While: Make<Wave::While, ASTFormat::While>(pending); break;
+		// Types are only read into type fields, by ReadType.
+		case NodeKind::ArrayType:
+		case NodeKind::ClassType:
+		case NodeKind::FuncType:
+		case NodeKind::SimpleType:
+		case NodeKind::TupleType:
+		case NodeKind::TypeOf:
+		case NodeKind::Count: m_Good = false; break;
+		}
+	}
+
+	/// Read a type, after the types it is made of so that it can be interned.
+	/// A type referred to many times is read once, and a type which is part of itself fails the read.
+	Type* ReadType(Ref root)
+	{
+		m_TypeStack.push_back({ root, false });
+		while (m_Good && !m_TypeStack.empty())
+		{
+			auto [ref, expanded] = m_TypeStack.back();
+			if (expanded)
+			{
+				m_TypeStack.pop_back();
+				m_Types[ref] = MakeType(ref);
+				continue;
+			}
+
+			auto read = m_Types.find(ref);
+			if (read != m_Types.end())
+			{
+				// A type which is still being read is part of itself.
+				if (!read->second) { m_Good = false; }
+				m_TypeStack.pop_back();
+				continue;
+			}
+
+			m_Types.emplace(ref, nullptr);
+			m_TypeStack.back().second = true;
+			GetTypeParts(ref);
+			for (auto part : m_Parts)
+			{
+				if (part) { m_TypeStack.push_back({ part, false }); }
+			}
+		}
+
+		m_TypeStack.clear();
+		return m_Good ? m_Types[root] : nullptr;
+	}
+
+	/// Get the Refs to the types a type record is made of into m_Parts.
+	/// The return type of a function type is last.
+	void GetTypeParts(Ref ref)
+	{
+		m_Parts.clear();
+		switch (m_View.GetKind(ref))
+		{
+		case NodeKind::ArrayType:
+			if (auto record = m_View.Get<ASTFormat::ArrayType>(ref)) { m_Parts.push_back(record->HoldType); }
+			break;
+		case NodeKind::FuncType:
+			if (auto record = m_View.Get<ASTFormat::FuncType>(ref))
+			{
+				m_Parts = ReadList(record->ParamTypes);
+				m_Parts.push_back(record->ReturnType);
+			}
+			break;
+		case NodeKind::TupleType:
+			if (auto record = m_View.Get<ASTFormat::TupleType>(ref)) { m_Parts = ReadList(record->Types); }
+			break;
+		default:
+			break;
+		}
+	}
+
+	/// Make the node of a type record whose parts have all been read.
+	Type* MakeType(Ref ref)
+	{
+		if (m_NodeCount++ == m_NodeLimit)
+		{
+			m_Good = false;
+			return nullptr;
+		}
+
+		GetTypeParts(ref);
+		m_PartTypes.clear();
+		for (auto part : m_Parts) { m_PartTypes.push_back(part ? m_Types[part] : nullptr); }
+
+		auto& types = m_Module->Types;
+		switch (m_View.GetKind(ref))
+		{
+		case NodeKind::ArrayType:
+		{
+			auto record = m_View.Get<ASTFormat::ArrayType>(ref);
+			if (!record) { break; }
+			if (!record->Size) { return types.GetArray(m_PartTypes[0], Unmap(record->Tok)); }
+
+			// The size is an expression, so sized arrays are not interned.
+			auto node = m_Module->Nodes.Make<Wave::ArrayType>();
+			node->Tok = Unmap(record->Tok);
+			node->HoldType = m_PartTypes[0];
+			Refer(record->Size, node->Size);
+			return node;
+		}
+		case NodeKind::ClassType:
+		{
+			auto record = m_View.Get<ASTFormat::ClassType>(ref);
+			if (!record) { break; }
+
+			Identifier ident;
+			ReadIdentifier(record->Ident, ident);
+			return types.GetClass(ident, Unmap(record->Tok));
+		}
+		case NodeKind::FuncType:
+		{
+			auto record = m_View.Get<ASTFormat::FuncType>(ref);
+			if (!record) { break; }
+
+			auto returnType = m_PartTypes.back();
+			m_PartTypes.pop_back();
+			return types.GetFunc(m_PartTypes, returnType, Unmap(record->Tok));
+		}
+		case NodeKind::SimpleType:
+		{
+			auto record = m_View.Get<ASTFormat::SimpleType>(ref);
+			if (!record || record->T > static_cast<uint8_t>(Wave::SimpleType::TypeType::Generic)) { break; }
+
+			return types.GetSimple(static_cast<Wave::SimpleType::TypeType>(record->T), Unmap(record->Tok));
+		}
+		case NodeKind::TupleType:
+		{
+			auto record = m_View.Get<ASTFormat::TupleType>(ref);
+			if (!record) { break; }
+
+			return types.GetTuple(m_PartTypes, Unmap(record->Tok));
+		}
+		case NodeKind::TypeOf:
+		{
+			auto record = m_View.Get<ASTFormat::TypeOf>(ref);
+			if (!record) { break; }
+
+			// The expression is not a type, so it is read from the worklist.
+			auto node = m_Module->Nodes.Make<Wave::TypeOf>();
+			node->Tok = Unmap(record->Tok);
+			Refer(record->Expr, node->Expr);
+			return node;
+		}
+		default:
+			break;
+		}
+
+		m_Good = false;
+		return nullptr;
+	}
+
+	void Fill(Wave::Abstract& node, const ASTFormat::Abstract& record)
+	{
+		node.Definition::Ident = Unmap(record.Ident);
+		node.Ident = Unmap(record.OwnIdent);
+		ReadParams(record.Params, node.Params);
+		Refer(record.ReturnType, node.ReturnType);
+		node.IsReturnConst = record.IsReturnConst != 0;
+		node.IsConst = record.IsConst != 0;
+	}
+
+	void Fill(Wave::ArrayIndex& node, const ASTFormat::ArrayIndex& record)
+	{
+		ReadIdentifier(record.Var, node.Var);
+		node.IsCopy = record.IsCopy != 0;
+		Refer(record.Index, node.Index);
+	}
+
+	void Fill(Wave::Assignment& node, const ASTFormat::Assignment& record)
+	{
+		ReadIdentifier(record.Var, node.Var);
+		Refer(record.Value, node.Value);
+	}
+
+	void Fill(Wave::Binary& node, const ASTFormat::Binary& record)
+	{
+		Refer(record.Left, node.Left);
+		node.Operator = Unmap(record.Operator);
+		Refer(record.Right, node.Right);
+	}
+
+	void Fill(Wave::Block& node, const ASTFormat::Block& record) { ReadRefs(record.Statements, node.Statements); }
+	void Fill(Wave::Break&, const ASTFormat::Break&) {}
+
+	void Fill(Wave::Call& node, const ASTFormat::Call& record)
+	{
+		Refer(record.Callee, node.Callee);
+		ReadRefs(record.Args, node.Args);
+	}
+
+	void Fill(Wave::ClassDefinition& node, const ASTFormat::ClassDefinition& record)
+	{
+		node.Ident = Unmap(record.Ident);
+
+		auto bases = ReadList(record.Bases);
+		node.Bases.resize(bases.size());
+		for (size_t i = 0; i < bases.size(); i++) { ReadIdentifier(bases[i], node.Bases[i]); }
+
+		ReadRefs(record.Public, node.Public);
+		ReadRefs(record.Protected, node.Protected);
+		ReadRefs(record.Private, node.Private);
+	}
+
+	void Fill(Wave::ConditionFor& node, const ASTFormat::ConditionFor& record)
+	{
+		Refer(record.Initializer, node.Condition.Initializer);
+		Refer(record.Condition, node.Condition.Condition);
+		Refer(record.Increment, node.Condition.Increment);
+		Refer(record.ExecBlock, node.ExecBlock);
+	}
+
+	void Fill(Wave::Constructor& node, const ASTFormat::Constructor& record)
+	{
+		node.Ident = Unmap(record.Ident);
+		ReadParams(record.Params, node.Params);
+		Refer(record.ExecBlock, node.ExecBlock);
+	}
+
+	void Fill(Wave::Continue&, const ASTFormat::Continue&) {}
+
+	void Fill(Wave::EnumDefinition& node, const ASTFormat::EnumDefinition& record)
+	{
+		node.Ident = Unmap(record.Ident);
+		for (auto& element : ReadList(record.Elements)) { node.Elements.push_back(Unmap(element)); }
+	}
+
+	void Fill(Wave::ExpressionStatement& node, const ASTFormat::ExpressionStatement& record) { Refer(record.Expr, node.Expr); }
+
+	void Fill(Wave::Function& node, const ASTFormat::Function& record)
+	{
+		ReadParams(record.Params, node.Params);
+		Refer(record.ReturnType, node.ReturnType);
+		Refer(record.ExecBlock, node.ExecBlock);
+		node.IsReturnConst = record.IsReturnConst != 0;
+		node.IsVariadic = record.IsVariadic != 0;
+	}
+
+	void Fill(Wave::FunctionDefinition& node, const ASTFormat::FunctionDefinition& record)
+	{
+		node.Ident = Unmap(record.Ident);
+		Refer(record.Func, node.Func);
+	}
+
+	void Fill(Wave::Getter& node, const ASTFormat::Getter& record)
+	{
+		node.Definition::Ident = Unmap(record.Ident);
+		node.Ident = Unmap(record.OwnIdent);
+		Refer(record.GetType, node.GetType);
+		Refer(record.ExecBlock, node.ExecBlock);
+	}
+
+	void Fill(Wave::Group& node, const ASTFormat::Group& record) { Refer(record.Expr, node.Expr); }
+
+	void Fill(Wave::If& node, const ASTFormat::If& record)
+	{
+		Refer(record.Condition, node.Condition);
+		Refer(record.True, node.True);
+
+		auto elseIfs = ReadList(record.ElseIfs);
+		node.ElseIfs.resize(elseIfs.size());
+		for (size_t i = 0; i < elseIfs.size(); i++)
+		{
+			Refer(elseIfs[i].Condition, node.ElseIfs[i].Condition);
+			Refer(elseIfs[i].True, node.ElseIfs[i].True);
+		}
+
+		Refer(record.Else, node.Else);
+	}
+
+	void Fill(Wave::InitializerList& node, const ASTFormat::InitializerList& record) { ReadRefs(record.Data, node.Data); }
+	void Fill(Wave::Literal& node, const ASTFormat::Literal& record) { node.Value = Unmap(record.Value); }
+
+	void Fill(Wave::Logical& node, const ASTFormat::Logical& record)
+	{
+		Refer(record.Left, node.Left);
+		node.Operator = Unmap(record.Operator);
+		Refer(record.Right, node.Right);
+	}
+
+	void Fill(Wave::Method& node, const ASTFormat::Method& record)
+	{
+		node.Ident = Unmap(record.Ident);
+		node.IsStatic = record.IsStatic != 0;
+		node.IsConst = record.IsConst != 0;
+		Refer(record.Def, node.Def);
+	}
+
+	void Fill(Wave::OperatorOverload& node, const ASTFormat::OperatorOverload& record)
+	{
+		node.Ident = Unmap(record.Ident);
+		node.Operator = Unmap(record.Operator);
+		node.IsUnary = record.IsUnary != 0;
+		ReadParam(record.Left, node.Left);
+		ReadParam(record.Right, node.Right);
+		Refer(record.ExecBlock, node.ExecBlock);
+		Refer(record.ReturnType, node.ReturnType);
+	}
+
+	void Fill(Wave::RangeFor& node, const ASTFormat::RangeFor& record)
+	{
+		node.Condition.Ident = Unmap(record.Ident);
+		Refer(record.Range, node.Condition.Range);
+		Refer(record.ExecBlock, node.ExecBlock);
+	}
+
+	void Fill(Wave::Return& node, const ASTFormat::Return& record) { Refer(record.Value, node.Value); }
+
+	void Fill(Wave::Setter& node, const ASTFormat::Setter& record)
+	{
+		node.Definition::Ident = Unmap(record.Ident);
+		node.Ident = Unmap(record.OwnIdent);
+		ReadParam(record.SetParam, node.SetParam);
+		Refer(record.ExecBlock, node.ExecBlock);
+	}
+
+	void Fill(Wave::Throw& node, const ASTFormat::Throw& record) { Refer(record.Value, node.Value); }
+
+	void Fill(Wave::Try& node, const ASTFormat::Try& record)
+	{
+		Refer(record.ExecBlock, node.ExecBlock);
+
+		auto catches = ReadList(record.Catches);
+		node.Catches.resize(catches.size());
+		for (size_t i = 0; i < catches.size(); i++)
+		{
+			Refer(catches[i].ExecBlock, node.Catches[i].ExecBlock);
+			ReadParam(catches[i].Param, node.Catches[i].Param);
+		}
+	}
+
+	void Fill(Wave::Unary& node, const ASTFormat::Unary& record)
+	{
+		node.Operator = Unmap(record.Operator);
+		Refer(record.Right, node.Right);
+	}
+
+	void Fill(Wave::VarAccess& node, const ASTFormat::VarAccess& record)
+	{
+		ReadIdentifier(record.Var, node.Var);
+		node.IsCopy = record.IsCopy != 0;
+	}
+
+	void Fill(Wave::VarDefinition& node, const ASTFormat::VarDefinition& record)
+	{
+		node.Ident = Unmap(record.Ident);
+		node.VarType = Unmap(record.VarType);
+		Refer(record.DataType, node.DataType);
+		Refer(record.Value, node.Value);
+	}
+
+	void Fill(Wave::While& node, const ASTFormat::While& record)
+	{
+		Refer(record.Condition, node.Condition);
+		Refer(record.ExecBlock, node.ExecBlock);
+	}
+
+	/// Copy the records of a list, failing the read if the list does not fit in the buffer.
+	template<typename T>
+	std::vector<T> ReadList(const List<T>& list)
+	{
+		auto records = m_View.Get(list);
+		if (records.Count != list.Count) { m_Good = false; }
+		return std::vector<T>(records.begin(), records.end());
+	}
+
+	template<typename Nodes>
+	void ReadRefs(const List<Ref>& list, Nodes& nodes)
+	{
+		auto refs = m_View.Get(list);
+		if (refs.Count != list.Count) { m_Good = false; }
+
+		nodes.resize(refs.Count);
+		for (uint32_t i = 0; i < refs.Count; i++) { Refer(refs[i], nodes[i]); }
+	}
+
+	void ReadParam(const ASTFormat::Parameter& record, Parameter& param)
+	{
+		param.IsConst = record.IsConst != 0;
+		param.Ident = Unmap(record.Ident);
+		Refer(record.DataType, param.DataType);
+	}
+
+	void ReadParams(const List<ASTFormat::Parameter>& list, SmallVector<Parameter, 4>& params)
+	{
+		auto records = m_View.Get(list);
+		if (records.Count != list.Count) { m_Good = false; }
+
+		params.resize(records.Count);
+		for (uint32_t i = 0; i < records.Count; i++) { ReadParam(records[i], params[i]); }
+	}
+
+	void ReadIdentifier(const ASTFormat::Identifier& list, Identifier& identifier)
+	{
+		auto tokens = m_View.Get(list);
+		if (tokens.Count != list.Count) { m_Good = false; }
+
+		identifier.Path.resize(tokens.Count);
+		for (uint32_t i = 0; i < tokens.Count; i++) { identifier.Path[i] = Unmap(tokens[i]); }
+	}
+
+	Token Unmap(Token token)
+	{
+		token.File = m_File;
+		token.Reserved = 0;
+		if (token.Type > TokenType::Null) { m_Good = false; }
+		else if (IsSymbol(token.Type))
+		{
+			if (token.Value < m_StringSymbols.size()) { token.Value = m_StringSymbols[token.Value]; }
+			else { m_Good = false; }
+		}
+		else if (token.Type == TokenType::Integer && token.Value >= m_Module->Literals.Integers.size()) { m_Good = false; }
+		else if (token.Type == TokenType::Real && token.Value >= m_Module->Literals.Reals.size()) { m_Good = false; }
+
+		return token;
+	}
+
+	BinaryModule m_View;
+	CompileContext& m_Context;
+	FileID m_File;
+	up<Module> m_Module;
+	std::vector<Symbol> m_StringSymbols;
+	std::vector<Pending> m_Pending;
+	std::vector<std::pair<Ref, bool>> m_TypeStack;
+	std::unordered_map<Ref, Type*> m_Types;
+	std::vector<Ref> m_Parts;
+	SmallVector<Type*, 4> m_PartTypes;
+	uint64_t m_NodeCount = 0;
+	uint64_t m_NodeLimit;
+	bool m_Good = true;
+};
+
+}
+
+BinaryModule::BinaryModule(const char* data, uint64_t size)
+	: m_Data(data), m_Size(size)
+{
+	Header header;
+	if (size < sizeof(header) || reinterpret_cast<uintptr_t>(data) % alignof(double) != 0) { return; }
+
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.Magic, ASTFormat::Magic, sizeof(header.Magic)) != 0 || header.ByteOrder != ASTFormat::ByteOrderMark ||
+		header.Version != ASTFormat::Version || header.Size > size)
+	{
+		return;
+	}
+
+	m_Size = header.Size;
+	if (!Fits(header.Module, sizeof(ASTFormat::Module), alignof(ASTFormat::Module))) { return; }
+
+	m_Module = reinterpret_cast<const ASTFormat::Module*>(data + header.Module);
+	m_Strings = Get(m_Module->Strings);
+}
+
+NodeKind BinaryModule::GetKind(Ref ref) const
+{
+	if (!Fits(ref, sizeof(ASTFormat::Node), alignof(ASTFormat::Node))) { return NodeKind::Count; }
+
+	auto kind = reinterpret_cast<const ASTFormat::Node*>(m_Data + ref)->Kind;
+	return kind < NodeKind::Count ? kind : NodeKind::Count;
+}
+
+std::string_view BinaryModule::GetString(uint32_t index) const
+{
+	if (index >= m_Strings.Count) { return {}; }
+
+	auto& string = m_Strings[index];
+	if (string.Length == 0 || !Fits(string.Offset, string.Length, 1)) { return {}; }
+	return std::string_view(m_Data + string.Offset, string.Length);
+}
+
+bool SerializeModule(const Module& module, const SymbolTable& symbols, std::string& data, uint64_t limit)
+{
+	return ModuleWriter(symbols, std::min(limit, ASTFormat::MaxSize)).Write(module, data);
+}
+
+up<Module> DeserializeModule(CompileContext& context, FileID file, const char* data, uint64_t size)
+{
+	return ModuleReader(context, file, data, size).Read();
+}
+
+}
@@ -0,0 +1,200 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Parser/ASTTraversal.h"
+
+#include "Parser/StaticVisitor.h"
+
+namespace Wave {
+
+namespace {
+
+/// Pushes the children of a node in reverse source order, so that they are popped in source order.
+/// Missing children are skipped.
+template<typename Entry>
+class ChildPusher : public StaticVisitor<ChildPusher<Entry>>
+{
+public:
+	ChildPusher(std::vector<Entry>& stack) : m_Stack(stack) {}
+
+	void Visit(Abstract& node) { Push(node.ReturnType); Push(node.Params); }
+	void Visit(ArrayIndex& node) { Push(node.Index); }
+	void Visit(ArrayType& node) { Push(node.Size); Push(node.HoldType); }
+	void Visit(Assignment& node) { Push(node.Value); }
+	void Visit(Binary& node) { Push(node.Right); Push(node.Left); }
+	void Visit(Block& node) { Push(node.Statements); }
+	void Visit(Break&) {}
+	void Visit(Call& node) { Push(node.Args); Push(node.Callee); }
+	void Visit(ClassDefinition& node) { Push(node.Private); Push(node.Protected); Push(node.Public); }
+	void Visit(ClassType&) {}
+
+	void Visit(ConditionFor& node)
+	{
+		Push(node.ExecBlock);
+		Push(node.Condition.Increment);
+		Push(node.Condition.Condition);
+		std::visit([this](auto init) { Push(init); }, node.Condition.Initializer);
+	}
+
+	void Visit(Constructor& node) { Push(node.ExecBlock); Push(node.Params); }
+	void Visit(Continue&) {}
+	void Visit(EnumDefinition&) {}
+	void Visit(ExpressionStatement& node) { Push(node.Expr); }
+	void Visit(Function& node) { Push(node.ExecBlock); Push(node.ReturnType); Push(node.Params); }
+	void Visit(FunctionDefinition& node) { Push(node.Func); }
+	void Visit(FuncType& node) { Push(node.ReturnType); Push(node.ParamTypes); }
+	void Visit(Getter& node) { Push(node.ExecBlock); Push(node.GetType); }
+	void Visit(Group& node) { Push(node.Expr); }
+
+	void Visit(If& node)
+	{
+		Push(node.Else);
+		for (auto it = node.ElseIfs.rbegin(); it != node.ElseIfs.rend(); ++it)
+		{
+			Push(it->True);
+			Push(it->Condition);
+		}
+		Push(node.True);
+		Push(node.Condition);
+	}
+
+	void Visit(InitializerList& node) { Push(node.Data); }
+	void Visit(Literal&) {}
+	void Visit(Logical& node) { Push(node.Right); Push(node.Left); }
+	void Visit(Method& node) { Push(node.Def); }
+
+	void Visit(OperatorOverload& node)
+	{
+		Push(node.ExecBlock);
+		Push(node.ReturnType);
+
+		// A unary overload has one parameter, which the parser copies into both.
+		if (!node.IsUnary) { Push(node.Right.DataType); }
+		Push(node.Left.DataType);
+	}
+
+	void Visit(RangeFor& node) { Push(node.ExecBlock); Push(node.Condition.Range); }
+	void Visit(Return& node) { Push(node.Value); }
+	void Visit(Setter& node) { Push(node.ExecBlock); Push(node.SetParam.DataType); }
+	void Visit(SimpleType&) {}
+	void Visit(Throw& node) { Push(node.Value); }
+
+	void Visit(Try& node)
+	{
+		for (auto it = node.Catches.rbegin(); it != node.Catches.rend(); ++it)
+		{
+			Push(it->ExecBlock);
+			Push(it->Param.DataType);
+		}
+		Push(node.ExecBlock);
+	}
+
+	void Visit(TupleType& node) { Push(node.Types); }
+	void Visit(TypeOf& node) { Push(node.Expr); }
+	void Visit(Unary& node) { Push(node.Right); }
+	void Visit(VarAccess&) {}
+	void Visit(VarDefinition& node) { Push(node.Value); Push(node.DataType); }
+	void Visit(While& node) { Push(node.ExecBlock); Push(node.Condition); }
+
+private:
+	void Push(Statement* node) { if (node) { m_Stack.push_back({ node, false }); } }
+	void Push(Expression* node) { if (node) { m_Stack.push_back({ node, false }); } }
+	void Push(Type* node) { if (node) { m_Stack.push_back({ node, false }); } }
+
+	template<typename T>
+	void Push(const std::vector<T*>& nodes)
+	{
+		for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) { Push(*it); }
+	}
+
+	template<typename T, uint32_t N>
+	void Push(const SmallVector<T*, N>& nodes)
+	{
+		for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) { Push(*it); }
+	}
+
+	void Push(const SmallVector<Parameter, 4>& params)
+	{
+		for (auto it = params.rbegin(); it != params.rend(); ++it) { Push(it->DataType); }
+	}
+
+	std::vector<Entry>& m_Stack;
+};
+
+}
+
+ASTTraversal::ASTTraversal(Order order, PruneFunction prune)
+	: m_Order(order), m_Prune(std::move(prune))
+{}
+
+void ASTTraversal::Reset(Module& module)
+{
+	m_Stack.clear();
+	m_Pending = false;
+
+	for (auto it = module.Definitions.rbegin(); it != module.Definitions.rend(); ++it)
+	{
+		if (it->Def) { m_Stack.push_back({ it->Def, false }); }
+	}
+}
+
+void ASTTraversal::Reset(const ASTNode& root)
+{
+	m_Stack.clear();
+	m_Pending = false;
+	m_Stack.push_back({ root, false });
+}
+
+bool ASTTraversal::Next()
+{
+	if (m_Order == Order::PreOrder)
+	{
+		// The children of the last node are pushed only now, so that they can still be skipped.
+		if (m_Pending && !m_Skip) { PushChildren(m_Node); }
+		m_Pending = false;
+		m_Skip = false;
+
+		if (m_Stack.empty()) { return false; }
+
+		m_Node = m_Stack.back().Node;
+		m_Stack.pop_back();
+		m_Pending = !m_Prune || !m_Prune(m_Node);
+		return true;
+	}
+
+	while (!m_Stack.empty())
+	{
+		auto& top = m_Stack.back();
+		if (top.Expanded)
+		{
+			m_Node = top.Node;
+			m_Stack.pop_back();
+			return true;
+		}
+
+		top.Expanded = true;
+		ASTNode node = top.Node;
+		if (!m_Prune || !m_Prune(node)) { PushChildren(node); }
+	}
+
+	return false;
+}
+
+void ASTTraversal::PushChildren(const ASTNode& node)
+{
+	ChildPusher<Entry> pusher(m_Stack);
+	std::visit([&pusher](auto n) { pusher.Dispatch(*n); }, node);
+}
+
+}
@@ -0,0 +1,639 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Parser/FlatAST.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "Parser/StaticVisitor.h"
+
+namespace Wave {
+
+namespace {
+
+/// Builds the flat form of a module from a worklist, children first.
+/// A node is visited twice: first to queue its children, and then, once they are built,
+/// to build its own record from their indexes, which are left on top of m_Built in order.
+class ModuleFlattener : public StaticVisitor<ModuleFlattener>
+{
+public:
+	FlatModule Flatten(const Module& module)
+	{
+		// Every node of the module is in its arena, along with anything else allocated there.
+		m_Flat.Reserve(module.Nodes.GetObjectCount());
+
+		for (auto& def : module.Definitions) { Push(def.Def); }
+		Run();
+
+		auto defs = Take(module.Definitions.size());
+		for (size_t i = 0; i < module.Definitions.size(); i++)
+		{
+			m_Flat.AddDefinition({ defs[i], module.Definitions[i].Exported });
+		}
+
+		return std::move(m_Flat);
+	}
+
+	void Visit(Abstract& node)
+	{
+		if (m_Expanding) { return Expand(node.Params, node.ReturnType); }
+
+		auto children = Take(node.Params.size() + 1);
+		FlatAST::Abstract record;
+		record.Ident = node.Definition::Ident;
+		record.OwnIdent = node.Ident;
+		record.Params = AddParams(node.Params, children);
+		record.ReturnType = children[node.Params.size()];
+		record.IsReturnConst = node.IsReturnConst;
+		record.IsConst = node.IsConst;
+		Add(record);
+	}
+
+	void Visit(ArrayIndex& node)
+	{
+		if (m_Expanding) { return Expand(node.Index); }
+
+		auto children = Take(1);
+		FlatAST::ArrayIndex record;
+		record.Var = AddIdentifier(node.Var);
+		record.IsCopy = node.IsCopy;
+		record.Index = children[0];
+		Add(record);
+	}
+
+	void Visit(ArrayType& node)
+	{
+		if (m_Expanding) { return Expand(node.HoldType, node.Size); }
+
+		auto children = Take(2);
+		FlatAST::ArrayType record;
+		record.Tok = node.Tok;
+		record.HoldType = children[0];
+		record.Size = children[1];
+		Add(record);
+	}
+
+	void Visit(Assignment& node)
+	{
+		if (m_Expanding) { return Expand(node.Value); }
+
+		auto children = Take(1);
+		FlatAST::Assignment record;
+		record.Var = AddIdentifier(node.Var);
+		record.Value = children[0];
+		Add(record);
+	}
+
+	void Visit(Binary& node)
+	{
+		if (m_Expanding) { return Expand(node.Left, node.Right); }
+
+		auto children = Take(2);
+		FlatAST::Binary record;
+		record.Left = children[0];
+		record.Operator = node.Operator;
+		record.Right = children[1];
+		Add(record);
+	}
+
+	void Visit(Block& node)
+	{
+		if (m_Expanding) { return Expand(node.Statements); }
+
+		auto children = Take(node.Statements.size());
+		FlatAST::Block record;
+		record.Statements = m_Flat.AddList(children, node.Statements.size());
+		Add(record);
+	}
+
+	void Visit(Break&)
+	{
+		if (!m_Expanding) { Add(FlatAST::Break()); }
+	}
+
+	void Visit(Call& node)
+	{
+		if (m_Expanding) { return Expand(node.Callee, node.Args); }
+
+		auto children = Take(node.Args.size() + 1);
+		FlatAST::Call record;
+		record.Callee = children[0];
+		record.Args = m_Flat.AddList(children + 1, node.Args.size());
+		Add(record);
+	}
+
+	void Visit(ClassDefinition& node)
+	{
+		if (m_Expanding) { return Expand(node.Public, node.Protected, node.Private); }
+
+		auto children = Take(node.Public.size() + node.Protected.size() + node.Private.size());
+		FlatAST::ClassDefinition record;
+		record.Ident = node.Ident;
+
+		std::vector<FlatAST::Identifier> bases;
+		for (auto& base : node.Bases) { bases.push_back(AddIdentifier(base)); }
+		record.Bases = m_Flat.AddList(bases.data(), bases.size());
+
+		record.Public = m_Flat.AddList(children, node.Public.size());
+		children += node.Public.size();
+		record.Protected = m_Flat.AddList(children, node.Protected.size());
+		children += node.Protected.size();
+		record.Private = m_Flat.AddList(children, node.Private.size());
+		Add(record);
+	}
+
+	void Visit(ClassType& node)
+	{
+		if (m_Expanding) { return; }
+
+		FlatAST::ClassType record;
+		record.Tok = node.Tok;
+		record.Ident = AddIdentifier(node.Ident);
+		Add(record);
+	}
+
+	void Visit(ConditionFor& node)
+	{
+		if (m_Expanding)
+		{
+			std::visit([this](auto init) { Push(init); }, node.Condition.Initializer);
+			return Expand(node.Condition.Condition, node.Condition.Increment, node.ExecBlock);
+		}
+
+		auto children = Take(4);
+		FlatAST::ConditionFor record;
+		record.Initializer = children[0];
+		record.Condition = children[1];
+		record.Increment = children[2];
+		record.ExecBlock = children[3];
+		Add(record);
+	}
+
+	void Visit(Constructor& node)
+	{
+		if (m_Expanding) { return Expand(node.Params, node.ExecBlock); }
+
+		auto children = Take(node.Params.size() + 1);
+		FlatAST::Constructor record;
+		record.Ident = node.Ident;
+		record.Params = AddParams(node.Params, children);
+		record.ExecBlock = children[node.Params.size()];
+		Add(record);
+	}
+
+	void Visit(Continue&)
+	{
+		if (!m_Expanding) { Add(FlatAST::Continue()); }
+	}
+
+	void Visit(EnumDefinition& node)
+	{
+		if (m_Expanding) { return; }
+
+		FlatAST::EnumDefinition record;
+		record.Ident = node.Ident;
+		record.Elements = m_Flat.AddList(node.Elements.data(), node.Elements.size());
+		Add(record);
+	}
+
+	void Visit(ExpressionStatement& node)
+	{
+		if (m_Expanding) { return Expand(node.Expr); }
+
+		FlatAST::ExpressionStatement record;
+		record.Expr = Take(1)[0];
+		Add(record);
+	}
+
+	void Visit(Function& node)
+	{
+		if (m_Expanding) { return Expand(node.Params, node.ReturnType, node.ExecBlock); }
+
+		auto children = Take(node.Params.size() + 2);
+		FlatAST::Function record;
+		record.Params = AddParams(node.Params, children);
+		record.ReturnType = children[node.Params.size()];
+		record.IsReturnConst = node.IsReturnConst;
+		record.IsVariadic = node.IsVariadic;
+		record.ExecBlock = children[node.Params.size() + 1];
+		Add(record);
+	}
+
+	void Visit(FunctionDefinition& node)
+	{
+		if (m_Expanding) { return Expand(node.Func); }
+
+		FlatAST::FunctionDefinition record;
+		record.Ident = node.Ident;
+		record.Func = Take(1)[0];
+		Add(record);
+	}
+
+	void Visit(FuncType& node)
+	{
+		if (m_Expanding) { return Expand(node.ReturnType, node.ParamTypes); }
+
+		auto children = Take(node.ParamTypes.size() + 1);
+		FlatAST::FuncType record;
+		record.Tok = node.Tok;
+		record.ReturnType = children[0];
+		record.ParamTypes = m_Flat.AddList(children + 1, node.ParamTypes.size());
+		Add(record);
+	}
+
+	void Visit(Getter& node)
+	{
+		if (m_Expanding) { return Expand(node.GetType, node.ExecBlock); }
+
+		auto children = Take(2);
+		FlatAST::Getter record;
+		record.Ident = node.Definition::Ident;
+		record.OwnIdent = node.Ident;
+		record.GetType = children[0];
+		record.ExecBlock = children[1];
+		Add(record);
+	}
+
+	void Visit(Group& node)
+	{
+		if (m_Expanding) { return Expand(node.Expr); }
+
+		FlatAST::Group record;
+		record.Expr = Take(1)[0];
+		Add(record);
+	}
+
+	void Visit(If& node)
+	{
+		if (m_Expanding)
+		{
+			Push(node.Condition);
+			Push(node.True);
+			for (auto& elseIf : node.ElseIfs)
+			{
+				Push(elseIf.Condition);
+				Push(elseIf.True);
+			}
+			return Expand(node.Else);
+		}
+
+		auto children = Take(node.ElseIfs.size() * 2 + 3);
+		FlatAST::If record;
+		record.Condition = children[0];
+		record.True = children[1];
+
+		std::vector<FlatAST::ElseIf> elseIfs(node.ElseIfs.size());
+		for (size_t i = 0; i < elseIfs.size(); i++) { elseIfs[i] = { children[i * 2 + 2], children[i * 2 + 3] }; }
+		record.ElseIfs = m_Flat.AddList(elseIfs.data(), elseIfs.size());
+
+		record.Else = children[node.ElseIfs.size() * 2 + 2];
+		Add(record);
+	}
+
+	void Visit(InitializerList& node)
+	{
+		if (m_Expanding) { return Expand(node.Data); }
+
+		FlatAST::InitializerList record;
+		record.Data = m_Flat.AddList(Take(node.Data.size()), node.Data.size());
+		Add(record);
+	}
+
+	void Visit(Literal& node)
+	{
+		if (m_Expanding) { return; }
+
+		FlatAST::Literal record;
+		record.Value = node.Value;
+		Add(record);
+	}
+
+	void Visit(Logical& node)
+	{
+		if (m_Expanding) { return Expand(node.Left, node.Right); }
+
+		auto children = Take(2);
+		FlatAST::Logical record;
+		record.Left = children[0];
+		record.Operator = node.Operator;
+		record.Right = children[1];
+		Add(record);
+	}
+
+	void Visit(Method& node)
+	{
+		if (m_Expanding) { return Expand(node.Def); }
+
+		FlatAST::Method record;
+		record.Ident = node.Ident;
+		record.IsStatic = node.IsStatic;
+		record.IsConst = node.IsConst;
+		record.Def = Take(1)[0];
+		Add(record);
+	}
+
+	void Visit(OperatorOverload& node)
+	{
+		if (m_Expanding) { return Expand(node.Left.DataType, node.Right.DataType, node.ExecBlock, node.ReturnType); }
+
+		auto children = Take(4);
+		FlatAST::OperatorOverload record;
+		record.Ident = node.Ident;
+		record.Operator = node.Operator;
+		record.IsUnary = node.IsUnary;
+		record.Left = MakeParam(node.Left, children[0]);
+		record.Right = MakeParam(node.Right, children[1]);
+		record.ExecBlock = children[2];
+		record.ReturnType = children[3];
+		Add(record);
+	}
+
+	void Visit(RangeFor& node)
+	{
+		if (m_Expanding) { return Expand(node.Condition.Range, node.ExecBlock); }
+
+		auto children = Take(2);
+		FlatAST::RangeFor record;
+		record.Ident = node.Condition.Ident;
+		record.Range = children[0];
+		record.ExecBlock = children[1];
+		Add(record);
+	}
+
+	void Visit(Return& node)
+	{
+		if (m_Expanding) { return Expand(node.Value); }
+
+		FlatAST::Return record;
+		record.Value = Take(1)[0];
+		Add(record);
+	}
+
+	void Visit(Setter& node)
+	{
+		if (m_Expanding) { return Expand(node.SetParam.DataType, node.ExecBlock); }
+
+		auto children = Take(2);
+		FlatAST::Setter record;
+		record.Ident = node.Definition::Ident;
+		record.OwnIdent = node.Ident;
+		record.SetParam = MakeParam(node.SetParam, children[0]);
+		record.ExecBlock = children[1];
+		Add(record);
+	}
+
+	void Visit(SimpleType& node)
+	{
+		if (m_Expanding) { return; }
+
+		FlatAST::SimpleType record;
+		record.Tok = node.Tok;
+		record.T = node.T;
+		Add(record);
+	}
+
+	void Visit(Throw& node)
+	{
+		if (m_Expanding) { return Expand(node.Value); }
+
+		FlatAST::Throw record;
+		record.Value = Take(1)[0];
+		Add(record);
+	}
+
+	void Visit(Try& node)
+	{
+		if (m_Expanding)
+		{
+			Push(node.ExecBlock);
+			for (auto& c : node.Catches)
+			{
+				Push(c.ExecBlock);
+				Push(c.Param.DataType);
+			}
+			return Expand();
+		}
+
+		auto children = Take(node.Catches.size() * 2 + 1);
+		FlatAST::Try record;
+		record.ExecBlock = children[0];
+
+		std::vector<FlatAST::Catch> catches(node.Catches.size());
+		for (size_t i = 0; i < catches.size(); i++)
+		{
+			catches[i].ExecBlock = children[i * 2 + 1];
+			catches[i].Param = MakeParam(node.Catches[i].Param, children[i * 2 + 2]);
+		}
+		record.Catches = m_Flat.AddList(catches.data(), catches.size());
+		Add(record);
+	}
+
+	void Visit(TupleType& node)
+	{
+		if (m_Expanding) { return Expand(node.Types); }
+
+		FlatAST::TupleType record;
+		record.Tok = node.Tok;
+		record.Types = m_Flat.AddList(Take(node.Types.size()), node.Types.size());
+		Add(record);
+	}
+
+	void Visit(TypeOf& node)
+	{
+		if (m_Expanding) { return Expand(node.Expr); }
+
+		FlatAST::TypeOf record;
+		record.Tok = node.Tok;
+		record.Expr = Take(1)[0];
+		Add(record);
+	}
+
+	void Visit(Unary& node)
+	{
+		if (m_Expanding) { return Expand(node.Right); }
+
+		FlatAST::Unary record;
+		record.Operator = node.Operator;
+		record.Right = Take(1)[0];
+		Add(record);
+	}
+
+	void Visit(VarAccess& node)
+	{
+		if (m_Expanding) { return; }
+
+		FlatAST::VarAccess record;
+		record.Var = AddIdentifier(node.Var);
+		record.IsCopy = node.IsCopy;
+		Add(record);
+	}
+
+	void Visit(VarDefinition& node)
+	{
+		if (m_Expanding) { return Expand(node.DataType, node.Value); }
+
+		auto children = Take(2);
+		FlatAST::VarDefinition record;
+		record.Ident = node.Ident;
+		record.VarType = node.VarType;
+		record.DataType = children[0];
+		record.Value = children[1];
+		Add(record);
+	}
+
+	void Visit(While& node)
+	{
+		if (m_Expanding) { return Expand(node.Condition, node.ExecBlock); }
+
+		auto children = Take(2);
+		FlatAST::While record;
+		record.Condition = children[0];
+		record.ExecBlock = children[1];
+		Add(record);
+	}
+
+private:
+	using Node = std::variant<Statement*, Expression*, Type*>;
+
+	struct Work
+	{
+		/// The node, or null for a missing child, which is built as NoNode.
+		Node N;
+		bool Expanded;
+	};
+
+	/// Visit the queued nodes until every one is built.
+	void Run()
+	{
+		// Children were queued in order, but are taken from the back.
+		std::reverse(m_Work.begin(), m_Work.end());
+
+		while (!m_Work.empty())
+		{
+			auto work = m_Work.back();
+			m_Work.pop_back();
+
+			bool missing = std::visit([](auto n) { return n == nullptr; }, work.N);
+			if (missing)
+			{
+				m_Built.push_back(NoNode);
+				continue;
+			}
+
+			// Interned types are shared, so they are built once.
+			auto type = std::get_if<Type*>(&work.N);
+			if (type && !work.Expanded)
+			{
+				auto built = m_Types.find(*type);
+				if (built != m_Types.end())
+				{
+					m_Built.push_back(built->second);
+					continue;
+				}
+			}
+
+			m_Expanding = !work.Expanded;
+			if (m_Expanding) { m_Work.push_back({ work.N, true }); }
+
+			m_Queued = m_Work.size();
+			std::visit([this](auto n) { Dispatch(*n); }, work.N);
+			if (type && work.Expanded) { m_Types.emplace(*type, m_Built.back()); }
+		}
+	}
+
+	void Push(Statement* node) { m_Work.push_back({ node, false }); }
+	void Push(Expression* node) { m_Work.push_back({ node, false }); }
+	void Push(Type* node) { m_Work.push_back({ node, false }); }
+
+	template<typename T>
+	void Push(const std::vector<T*>& nodes)
+	{
+		for (auto node : nodes) { Push(node); }
+	}
+
+	template<typename T, uint32_t N>
+	void Push(const SmallVector<T*, N>& nodes)
+	{
+		for (auto node : nodes) { Push(node); }
+	}
+
+	void Push(const SmallVector<Parameter, 4>& params)
+	{
+		for (auto& param : params) { Push(param.DataType); }
+	}
+
+	/// Queue the children of the node being expanded, after any already pushed.
+	template<typename... Children>
+	void Expand(const Children&... children)
+	{
+		(Push(children), ...);
+
+		// The children were pushed in order, so reverse them to visit them in order.
+		std::reverse(m_Work.begin() + m_Queued, m_Work.end());
+	}
+
+	/// Take the indexes of the last children built, which stay valid until the next Add.
+	const NodeIndex* Take(size_t count)
+	{
+		m_Taken = count;
+		return m_Built.data() + m_Built.size() - count;
+	}
+
+	template<typename T>
+	void Add(const T& record)
+	{
+		m_Built.resize(m_Built.size() - m_Taken);
+		m_Taken = 0;
+		m_Built.push_back(m_Flat.Add(record));
+	}
+
+	FlatAST::Parameter MakeParam(const Parameter& param, NodeIndex type)
+	{
+		FlatAST::Parameter record;
+		record.Ident = param.Ident;
+		record.DataType = type;
+		record.IsConst = param.IsConst;
+		return record;
+	}
+
+	FlatAST::Range<FlatAST::Parameter> AddParams(const SmallVector<Parameter, 4>& params, const NodeIndex* types)
+	{
+		std::vector<FlatAST::Parameter> records;
+		for (size_t i = 0; i < params.size(); i++) { records.push_back(MakeParam(params[i], types[i])); }
+		return m_Flat.AddList(records.data(), records.size());
+	}
+
+	FlatAST::Identifier AddIdentifier(const Identifier& identifier)
+	{
+		return m_Flat.AddList(identifier.Path.data(), identifier.Path.size());
+	}
+
+	FlatModule m_Flat;
+	std::vector<Work> m_Work;
+	std::vector<NodeIndex> m_Built;
+	std::unordered_map<const Type*, NodeIndex> m_Types;
+	size_t m_Queued = 0;
+	size_t m_Taken = 0;
+	bool m_Expanding = false;
+};
+
+}
+
+FlatModule FlattenModule(const Module& module)
+{
+	return ModuleFlattener().Flatten(module);
+}
+
+}
@@ -0,0 +1,41 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "NodeCounter.h"
+
+#include <iterator>
+
+#include "Parser/ASTTraversal.h"
+
+namespace Wave {
+
+uint64_t CountNodes(Module& module, Statistics& stats)
+{
+	uint64_t counts[static_cast<size_t>(NodeKind::Count)] = {};
+
+	ASTTraversal walk(ASTTraversal::Order::PreOrder);
+	walk.Reset(module);
+	for (ASTNode node : walk) { counts[static_cast<size_t>(GetKind(node))]++; }
+
+	uint64_t total = 0;
+	for (size_t i = 0; i < std::size(counts); i++)
+	{
+		if (counts[i]) { stats.Add("AST nodes", GetNodeKindName(static_cast<NodeKind>(i)), counts[i]); }
+		total += counts[i];
+	}
+
+	return total;
+}
+
+}
@@ -0,0 +1,31 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "WaveCompiler/Parser/AST.h"
+#include "WaveCompiler/Statistics.h"
+
+namespace Wave {
+
+/// Count the nodes of a module's AST by kind, and add them to the statistics.
+/// Walks the tree, so it costs nothing unless statistics are enabled.
+///
+/// \param module The module.
+/// \param stats The statistics to add to.
+/// 
+/// \return The number of nodes.
+uint64_t CountNodes(Module& module, Statistics& stats);
+
+}
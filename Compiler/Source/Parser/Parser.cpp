@@ -16,45 +16,163 @@
 
 #include <iostream>
 
+#include "MemoryTracker.h"
+#include "NodeCounter.h"
+
 namespace Wave {
 
+namespace {
+
+/// How tightly a binary operator binds to its operands.
+enum class Precedence : uint8_t
+{
+	None, Assignment, Or, And, Equality, Comparison, Term, Factor
+};
+
+/// A binary operator.
+struct BinaryOperator
+{
+	TokenType Type;
+	Precedence Prec;
+};
+
+constexpr BinaryOperator BinaryOperators[] =
+{
+	{ TokenType::Equal, Precedence::Assignment },
+	{ TokenType::Or, Precedence::Or },
+	{ TokenType::And, Precedence::And },
+	{ TokenType::EqualEqual, Precedence::Equality },
+	{ TokenType::NotEqual, Precedence::Equality },
+	{ TokenType::Greater, Precedence::Comparison },
+	{ TokenType::GreaterEqual, Precedence::Comparison },
+	{ TokenType::Lesser, Precedence::Comparison },
+	{ TokenType::LesserEqual, Precedence::Comparison },
+	{ TokenType::Minus, Precedence::Term },
+	{ TokenType::Plus, Precedence::Term },
+	{ TokenType::Slash, Precedence::Factor },
+	{ TokenType::Star, Precedence::Factor },
+	{ TokenType::Percentage, Precedence::Factor }
+};
+
+/// Precedence of every token type, None if it is not a binary operator.
+struct PrecedenceTable
+{
+	Precedence Types[static_cast<uint8_t>(TokenType::Null) + 1] = {};
+};
+
+constexpr PrecedenceTable BuildPrecedenceTable()
+{
+	PrecedenceTable table;
+	for (auto& op : BinaryOperators)
+	{
+		table.Types[static_cast<uint8_t>(op.Type)] = op.Prec;
+	}
+
+	return table;
+}
+
+constexpr PrecedenceTable s_Precedences = BuildPrecedenceTable();
+
+/// Deepest nesting of expressions the parser accepts.
+constexpr uint32_t MaxExpressionDepth = 1024;
+
+}
+
 Parser::Parser(CompileContext& context, const Lexer& lexer)
-	: m_Context(context), m_Tokens(lexer.GetTokens())
+	: m_Context(context), m_Lexer(lexer), m_Tokens(&lexer.GetTokens())
 {
 	m_Module = std::make_unique<Module>();
 	m_Module->FilePath = lexer.GetPath();
+	m_OperatorSymbol = context.GetSymbols().Intern("op");
+}
+
+Parser::Parser(CompileContext& context, TokenStream& stream)
+	: m_Context(context), m_Lexer(stream.GetLexer()), m_Stream(&stream)
+{
+	m_Module = std::make_unique<Module>();
+	m_Module->FilePath = m_Lexer.GetPath();
+	m_OperatorSymbol = context.GetSymbols().Intern("op");
 }
 
 void Parser::Parse()
 {
-	if (m_Tokens.size() == 1)
+	ScopedTimer timer(m_Context.GetTimers(), "Parse", m_Lexer.GetFile());
+	ScopedMemoryPhase phase(MemoryPhase::Parser);
+
+	if (GetToken(0).Type == TokenType::Null)
 	{
 		m_Diagnostics.emplace_back(
-			m_Tokens[0].Marker,
+			GetToken(0).GetMarker(),
 			DiagnosticSeverity::Error,
 			"file is empty"
 		);
+		m_Module->Literals = m_Lexer.GetLiterals();
+		if (m_Context.GetStatistics().IsEnabled()) { RecordStatistics(); }
 		return;
 	}
 
-	try
+	// Module definition.
+	if (Check(TokenType::Module))
 	{
-		// Module definitions.
-		Ensure(TokenType::Module, "expected module definition");
 		m_Module->Def = ParseIdentifier();
 		Ensure(TokenType::Semicolon, "expected semicolon ';'");
+		if (m_Panic) { SynchronizeDefinition(0); }
+	}
+	else
+	{
+		// Carry on, so the rest of the file is still checked.
+		m_Diagnostics.emplace_back(
+			GetOffending().GetMarker(),
+			DiagnosticSeverity::Error,
+			"expected module definition"
+		);
+	}
 
-		while (Check(TokenType::Import))
+	auto start = m_Tok;
+	while (Check(TokenType::Import))
+	{
+		ParseImport();
+		if (m_Panic) { SynchronizeDefinition(start); }
+		start = m_Tok;
+	}
+
+	while (IsGood())
+	{
+		Release();
+		start = m_Tok;
+		ScopedTimer timer(m_Context.GetTimers(), "Parse definition");
+		auto def = ParseGlobalDefinition();
+
+		// Definitions which failed to parse are dropped.
+		if (m_Panic)
 		{
-			ParseImport();
+			SynchronizeDefinition(start);
+			continue;
 		}
 
-		while (IsGood())
+		m_Module->Definitions.emplace_back(def);
+		if (m_Context.GetTimers().IsTraceEnabled())
 		{
-			m_Module->Definitions.emplace_back(ParseGlobalDefinition());
+			timer.SetDetail(m_Context.GetSymbols().GetString(static_cast<Symbol>(def.Def->Ident.Value)));
 		}
 	}
-	catch (...) {}
+
+	// Number literals are only complete once the lexer has reached the end of the file.
+	m_Module->Literals = m_Lexer.GetLiterals();
+	if (m_Context.GetStatistics().IsEnabled()) { RecordStatistics(); }
+	if (MemoryTracker::IsEnabled()) { MemoryTracker::AddItems(MemoryPhase::Parser, m_Module->Nodes.GetObjectCount()); }
+}
+
+void Parser::RecordStatistics()
+{
+	auto& stats = m_Context.GetStatistics();
+	stats.Add("Parser", "Files parsed");
+	stats.Add("Parser", "AST nodes", CountNodes(*m_Module, stats));
+	stats.Add("Parser", "Arena objects", m_Module->Nodes.GetObjectCount());
+	stats.Add("Parser", "Arena bytes", m_Module->Nodes.GetBytesUsed());
+	stats.Add("Parser", "Interned types", m_Module->Types.GetTypeCount());
+	stats.Add("Parser", "Token rewinds", m_Rewinds);
+	stats.Add("Parser", "Function lookaheads", m_FunctionLookaheads);
 }
 
 const std::vector<Wave::Diagnostic>& Parser::GetDiagnostics()
@@ -91,23 +209,20 @@ void Parser::ParseImport()
 	}
 	else
 	{
-		try
-		{
-			auto& str = Ensure(TokenType::String, "expected string");
-			CImport imp;
-			imp.Path = str;
-			m_Module->CImports.emplace_back(imp);
-		}
-		catch (...)
+		auto str = Ensure(TokenType::String, "expected string");
+		if (m_Panic)
 		{
 			m_Diagnostics.emplace_back(
-				m_Tokens[m_Tok - 2].Marker,
+				Previous().GetMarker(),
 				DiagnosticSeverity::Note,
 				"to import a Wave module, remove 'extern'"
 			);
-			while (!Check(TokenType::Semicolon)) { Advance(); }
 			return;
 		}
+
+		CImport imp;
+		imp.Path = str;
+		m_Module->CImports.emplace_back(imp);
 	}
 
 	Ensure(TokenType::Semicolon, "expected semicolon ';'");
@@ -122,9 +237,9 @@ GlobalDefinition Parser::ParseGlobalDefinition()
 	return def;
 }
 
-up<Definition> Parser::ParseDefinition()
+Definition* Parser::ParseDefinition()
 {
-	auto& tok = Advance();
+	auto tok = Advance();
 
 	switch (tok.Type)
 	{
@@ -135,27 +250,23 @@ up<Definition> Parser::ParseDefinition()
 	case TokenType::Const:
 	case TokenType::Static: return ParseVarDefinition();
 	default:
-		m_Diagnostics.emplace_back(
-			tok.Marker,
-			DiagnosticSeverity::Error,
-			"expected definition (var, func, enum, or class)"
-		);
-		throw -1;
+		Error(tok, "expected definition (var, func, enum, or class)");
+		return nullptr;
 	}
 }
 
-up<FunctionDefinition> Parser::ParseFunctionDefinition()
+FunctionDefinition* Parser::ParseFunctionDefinition()
 {
-	auto def = std::make_unique<FunctionDefinition>();
+	auto def = Make<FunctionDefinition>();
 	def->Ident = Ensure(TokenType::Identifier, "expected function name identifier");
 	def->Func = ParseFunction();
 
 	return def;
 }
 
-up<VarDefinition> Parser::ParseVarDefinition()
+VarDefinition* Parser::ParseVarDefinition()
 {
-	auto def = std::make_unique<VarDefinition>();
+	auto def = Make<VarDefinition>();
 	def->VarType = Previous();
 	def->Ident = Ensure(TokenType::Identifier, "expected variable name identifier");
 
@@ -173,7 +284,7 @@ up<VarDefinition> Parser::ParseVarDefinition()
 	else if (!hasType)
 	{
 		m_Diagnostics.emplace_back(
-			Previous().Marker,
+			Previous().GetMarker(),
 			DiagnosticSeverity::Error,
 			"type can only be omitted if variable is initialized"
 		);
@@ -183,9 +294,9 @@ up<VarDefinition> Parser::ParseVarDefinition()
 	return def;
 }
 
-up<ClassDefinition> Parser::ParseClassDefinition()
+ClassDefinition* Parser::ParseClassDefinition()
 {
-	auto def = std::make_unique<ClassDefinition>();
+	auto def = Make<ClassDefinition>();
 	def->Ident = Ensure(TokenType::Identifier, "expected class name identifier");
 
 	if (Check(TokenType::Colon))
@@ -198,79 +309,63 @@ up<ClassDefinition> Parser::ParseClassDefinition()
 
 	Ensure(TokenType::LeftBrace, "expected definition block");
 
-	std::vector<up<Definition>>* emplacer = &def->Public;
-	while (!Check(TokenType::RightBrace))
+	std::vector<Definition*>* emplacer = &def->Public;
+	while (!Check(TokenType::RightBrace) && IsGood())
 	{
+		auto start = m_Tok;
+
 		if (Check(TokenType::Public)) { Ensure(TokenType::Colon, "expected colon ':'");  emplacer = &def->Public; }
 		else if (Check(TokenType::Protected)) { Ensure(TokenType::Colon, "expected colon ':'"); emplacer = &def->Protected; }
 		else if (Check(TokenType::Private)) { Ensure(TokenType::Colon, "expected colon ':'") ; emplacer = &def->Private; }
 
-		if (Check(TokenType::Variable)) { emplacer->emplace_back(ParseVarDefinition()); }
+		Definition* member = nullptr;
+		if (Check(TokenType::Variable)) { member = ParseVarDefinition(); }
 		else if (Check(TokenType::Static) || Check(TokenType::Const))
 		{
-			auto& prev = Previous();
-			auto& curr = m_Tokens[m_Tok];
+			auto prev = Previous();
+			auto curr = Peek();
 
-			if (Check(TokenType::Identifier))
+			if (curr.Type == TokenType::Identifier && curr.Value == m_OperatorSymbol)
 			{
-				if (std::get<std::string>(Previous().Value) == "op") { emplacer->emplace_back(ParseOperator()); continue; }
-				else { m_Tok--; }
+				Advance();
+				member = ParseOperator();
 			}
-
-			if (prev.Type == TokenType::Const && curr.Type == TokenType::Static
+			else if (prev.Type == TokenType::Const && curr.Type == TokenType::Static
 				|| prev.Type == TokenType::Static && curr.Type == TokenType::Const)
 			{
-				m_Diagnostics.emplace_back(
-					Previous().Marker,
-					DiagnosticSeverity::Error,
-					"function cannot be marked static and const"
-				);
-				throw -1;
+				Error(prev, "function cannot be marked static and const");
 			}
-
-			if (Check(TokenType::Function)) { emplacer->emplace_back(ParseMethod()); }
+			else if (Check(TokenType::Function)) { member = ParseMethod(); }
 			else if (Check(TokenType::Abstract))
 			{
-				if (m_Tokens[m_Tok - 2].Type == TokenType::Static)
-				{
-					m_Diagnostics.emplace_back(
-						Previous().Marker,
-						DiagnosticSeverity::Error,
-						"function cannot be marked static and abstract"
-					);
-					throw - 1;
-				}
-				emplacer->emplace_back(ParseAbstract());
+				if (prev.Type == TokenType::Static) { Error(Previous(), "function cannot be marked static and abstract"); }
+				else { member = ParseAbstract(); }
 			}
 			else
 			{
-				emplacer->emplace_back(ParseVarDefinition());
+				member = ParseVarDefinition();
 			}
 		}
-		else if (Check(TokenType::Class)) { emplacer->emplace_back(ParseClassDefinition()); }
-		else if (Check(TokenType::Enum)) { emplacer->emplace_back(ParseEnumDefinition()); }
-		else if (Check(TokenType::Function)) { emplacer->emplace_back(ParseMethod()); }
-		else if (Check(TokenType::Abstract)) { emplacer->emplace_back(ParseAbstract()); }
-		else if (Check(TokenType::Construct)) { emplacer->emplace_back(ParseConstructor()); }
-		else if (Check(TokenType::Identifier)) { emplacer->emplace_back(ParseGetterOrSetter()); }
-		else
-		{
-			m_Diagnostics.emplace_back(
-				Previous().Marker,
-				DiagnosticSeverity::Error,
-				"expected definition in class"
-			);
-			throw -1;
-		}
+		else if (Check(TokenType::Class)) { member = ParseClassDefinition(); }
+		else if (Check(TokenType::Enum)) { member = ParseEnumDefinition(); }
+		else if (Check(TokenType::Function)) { member = ParseMethod(); }
+		else if (Check(TokenType::Abstract)) { member = ParseAbstract(); }
+		else if (Check(TokenType::Construct)) { member = ParseConstructor(); }
+		else if (Check(TokenType::Identifier)) { member = ParseGetterOrSetter(); }
+		else { Error(Previous(), "expected definition in class"); }
+
+		// Members which failed to parse are dropped, and the rest of the class is still parsed.
+		if (m_Panic) { SynchronizeDefinition(start); }
+		else { emplacer->emplace_back(member); }
 	}
 
 	Ensure(TokenType::Semicolon, "expected semicolon ';'");
 	return def;
 }
 
-up<EnumDefinition> Parser::ParseEnumDefinition()
+EnumDefinition* Parser::ParseEnumDefinition()
 {
-	auto en = std::make_unique<EnumDefinition>();
+	auto en = Make<EnumDefinition>();
 	en->Ident = Ensure(TokenType::Identifier, "expected enum name identifier");
 	Ensure(TokenType::LeftBrace, "expected block");
 	if (!Check(TokenType::RightBrace))
@@ -286,11 +381,11 @@ up<EnumDefinition> Parser::ParseEnumDefinition()
 	return en;
 }
 
-up<Method> Parser::ParseMethod()
+Method* Parser::ParseMethod()
 {
-	auto method = std::make_unique<Method>();
-	m_Tok--;
-	auto& f = Peek();
+	auto method = Make<Method>();
+	Rewind();
+	auto f = Peek();
 	
 	if (f.Type == TokenType::Const) { method->IsConst = true; }
 	else if (f.Type == TokenType::Static) { method->IsStatic = true; }
@@ -301,9 +396,9 @@ up<Method> Parser::ParseMethod()
 	return method;
 }
 
-up<Abstract> Parser::ParseAbstract()
+Abstract* Parser::ParseAbstract()
 {
-	auto abstract = std::make_unique<Abstract>();
+	auto abstract = Make<Abstract>();
 	abstract->IsConst = Previous().Type == TokenType::Const;
 	abstract->Ident = Ensure(TokenType::Identifier, "expected abstract function identifier");
 	Ensure(TokenType::LeftParenthesis, "expected opening parenthesis, '('");
@@ -326,12 +421,12 @@ up<Abstract> Parser::ParseAbstract()
 	return abstract;
 }
 
-up<Definition> Parser::ParseGetterOrSetter()
+Definition* Parser::ParseGetterOrSetter()
 {
-	auto& ident = Previous();
+	auto ident = Previous();
 	if (Check(TokenType::Colon))
 	{
-		auto getter = std::make_unique<Getter>();
+		auto getter = Make<Getter>();
 		getter->Ident = ident;
 		getter->GetType = ParseType();
 		getter->ExecBlock = ParseBlock();
@@ -340,7 +435,7 @@ up<Definition> Parser::ParseGetterOrSetter()
 	}
 	else if (Check(TokenType::LeftParenthesis))
 	{
-		auto setter = std::make_unique<Setter>();
+		auto setter = Make<Setter>();
 		setter->Ident = ident;
 		setter->SetParam = ParseParam();
 		Ensure(TokenType::RightParenthesis, "expected closing parenthesis ')'");
@@ -350,18 +445,14 @@ up<Definition> Parser::ParseGetterOrSetter()
 	}
 	else
 	{
-		m_Diagnostics.emplace_back(
-			ident.Marker,
-			DiagnosticSeverity::Error,
-			"expected getter or setter"
-		);
-		throw -1;
+		Error(ident, "expected getter or setter");
+		return nullptr;
 	}
 }
 
-up<OperatorOverload> Parser::ParseOperator()
+OperatorOverload* Parser::ParseOperator()
 {
-	auto op = std::make_unique<OperatorOverload>();
+	auto op = Make<OperatorOverload>();
 	op->Ident = Previous();
 	op->Operator = Advance();
 	if (op->Operator.Type != TokenType::Plus
@@ -377,12 +468,8 @@ up<OperatorOverload> Parser::ParseOperator()
 		&& op->Operator.Type != TokenType::Lesser
 		&& op->Operator.Type != TokenType::LesserEqual)
 	{
-		m_Diagnostics.emplace_back(
-			op->Operator.Marker,
-			DiagnosticSeverity::Error,
-			"cannot overload"
-		);
-		throw -1;
+		Error(op->Operator, "cannot overload");
+		return op;
 	}
 
 	Ensure(TokenType::LeftParenthesis, "expected opening parenthesis '('");
@@ -392,12 +479,8 @@ up<OperatorOverload> Parser::ParseOperator()
 	{
 		if (op->Operator.Type != TokenType::Minus && op->Operator.Type != TokenType::Not)
 		{
-			m_Diagnostics.emplace_back(
-				op->Operator.Marker,
-				DiagnosticSeverity::Error,
-				"only '-' and '!' are allowed unary overloads"
-			);
-			throw -1;
+			Error(op->Operator, "only '-' and '!' are allowed unary overloads");
+			return op;
 		}
 		op->Right = std::move(op->Left);
 	}
@@ -405,27 +488,24 @@ up<OperatorOverload> Parser::ParseOperator()
 	{
 		if (op->Operator.Type == TokenType::Not)
 		{
-			m_Diagnostics.emplace_back(
-				op->Operator.Marker,
-				DiagnosticSeverity::Error,
-				"'!' can only be overloaded as a unary"
-			);
-			throw -1;
+			Error(op->Operator, "'!' can only be overloaded as a unary");
+			return op;
 		}
 
 		op->Right = ParseParam();
 	}
 	Ensure(TokenType::RightParenthesis, "expected closing parenthesis, ')'");
+	if (m_Panic) { return op; }
 
-	try { Ensure(TokenType::Colon, "expected return type"); }
-	catch (...)
+	Ensure(TokenType::Colon, "expected return type");
+	if (m_Panic)
 	{
 		m_Diagnostics.emplace_back(
-			Previous().Marker,
+			GetOffending().GetMarker(),
 			DiagnosticSeverity::Note,
 			"operator overloads must have a return type"
 		);
-		throw;
+		return op;
 	}
 
 	op->ReturnType = ParseType();
@@ -433,9 +513,9 @@ up<OperatorOverload> Parser::ParseOperator()
 	return op;
 }
 
-up<Constructor> Parser::ParseConstructor()
+Constructor* Parser::ParseConstructor()
 {
-	auto construct = std::make_unique<Constructor>();
+	auto construct = Make<Constructor>();
 	Ensure(TokenType::LeftParenthesis, "expected opening parenthesis '('");
 	if (!Check(TokenType::RightParenthesis))
 	{
@@ -450,42 +530,18 @@ up<Constructor> Parser::ParseConstructor()
 	return construct;
 }
 
-up<Type> Parser::ParseType()
+Type* Parser::ParseType()
 {
-	auto& tok = Advance();
+	auto tok = Advance();
 
-	up<Type> type;
+	Type* type = nullptr;
 
 	switch (tok.Type)
 	{
-	case TokenType::IntegerType: 
-	{
-		auto t = std::make_unique<SimpleType>();
-		t->T = SimpleType::TypeType::Int;
-		type = std::move(t);
-		break;
-	}
-	case TokenType::RealType: 
-	{
-		auto t = std::make_unique<SimpleType>();
-		t->T = SimpleType::TypeType::Real;
-		type = std::move(t);
-		break;
-	}
-	case TokenType::CharType:
-	{
-		auto t = std::make_unique<SimpleType>();
-		t->T = SimpleType::TypeType::Char;
-		type = std::move(t);
-		break;
-	}
-	case TokenType::BoolType:
-	{
-		auto t = std::make_unique<SimpleType>();
-		t->T = SimpleType::TypeType::Bool;
-		type = std::move(t);
-		break;
-	}
+	case TokenType::IntegerType: type = m_Module->Types.GetSimple(SimpleType::TypeType::Int, tok); break;
+	case TokenType::RealType: type = m_Module->Types.GetSimple(SimpleType::TypeType::Real, tok); break;
+	case TokenType::CharType: type = m_Module->Types.GetSimple(SimpleType::TypeType::Char, tok); break;
+	case TokenType::BoolType: type = m_Module->Types.GetSimple(SimpleType::TypeType::Bool, tok); break;
 	case TokenType::Function: type = ParseFuncType(); break;
 	case TokenType::TypeOf: type = ParseTypeOf(); break;
 	case TokenType::Tuple: type = ParseTuple(); break;
@@ -494,254 +550,181 @@ up<Type> Parser::ParseType()
 		Ensure(TokenType::RightParenthesis, "expected closing parenthesis ')'");
 		break;
 	case TokenType::Identifier:
-	{
-		auto c = std::make_unique<ClassType>();
-		m_Tok--;
-		c->Ident = ParseIdentifier();
-		type = std::move(c);
+		Rewind();
+		type = m_Module->Types.GetClass(ParseIdentifier(), tok);
 		break;
-	}
 	default:
-		m_Diagnostics.emplace_back(
-			tok.Marker,
-			DiagnosticSeverity::Error,
-			"expected type"
-		);
-		throw -1;
+		Error(tok, "expected type");
+		return nullptr;
 	}
 
-	type->Tok = tok;
+	if (m_Panic) { return type; }
 
 	while (Check(TokenType::LeftIndex))
 	{
-		auto arr = std::make_unique<ArrayType>();
-		
-		if (!Check(TokenType::RightIndex)) 
-		{ 
-			arr->Size = ParseExpression(); 
-			Ensure(TokenType::RightIndex, "expected closing bracket ']'");
+		if (Check(TokenType::RightIndex)) 
+		{
+			type = m_Module->Types.GetArray(type, tok);
+			continue;
 		}
 
-		arr->HoldType = std::move(type);
-		type = std::move(arr);
+		// The size is an expression, so sized arrays are not interned.
+		auto arr = Make<ArrayType>();
+		arr->Tok = tok;
+		arr->Size = ParseExpression(); 
+		Ensure(TokenType::RightIndex, "expected closing bracket ']'");
+
+		arr->HoldType = type;
+		type = arr;
 	}
 
 	return type;
 }
 
-up<TypeOf> Parser::ParseTypeOf()
+TypeOf* Parser::ParseTypeOf()
 {
-	auto type = std::make_unique<TypeOf>();
+	auto type = Make<TypeOf>();
+	type->Tok = Previous();
 	type->Expr = ParseExpression();
 	return type;
 }
 
-up<TupleType> Parser::ParseTuple()
+TupleType* Parser::ParseTuple()
 {
-	auto tuple = std::make_unique<TupleType>();
-	tuple->Tok = Previous();
+	auto tok = Previous();
+	SmallVector<Type*, 4> types;
 	Ensure(TokenType::Lesser, "expected opening angle bracket '<'");
 	do
 	{
-		tuple->Types.emplace_back(ParseType());
+		types.emplace_back(ParseType());
 	} while (Check(TokenType::Comma));
 	Ensure(TokenType::Greater, "expected closing angle bracket '>'");
 
-	return tuple;
+	return m_Module->Types.GetTuple(types, tok);
 }
 
-up<FuncType> Parser::ParseFuncType()
+FuncType* Parser::ParseFuncType()
 {
-	auto type = std::make_unique<FuncType>();
+	auto tok = Previous();
+	SmallVector<Type*, 4> paramTypes;
+	Type* returnType = nullptr;
 
 	Ensure(TokenType::LeftParenthesis, "expected opening parenthesis '('");
 	if (!Check(TokenType::RightParenthesis))
 	{
 		do
 		{
-			type->ParamTypes.emplace_back(ParseType());
+			paramTypes.emplace_back(ParseType());
 		} while (Check(TokenType::Comma));
 		Ensure(TokenType::RightParenthesis, "expected closing parenthesis ')'");
 	}
 
 	if (Check(TokenType::Colon))
 	{
-		type->ReturnType = ParseType();
+		returnType = ParseType();
 	}
 
-	return type;
+	return m_Module->Types.GetFunc(paramTypes, returnType, tok);
 }
 
-up<Expression> Parser::ParseExpression()
+Expression* Parser::ParseExpression()
 {
-	return ParseAssignment();
-}
-
-up<Expression> Parser::ParseAssignment()
-{
-	auto expr = ParseOr();
-
-	if (Check(TokenType::Equal))
-	{
-		auto value = ParseAssignment();
-		auto assign = std::make_unique<Assignment>();
-		assign->Value = std::move(value);
-		auto var = dynamic_cast<VarAccess*>(expr.get());
-		if (var)
-		{
-			assign->Var = var->Var;
-			return assign;
-		}
-
-		m_Diagnostics.emplace_back(
-			Previous().Marker,
-			DiagnosticSeverity::Error,
-			"invalid assignment, can only assign to variables."
-		);
-	}
-
-	return expr;
-}
-
-up<Expression> Parser::ParseOr()
-{
-	auto expr = ParseAnd();
-
-	while (Check(TokenType::Or))
-	{
-		auto& op = Previous();
-		auto right = ParseAnd();
-		auto logic = std::make_unique<Logical>();
-
-		logic->Left = std::move(expr);
-		logic->Operator = op;
-		logic->Right = std::move(right);
-		expr = std::move(logic);
-	}
-
-	return expr;
-}
-
-up<Expression> Parser::ParseAnd()
-{
-	auto expr = ParseEquality();
-
-	while (Check(TokenType::And))
-	{
-		auto& op = Previous();
-		auto right = ParseEquality();
-		auto logic = std::make_unique<Logical>();
-
-		logic->Left = std::move(expr);
-		logic->Operator = op;
-		logic->Right = std::move(right);
-		expr = std::move(logic);
-	}
-
-	return expr;
+	return ParseBinary(static_cast<uint8_t>(Precedence::Assignment));
 }
 
-up<Expression> Parser::ParseEquality()
+Expression* Parser::ParseBinary(uint8_t precedence)
 {
-	auto expr = ParseComparision();
-
-	while (Check(TokenType::NotEqual) || Check(TokenType::EqualEqual))
+	// Operands are parsed by recursion, so limit it to keep from running out of stack.
+	if (m_ExpressionDepth == MaxExpressionDepth)
 	{
-		auto& op = Previous();
-		auto right = ParseComparision();
-		auto temp = std::make_unique<Binary>();
-
-		temp->Left = std::move(expr);
-		temp->Operator = op;
-		temp->Right = std::move(right);
-		expr = std::move(temp);
+		Error(GetOffending(), "expression is nested too deeply");
+		return nullptr;
 	}
+	m_ExpressionDepth++;
 
-	return expr;
-}
-
-up<Expression> Parser::ParseComparision()
-{
-	auto expr = ParseTerm();
+	auto expr = ParseUnary();
 
-	while (Check(TokenType::Greater) || Check(TokenType::GreaterEqual)
-		|| Check(TokenType::Lesser) || Check(TokenType::LesserEqual))
+	while (IsGood())
 	{
-		auto& op = Previous();
-		auto right = ParseTerm();
-		auto temp = std::make_unique<Binary>();
-
-		temp->Left = std::move(expr);
-		temp->Operator = op;
-		temp->Right = std::move(right);
-		expr = std::move(temp);
-	}
-
-	return expr;
-}
+		auto op = Peek();
+		auto opPrecedence = static_cast<uint8_t>(s_Precedences.Types[static_cast<uint8_t>(op.Type)]);
+		if (opPrecedence == 0 || opPrecedence < precedence) { break; }
+		Advance();
 
-up<Expression> Parser::ParseTerm()
-{
-	auto expr = ParseFactor();
+		if (op.Type == TokenType::Equal)
+		{
+			// Assignment is right-associative.
+			auto value = ParseBinary(opPrecedence);
+			if (expr && (expr->Kind == NodeKind::VarAccess || expr->Kind == NodeKind::ArrayIndex))
+			{
+				auto assign = Make<Assignment>();
+				assign->Var = std::move(static_cast<VarAccess*>(expr)->Var);
+				assign->Value = value;
+				expr = assign;
+				continue;
+			}
 
-	while (Check(TokenType::Minus) || Check(TokenType::Plus))
-	{
-		auto& op = Previous();
-		auto right = ParseFactor();
-		auto temp = std::make_unique<Binary>();
+			m_Diagnostics.emplace_back(
+				Previous().GetMarker(),
+				DiagnosticSeverity::Error,
+				"invalid assignment, can only assign to variables."
+			);
+			continue;
+		}
 
-		temp->Left = std::move(expr);
-		temp->Operator = op;
-		temp->Right = std::move(right);
-		expr = std::move(temp);
+		auto right = ParseBinary(opPrecedence + 1);
+		if (op.Type == TokenType::And || op.Type == TokenType::Or)
+		{
+			auto logic = Make<Logical>();
+			logic->Left = expr;
+			logic->Operator = op;
+			logic->Right = right;
+			expr = logic;
+		}
+		else
+		{
+			auto temp = Make<Binary>();
+			temp->Left = expr;
+			temp->Operator = op;
+			temp->Right = right;
+			expr = temp;
+		}
 	}
 
+	m_ExpressionDepth--;
 	return expr;
 }
 
-up<Expression> Parser::ParseFactor()
+Expression* Parser::ParseUnary()
 {
-	auto expr = ParseUnary();
-
-	while (Check(TokenType::Slash) || Check(TokenType::Star) || Check(TokenType::Percentage))
+	// Chains of prefix operators are built in a loop rather than by recursion.
+	Unary* outer = nullptr;
+	Unary* inner = nullptr;
+	while (Check(TokenType::Not) || Check(TokenType::Minus))
 	{
-		auto& op = Previous();
-		auto right = ParseUnary();
-		auto temp = std::make_unique<Binary>();
+		auto unary = Make<Unary>();
+		unary->Operator = Previous();
 
-		temp->Left = std::move(expr);
-		temp->Operator = op;
-		temp->Right = std::move(right);
-		expr = std::move(temp);
+		if (inner) { inner->Right = unary; }
+		else { outer = unary; }
+		inner = unary;
 	}
 
-	return expr;
-}
-
-up<Expression> Parser::ParseUnary()
-{
-	if (Check(TokenType::Not) || Check(TokenType::Minus))
-	{
-		auto& op = Previous();
-		auto right = ParseUnary();
-		auto temp = std::make_unique<Binary>();
-
-		temp->Operator = op;
-		temp->Right = std::move(right);
-		return temp;
-	}
+	auto operand = ParseCall();
+	if (!inner) { return operand; }
 
-	return ParseCall();
+	inner->Right = operand;
+	return outer;
 }
 
-up<Expression> Parser::ParseCall()
+Expression* Parser::ParseCall()
 {
 	auto callee = ParsePrimary();
 
 	if (Check(TokenType::LeftParenthesis))
 	{
-		auto call = std::make_unique<Call>();
-		call->Callee = std::move(callee);
+		auto call = Make<Call>();
+		call->Callee = callee;
 
 		if (!Check(TokenType::RightParenthesis))
 		{
@@ -759,60 +742,59 @@ up<Expression> Parser::ParseCall()
 	return callee;
 }
 
-up<Expression> Parser::ParsePrimary()
+Expression* Parser::ParsePrimary()
 {
 	if (Check(TokenType::True) || Check(TokenType::False)
 		|| Check(TokenType::Integer) || Check(TokenType::Real)
 		|| Check(TokenType::String))
 	{
-		auto literal = std::make_unique<Literal>();
+		auto literal = Make<Literal>();
 		literal->Value = Previous();
 		return literal;
 	}
 	else if (Check(TokenType::Identifier))
 	{
-		m_Tok--;
+		Rewind();
 
 		auto var = ParseIdentifier();
 		if (Check(TokenType::LeftIndex))
 		{
-			auto acc = std::make_unique<ArrayIndex>();
-			acc->Var = var;
+			auto acc = Make<ArrayIndex>();
+			acc->Var = std::move(var);
 			acc->Index = ParseExpression();
 			Ensure(TokenType::RightIndex, "expected closing bracket ']'");
 
 			return acc;
 		}
 
-		auto acc = std::make_unique<VarAccess>();
-		acc->Var = var;
+		auto acc = Make<VarAccess>();
+		acc->Var = std::move(var);
 		return acc;
 	}
 	else if (Check(TokenType::Copy))
 	{
-		auto& copy = Previous();
+		auto copy = Previous();
 
-		Identifier var;
-		try { var = ParseIdentifier(); }
-		catch (...)
+		auto var = ParseIdentifier();
+		if (m_Panic)
 		{
 			m_Diagnostics.emplace_back(
-				copy.Marker,
+				copy.GetMarker(),
 				DiagnosticSeverity::Note,
 				"can only only copy variables"
 			);
 			m_Diagnostics.emplace_back(
-				copy.Marker,
+				copy.GetMarker(),
 				DiagnosticSeverity::Note,
 				"consider removing 'copy'"
 			);
-			throw;
+			return nullptr;
 		}
 
 		if (Check(TokenType::LeftIndex))
 		{
-			auto acc = std::make_unique<ArrayIndex>();
-			acc->Var = var;
+			auto acc = Make<ArrayIndex>();
+			acc->Var = std::move(var);
 			acc->IsCopy = true;
 			acc->Index = ParseExpression();
 			Ensure(TokenType::RightIndex, "expected closing bracket ']'");
@@ -820,14 +802,14 @@ up<Expression> Parser::ParsePrimary()
 			return acc;
 		}
 
-		auto acc = std::make_unique<VarAccess>();
-		acc->Var = var;
+		auto acc = Make<VarAccess>();
+		acc->Var = std::move(var);
 		acc->IsCopy = true;
 		return acc;
 	}
 	else if (Check(TokenType::LeftBrace))
 	{
-		auto list = std::make_unique<InitializerList>();
+		auto list = Make<InitializerList>();
 		if (!Check(TokenType::RightBrace))
 		{
 			do
@@ -842,39 +824,54 @@ up<Expression> Parser::ParsePrimary()
 	{
 		if (IsFunction())
 		{
+			Rewind();
 			return ParseFunction();
 		}
 		else
 		{
 			auto expr = ParseExpression();
 			Ensure(TokenType::RightParenthesis, "expected closing parenthesis ')'");
-			auto group = std::make_unique<Group>();
-			group->Expr = std::move(expr);
+			auto group = Make<Group>();
+			group->Expr = expr;
 			return group;
 		}
 	}
 
-	m_Diagnostics.emplace_back(
-		Previous().Marker,
-		DiagnosticSeverity::Error,
-		"expected expression"
-	);
-	throw -1;
+	Error(Previous(), "expected expression");
+	return nullptr;
 }
 
 bool Parser::IsFunction()
 {
-	auto tok = m_Tok;
-	if (!Check(TokenType::Identifier) && !Check(TokenType::RightParenthesis)) { return false; }
-	while (!Check(TokenType::RightParenthesis)) { Advance(); }
-	if (Check(TokenType::Colon)) { m_Tok = tok; return true; }
-	else if (Check(TokenType::LeftBrace)) { m_Tok = tok - 1; return true; }
-	else { m_Tok = tok; return false; }
+	m_FunctionLookaheads++;
+
+	// A function starts with '()', '(param,' or '(param:', or is '(param)' followed by its body or return type.
+	// Nothing else can follow an opening parenthesis in a group, so a few tokens are enough to tell.
+	auto first = Peek().Type;
+	auto second = GetToken(m_Tok + 1).Type;
+
+	if (first == TokenType::RightParenthesis)
+	{
+		return second == TokenType::Colon || second == TokenType::LeftBrace;
+	}
+	if (first != TokenType::Identifier) { return false; }
+
+	switch (second)
+	{
+	case TokenType::Comma:
+	case TokenType::Colon: return true;
+	case TokenType::RightParenthesis:
+	{
+		auto third = GetToken(m_Tok + 2).Type;
+		return third == TokenType::Colon || third == TokenType::LeftBrace;
+	}
+	default: return false;
+	}
 }
 
-up<Function> Parser::ParseFunction()
+Function* Parser::ParseFunction()
 {
-	auto func = std::make_unique<Function>();
+	auto func = Make<Function>();
 
 	Ensure(TokenType::LeftParenthesis, "expected opening parenthesis '('");
 	if (!Check(TokenType::RightParenthesis))
@@ -890,12 +887,8 @@ up<Function> Parser::ParseFunction()
 				}
 				else
 				{
-					m_Diagnostics.emplace_back(
-						Previous().Marker,
-						DiagnosticSeverity::Error,
-						"expected variadic '...'"
-					);
-					throw - 1;
+					Error(Previous(), "expected variadic '...'");
+					return func;
 				}
 			}
 
@@ -907,16 +900,16 @@ up<Function> Parser::ParseFunction()
 	if (Check(TokenType::Colon))
 	{
 		func->IsReturnConst = Check(TokenType::Const);
-		auto& col = Previous();
-		try { func->ReturnType = ParseType(); }
-		catch (...)
+		auto col = Previous();
+		func->ReturnType = ParseType();
+		if (m_Panic)
 		{
 			m_Diagnostics.emplace_back(
-				col.Marker,
+				col.GetMarker(),
 				DiagnosticSeverity::Note,
 				"consider removing if function does not return any value"
 			);
-			throw;
+			return func;
 		}
 	}
 
@@ -935,25 +928,21 @@ Parameter Parser::ParseParam()
 		if (!Check(TokenType::Comma) && !Check(TokenType::RightParenthesis)) { param.DataType = ParseType(); }
 		else 
 		{ 
-			m_Tok--; 
-			auto t = std::make_unique<SimpleType>();
-			t->T = SimpleType::TypeType::Generic;
-			param.DataType = std::move(t);
+			Rewind();
+			param.DataType = m_Module->Types.GetSimple(SimpleType::TypeType::Generic);
 		}
 	}
 	else
 	{
-		auto t = std::make_unique<SimpleType>();
-		t->T = SimpleType::TypeType::Generic;
-		param.DataType = std::move(t);
+		param.DataType = m_Module->Types.GetSimple(SimpleType::TypeType::Generic);
 	}
 	return param;
 }
 
 
-up<Block> Parser::ParseBlock()
+Block* Parser::ParseBlock()
 {
-	auto block = std::make_unique<Block>();
+	auto block = Make<Block>();
 	Ensure(TokenType::LeftBrace, "expected block");
 	while (!Check(TokenType::RightBrace) && IsGood())
 	{
@@ -962,85 +951,82 @@ up<Block> Parser::ParseBlock()
 	return block;
 }
 
-up<Statement> Parser::ParseStatement()
+Statement* Parser::ParseStatement()
 {
-	try
+	Release();
+
+	auto start = m_Tok;
+	Statement* statement = nullptr;
+
+	if (IsDefinition()) { statement = ParseDefinition(); }
+	else if (Check(TokenType::While)) { statement = ParseWhile(); }
+	else if (Check(TokenType::For)) { statement = ParseFor(); }
+	else if (Check(TokenType::Return))
 	{
-		if (IsDefinition()) { return ParseDefinition(); }
-		else if (Check(TokenType::While)) { return ParseWhile(); }
-		else if (Check(TokenType::For)) { return ParseFor(); }
-		else if (Check(TokenType::Return))
-		{
-			auto ret = std::make_unique<Return>();
-			if (!Check(TokenType::Semicolon))
-			{
-				ret->Value = ParseExpression();
-				Ensure(TokenType::Semicolon, "expected semicolon ';'");
-			}
-			return ret;
-		}
-		else if (Check(TokenType::Break))
-		{
-			return std::make_unique<Break>();
-			Ensure(TokenType::Semicolon, "expected semicolon ';'");
-		}
-		else if (Check(TokenType::Continue))
+		auto ret = Make<Return>();
+		if (!Check(TokenType::Semicolon))
 		{
-			return std::make_unique<Continue>();
+			ret->Value = ParseExpression();
 			Ensure(TokenType::Semicolon, "expected semicolon ';'");
 		}
-		else if (Check(TokenType::LeftBrace)) { m_Tok--; return ParseBlock(); }
-		else if (Check(TokenType::If)) { return ParseIf(); }
-		else if (Check(TokenType::Try)) { return ParseTry(); }
-		else if (Check(TokenType::Throw))
-		{
-			auto thr = std::make_unique<Throw>();
-			if (!Check(TokenType::Semicolon))
-			{
-				thr->Value = ParseExpression();
-				Ensure(TokenType::Semicolon, "expected semicolon ';'");
-			}
-			return thr;
-		}
-		else
+		statement = ret;
+	}
+	else if (Check(TokenType::Break))
+	{
+		statement = Make<Break>();
+		Ensure(TokenType::Semicolon, "expected semicolon ';'");
+	}
+	else if (Check(TokenType::Continue))
+	{
+		statement = Make<Continue>();
+		Ensure(TokenType::Semicolon, "expected semicolon ';'");
+	}
+	else if (Check(TokenType::LeftBrace)) { Rewind(); statement = ParseBlock(); }
+	else if (Check(TokenType::If)) { statement = ParseIf(); }
+	else if (Check(TokenType::Try)) { statement = ParseTry(); }
+	else if (Check(TokenType::Throw))
+	{
+		auto thr = Make<Throw>();
+		if (!Check(TokenType::Semicolon))
 		{
-			auto expr = std::make_unique<ExpressionStatement>();
-			expr->Expr = ParseExpression();
+			thr->Value = ParseExpression();
 			Ensure(TokenType::Semicolon, "expected semicolon ';'");
-			return expr;
 		}
+		statement = thr;
+	}
+	else
+	{
+		auto expr = Make<ExpressionStatement>();
+		expr->Expr = ParseExpression();
+		Ensure(TokenType::Semicolon, "expected semicolon ';'");
+		statement = expr;
 	}
-	catch (...) 
+
+	// Statements which failed to parse are replaced by an empty one.
+	if (m_Panic)
 	{
-		while (!Check(TokenType::Semicolon) && IsGood()) { Advance(); }
+		SynchronizeStatement(start);
+		return Make<ExpressionStatement>();
 	}
 
-	return std::make_unique<ExpressionStatement>();
+	return statement;
 }
 
 
-up<While> Parser::ParseWhile()
+While* Parser::ParseWhile()
 {
-	auto loop = std::make_unique<While>();
+	auto loop = Make<While>();
 	loop->Condition = ParseExpression();
 	loop->ExecBlock = ParseBlock();
 	return loop;
 }
 
-up<Statement> Parser::ParseFor()
+Statement* Parser::ParseFor()
 {
-	auto tok = m_Tok;
-	bool isRange = false;
-	while (!Check(TokenType::LeftBrace)) 
-	{ 
-		isRange = (Advance().Type == TokenType::In);
-		if (isRange) { break; }
-	}
-	m_Tok = tok;
-
-	if (isRange)
+	// A range-based for loop starts with 'identifier in'.
+	if (Peek().Type == TokenType::Identifier && GetToken(m_Tok + 1).Type == TokenType::In)
 	{
-		auto loop = std::make_unique<RangeFor>();
+		auto loop = Make<RangeFor>();
 
 		ForRange range;
 		range.Ident = Ensure(TokenType::Identifier, "expected range-based for identifier");
@@ -1053,7 +1039,7 @@ up<Statement> Parser::ParseFor()
 	}
 	else
 	{
-		auto loop = std::make_unique<ConditionFor>();
+		auto loop = Make<ConditionFor>();
 
 		ForCond cond;
 		if (!Check(TokenType::Semicolon))
@@ -1083,9 +1069,9 @@ up<Statement> Parser::ParseFor()
 	}
 }
 
-up<If> Parser::ParseIf()
+If* Parser::ParseIf()
 {
-	auto ifs = std::make_unique<If>();
+	auto ifs = Make<If>();
 	ifs->Condition = ParseExpression();
 	ifs->True = ParseBlock();
 
@@ -1104,9 +1090,9 @@ up<If> Parser::ParseIf()
 	return ifs;
 }
 
-up<Try> Parser::ParseTry()
+Try* Parser::ParseTry()
 {
-	auto tryy = std::make_unique<Try>();
+	auto tryy = Make<Try>();
 	tryy->ExecBlock = ParseBlock();
 	while (Check(TokenType::Catch))
 	{
@@ -1118,7 +1104,7 @@ up<Try> Parser::ParseTry()
 	if (tryy->Catches.size() == 0)
 	{
 		m_Diagnostics.emplace_back(
-			Previous().Marker,
+			Previous().GetMarker(),
 			DiagnosticSeverity::Error,
 			"expected catch block"
 		);
@@ -1129,8 +1115,8 @@ up<Try> Parser::ParseTry()
 
 bool Parser::IsDefinition()
 {
-	auto& tok = Advance();
-	m_Tok--;
+	auto tok = Advance();
+	Rewind();
 
 	switch (tok.Type)
 	{
@@ -1144,7 +1130,13 @@ bool Parser::IsDefinition()
 	}
 }
 
-const Token& Parser::Advance()
+void Parser::Release()
+{
+	// Keep a couple of tokens behind the cursor for Previous() and rewinds.
+	if (m_Stream && m_Tok > 2) { m_Stream->Release(m_Tok - 2); }
+}
+
+Token Parser::Advance()
 {
 	m_Tok++;
 	return Previous();
@@ -1161,45 +1153,117 @@ bool Parser::Check(TokenType type)
 	return false;
 }
 
-const Token& Parser::Peek()
+Token Parser::Peek()
 {
-	return m_Tokens[m_Tok];
+	return GetToken(m_Tok);
 }
 
-const Token& Parser::Previous()
+Token Parser::Previous()
 {
-	return m_Tokens[m_Tok - 1];
+	return GetToken(m_Tok - 1);
 }
 
 bool Parser::IsGood()
 {
-	return m_Tok < m_Tokens.size() - 1;
+	return !m_Panic && Peek().Type != TokenType::Null;
 }
 
-const Token& Parser::Ensure(TokenType type, const std::string& message)
+Token Parser::GetOffending()
 {
-	if (!IsGood())
+	auto tok = Peek();
+	return tok.Type != TokenType::Null ? tok : Previous();
+}
+
+Token Parser::Ensure(TokenType type, const std::string& message)
+{
+	if (Check(type)) { return Previous(); }
+
+	Error(GetOffending(), message);
+	return Token();
+}
+
+void Parser::Error(const Token& token, const std::string& message)
+{
+	// Only the first error is reported, the rest are likely caused by it.
+	if (m_Panic) { return; }
+
+	m_Diagnostics.emplace_back(
+		token.GetMarker(),
+		DiagnosticSeverity::Error,
+		message
+	);
+	m_Panic = true;
+}
+
+void Parser::SynchronizeStatement(uint64_t start)
+{
+	m_Panic = false;
+	if (m_Tok == start && IsGood()) { Advance(); }
+
+	while (IsGood())
 	{
-		m_Diagnostics.emplace_back(
-			Previous().Marker,
-			DiagnosticSeverity::Error,
-			message
-		);
-		throw -1;
+		switch (Peek().Type)
+		{
+		case TokenType::Semicolon: Advance(); return;
+		case TokenType::RightBrace:
+		case TokenType::LeftBrace:
+		case TokenType::Variable:
+		case TokenType::Const:
+		case TokenType::Static:
+		case TokenType::Function:
+		case TokenType::Class:
+		case TokenType::Enum:
+		case TokenType::While:
+		case TokenType::For:
+		case TokenType::If:
+		case TokenType::Return:
+		case TokenType::Break:
+		case TokenType::Continue:
+		case TokenType::Try:
+		case TokenType::Throw: return;
+		default: Advance(); break;
+		}
 	}
+}
+
+void Parser::SynchronizeDefinition(uint64_t start)
+{
+	m_Panic = false;
+	if (m_Tok == start && IsGood()) { Advance(); }
 
-	Advance();
-	if (Previous().Type != type)
+	uint64_t depth = 0;
+	while (IsGood())
 	{
-		m_Diagnostics.emplace_back(
-			Previous().Marker,
-			DiagnosticSeverity::Error,
-			message
-		);
-		throw -1;
-	}
+		switch (Peek().Type)
+		{
+		case TokenType::LeftBrace: depth++; break;
+		case TokenType::RightBrace:
+			// A closing brace with nothing open belongs to the enclosing class.
+			if (depth == 0) { return; }
+			if (--depth == 0)
+			{
+				Advance();
+				Check(TokenType::Semicolon);
+				return;
+			}
+			break;
+		case TokenType::Semicolon:
+			if (depth == 0) { Advance(); return; }
+			break;
+		case TokenType::Export:
+		case TokenType::Function:
+		case TokenType::Class:
+		case TokenType::Enum:
+		case TokenType::Variable:
+		case TokenType::Const:
+		case TokenType::Static:
+			if (depth == 0) { return; }
+			break;
+		default: break;
+		}
 
-	return Previous();
+		Advance();
+	}
 }
 
 }
@@ -0,0 +1,328 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ScanKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#	define WAVE_SCAN_X86
+#	include <immintrin.h>
+#	if defined(_MSC_VER) && !defined(__clang__)
+#		include <intrin.h>
+#		define WAVE_TARGET_AVX2
+#	else
+#		define WAVE_TARGET_AVX2 __attribute__((target("avx2")))
+#	endif
+#endif
+
+#include <cstdint>
+
+namespace Wave {
+
+namespace {
+
+bool IsWhitespace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool IsIdentifierCharacter(char c)
+{
+	return (c >= 'A' && c <= 'Z') ||
+		(c >= 'a' && c <= 'z') ||
+		(c >= '0' && c <= '9') ||
+		c == '_';
+}
+
+const char* SkipWhitespaceScalar(const char* cur, const char* end)
+{
+	while (cur != end && IsWhitespace(*cur)) { cur++; }
+	return cur;
+}
+
+const char* FindLineEndScalar(const char* cur, const char* end)
+{
+	while (cur != end && *cur != '\n') { cur++; }
+	return cur;
+}
+
+const char* FindCommentEndScalar(const char* cur, const char* end)
+{
+	for (; end - cur >= 2; cur++)
+	{
+		if (cur[0] == '*' && cur[1] == '/') { return cur; }
+	}
+	return end;
+}
+
+const char* SkipIdentifierScalar(const char* cur, const char* end)
+{
+	while (cur != end && IsIdentifierCharacter(*cur)) { cur++; }
+	return cur;
+}
+
+constexpr ScanKernels ScalarKernels =
+{
+	SkipWhitespaceScalar,
+	FindLineEndScalar,
+	FindCommentEndScalar,
+	SkipIdentifierScalar,
+	ScanISA::Scalar
+};
+
+#ifdef WAVE_SCAN_X86
+
+uint32_t CountTrailingZeros(uint32_t mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// SSE2 is part of x86-64, so these need no runtime check.
+
+const char* SkipWhitespaceSSE2(const char* cur, const char* end)
+{
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i carriage = _mm_set1_epi8('\r');
+	const __m128i newline = _mm_set1_epi8('\n');
+
+	while (end - cur >= 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+		__m128i whitespace = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+			_mm_or_si128(_mm_cmpeq_epi8(v, carriage), _mm_cmpeq_epi8(v, newline))
+		);
+
+		uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(whitespace)) & 0xFFFF;
+		if (mask) { return cur + CountTrailingZeros(mask); }
+		cur += 16;
+	}
+
+	return SkipWhitespaceScalar(cur, end);
+}
+
+const char* FindLineEndSSE2(const char* cur, const char* end)
+{
+	const __m128i newline = _mm_set1_epi8('\n');
+
+	while (end - cur >= 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)));
+		if (mask) { return cur + CountTrailingZeros(mask); }
+		cur += 16;
+	}
+
+	return FindLineEndScalar(cur, end);
+}
+
+const char* FindCommentEndSSE2(const char* cur, const char* end)
+{
+	const __m128i star = _mm_set1_epi8('*');
+	const __m128i slash = _mm_set1_epi8('/');
+
+	// Compare each character and the one after it, so we need a character past the vector.
+	while (end - cur >= 17)
+	{
+		__m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+		__m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + 1));
+		__m128i match = _mm_and_si128(_mm_cmpeq_epi8(first, star), _mm_cmpeq_epi8(second, slash));
+
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(match));
+		if (mask) { return cur + CountTrailingZeros(mask); }
+		cur += 16;
+	}
+
+	return FindCommentEndScalar(cur, end);
+}
+
+const char* SkipIdentifierSSE2(const char* cur, const char* end)
+{
+	// Setting bit 5 maps upper case letters onto lower case ones, and nothing else onto letters.
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+	const __m128i beforeA = _mm_set1_epi8('a' - 1);
+	const __m128i afterZ = _mm_set1_epi8('z' + 1);
+	const __m128i beforeZero = _mm_set1_epi8('0' - 1);
+	const __m128i afterNine = _mm_set1_epi8('9' + 1);
+	const __m128i underscore = _mm_set1_epi8('_');
+
+	while (end - cur >= 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+		__m128i lower = _mm_or_si128(v, caseBit);
+
+		__m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, beforeA), _mm_cmplt_epi8(lower, afterZ));
+		__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, beforeZero), _mm_cmplt_epi8(v, afterNine));
+		__m128i identifier = _mm_or_si128(_mm_or_si128(letter, digit), _mm_cmpeq_epi8(v, underscore));
+
+		uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(identifier)) & 0xFFFF;
+		if (mask) { return cur + CountTrailingZeros(mask); }
+		cur += 16;
+	}
+
+	return SkipIdentifierScalar(cur, end);
+}
+
+constexpr ScanKernels SSE2Kernels =
+{
+	SkipWhitespaceSSE2,
+	FindLineEndSSE2,
+	FindCommentEndSSE2,
+	SkipIdentifierSSE2,
+	ScanISA::SSE2
+};
+
+WAVE_TARGET_AVX2 const char* SkipWhitespaceAVX2(const char* cur, const char* end)
+{
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i tab = _mm256_set1_epi8('\t');
+	const __m256i carriage = _mm256_set1_epi8('\r');
+	const __m256i newline = _mm256_set1_epi8('\n');
+
+	while (end - cur >= 32)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+		__m256i whitespace = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, carriage), _mm256_cmpeq_epi8(v, newline))
+		);
+
+		uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(whitespace));
+		if (mask) { return cur + CountTrailingZeros(mask); }
+		cur += 32;
+	}
+
+	return SkipWhitespaceSSE2(cur, end);
+}
+
+WAVE_TARGET_AVX2 const char* FindLineEndAVX2(const char* cur, const char* end)
+{
+	const __m256i newline = _mm256_set1_epi8('\n');
+
+	while (end - cur >= 32)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline)));
+		if (mask) { return cur + CountTrailingZeros(mask); }
+		cur += 32;
+	}
+
+	return FindLineEndSSE2(cur, end);
+}
+
+WAVE_TARGET_AVX2 const char* FindCommentEndAVX2(const char* cur, const char* end)
+{
+	const __m256i star = _mm256_set1_epi8('*');
+	const __m256i slash = _mm256_set1_epi8('/');
+
+	while (end - cur >= 33)
+	{
+		__m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+		__m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + 1));
+		__m256i match = _mm256_and_si256(_mm256_cmpeq_epi8(first, star), _mm256_cmpeq_epi8(second, slash));
+
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(match));
+		if (mask) { return cur + CountTrailingZeros(mask); }
+		cur += 32;
+	}
+
+	return FindCommentEndSSE2(cur, end);
+}
+
+WAVE_TARGET_AVX2 const char* SkipIdentifierAVX2(const char* cur, const char* end)
+{
+	const __m256i caseBit = _mm256_set1_epi8(0x20);
+	const __m256i beforeA = _mm256_set1_epi8('a' - 1);
+	const __m256i afterZ = _mm256_set1_epi8('z' + 1);
+	const __m256i beforeZero = _mm256_set1_epi8('0' - 1);
+	const __m256i afterNine = _mm256_set1_epi8('9' + 1);
+	const __m256i underscore = _mm256_set1_epi8('_');
+
+	while (end - cur >= 32)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+		__m256i lower = _mm256_or_si256(v, caseBit);
+
+		__m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, beforeA), _mm256_cmpgt_epi8(afterZ, lower));
+		__m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, beforeZero), _mm256_cmpgt_epi8(afterNine, v));
+		__m256i identifier = _mm256_or_si256(_mm256_or_si256(letter, digit), _mm256_cmpeq_epi8(v, underscore));
+
+		uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(identifier));
+		if (mask) { return cur + CountTrailingZeros(mask); }
+		cur += 32;
+	}
+
+	return SkipIdentifierSSE2(cur, end);
+}
+
+constexpr ScanKernels AVX2Kernels =
+{
+	SkipWhitespaceAVX2,
+	FindLineEndAVX2,
+	FindCommentEndAVX2,
+	SkipIdentifierAVX2,
+	ScanISA::AVX2
+};
+
+bool IsAVX2Supported()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 1);
+	bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+	if (!osSavesYmm) { return false; }
+
+	__cpuidex(info, 7, 0);
+	return info[1] & (1 << 5);
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+}
+
+const ScanKernels& GetScanKernels()
+{
+#ifdef WAVE_SCAN_X86
+	static const ScanKernels& kernels = IsAVX2Supported() ? AVX2Kernels : SSE2Kernels;
+	return kernels;
+#else
+	return ScalarKernels;
+#endif
+}
+
+const ScanKernels& GetScanKernels(ScanISA isa)
+{
+	switch (isa)
+	{
+#ifdef WAVE_SCAN_X86
+	case ScanISA::AVX2: return GetScanKernels();
+	case ScanISA::SSE2: return SSE2Kernels;
+#endif
+	default: return ScalarKernels;
+	}
+}
+
+}
@@ -0,0 +1,61 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "WaveCompiler/Global.h"
+
+namespace Wave {
+
+/// Instruction sets the lexer's scanning kernels are written for.
+enum class ScanISA
+{
+	Scalar, SSE2, AVX2
+};
+
+/// Kernels the lexer uses to skip over runs of characters.
+/// Each takes the cursor and the end of the buffer, and returns the new cursor.
+struct ScanKernels
+{
+	/// Skip spaces, tabs, carriage returns and newlines.
+	const char* (*SkipWhitespace)(const char* cur, const char* end);
+
+	/// Find the newline ending a line comment, or the end of the buffer.
+	const char* (*FindLineEnd)(const char* cur, const char* end);
+
+	/// Find the '*' of the "*/" ending a block comment, or the end of the buffer.
+	const char* (*FindCommentEnd)(const char* cur, const char* end);
+
+	/// Skip letters, digits and underscores.
+	const char* (*SkipIdentifier)(const char* cur, const char* end);
+
+	/// The instruction set the kernels use.
+	ScanISA ISA;
+};
+
+/// Get the kernels for the widest instruction set the CPU supports.
+/// Chosen once, the first time it is called.
+///
+/// \return The kernels.
+const ScanKernels& GetScanKernels();
+
+/// Get the kernels for a specific instruction set.
+/// Falls back to narrower kernels if the CPU or platform does not support it.
+///
+/// \param isa The instruction set.
+///
+/// \return The kernels.
+const ScanKernels& GetScanKernels(ScanISA isa);
+
+}
@@ -0,0 +1,96 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SourceBuffer.h"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Wave {
+
+SourceBuffer::SourceBuffer(const std::filesystem::path& filePath, bool map)
+	: m_Path(filePath)
+{
+	if (map && Map()) { return; }
+
+	// Mapping is not available or not worth it, read the file in one go instead.
+	std::ifstream stream(filePath, std::ios::binary);
+	if (!stream.is_open()) { return; }
+
+	stream.seekg(0, std::ios::end);
+	auto size = stream.tellg();
+	stream.seekg(0, std::ios::beg);
+	if (size < 0) { return; }
+
+	m_Storage.resize(static_cast<size_t>(size));
+	stream.read(m_Storage.data(), size);
+	m_Storage.resize(static_cast<size_t>(stream.gcount()));
+
+	m_Data = m_Storage.data();
+	m_Size = m_Storage.size();
+	m_Valid = true;
+}
+
+SourceBuffer::SourceBuffer(const std::filesystem::path& filePath, std::istream& stream)
+	: m_Path(filePath)
+{
+	m_Storage.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+	m_Data = m_Storage.data();
+	m_Size = m_Storage.size();
+	m_Valid = true;
+}
+
+bool SourceBuffer::Map()
+{
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+	int file = open(m_Path.c_str(), O_RDONLY);
+	if (file < 0) { return false; }
+
+	struct stat info;
+	if (fstat(file, &info) == 0 && S_ISREG(info.st_mode) && static_cast<uint64_t>(info.st_size) >= MinMapSize)
+	{
+		void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		if (data != MAP_FAILED)
+		{
+			m_Data = static_cast<const char*>(data);
+			m_Size = static_cast<uint64_t>(info.st_size);
+			m_Mapped = true;
+			m_Valid = true;
+		}
+	}
+	close(file);
+#endif
+
+	return m_Mapped;
+}
+
+SourceBuffer::~SourceBuffer()
+{
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+	if (m_Mapped)
+	{
+		munmap(const_cast<char*>(m_Data), m_Size);
+	}
+#endif
+}
+
+}
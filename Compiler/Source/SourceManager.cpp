@@ -0,0 +1,87 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SourceManager.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace Wave {
+
+FileID SourceManager::AddFile(const std::filesystem::path& filePath)
+{
+	auto buffer = std::make_unique<SourceBuffer>(filePath, m_MappedFiles < MaxMappedFiles);
+	if (buffer->IsMapped()) { m_MappedFiles++; }
+
+	return AddFile(std::move(buffer));
+}
+
+FileID SourceManager::AddFile(std::unique_ptr<SourceBuffer> buffer)
+{
+	// Past MaxFiles, IDs would wrap around onto earlier files.
+	assert(m_Files.size() < MaxFiles && "too many source files");
+
+	m_Files.emplace_back().Buffer = std::move(buffer);
+	return static_cast<FileID>(m_Files.size() - 1);
+}
+
+SourceLocation SourceManager::GetLocation(FileID file, uint32_t pos) const
+{
+	auto& starts = GetLineStarts(m_Files[file]);
+
+	// The last line starting at or before the position.
+	auto line = std::upper_bound(starts.begin(), starts.end(), pos) - 1;
+
+	SourceLocation location;
+	location.Line = static_cast<uint32_t>(line - starts.begin()) + 1;
+	location.Column = pos - *line + 1;
+	return location;
+}
+
+std::string_view SourceManager::GetLine(FileID file, uint32_t line) const
+{
+	auto& entry = m_Files[file];
+	auto& starts = GetLineStarts(entry);
+	if (line == 0 || line > starts.size()) { return {}; }
+
+	const char* data = entry.Buffer->GetData();
+	uint64_t begin = starts[line - 1];
+	uint64_t end = line < starts.size() ? starts[line] - 1 : entry.Buffer->GetSize();
+	if (end > begin && data[end - 1] == '\r') { end--; }
+
+	return std::string_view(data + begin, end - begin);
+}
+
+const std::vector<uint32_t>& SourceManager::GetLineStarts(const File& file) const
+{
+	std::call_once(file.LinesBuilt, [&file]()
+	{
+		// Lines past MaxFileSize cannot be pointed to, and their offsets would not fit.
+		const char* begin = file.Buffer->GetData();
+		const char* end = begin + std::min(file.Buffer->GetSize(), MaxFileSize);
+
+		file.LineStarts.push_back(0);
+		for (const char* cur = begin; cur < end; cur++)
+		{
+			cur = static_cast<const char*>(std::memchr(cur, '\n', end - cur));
+			if (!cur) { break; }
+			file.LineStarts.push_back(static_cast<uint32_t>(cur + 1 - begin));
+		}
+	});
+
+	return file.LineStarts;
+}
+
+}
@@ -0,0 +1,110 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Statistics.h"
+
+#include <cstdio>
+
+#include "JSON.h"
+
+namespace Wave {
+
+void Statistics::Add(std::string_view group, std::string_view name, uint64_t value)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	Get(group, name).Count += value;
+}
+
+void Statistics::Max(std::string_view group, std::string_view name, uint64_t value)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto& counter = Get(group, name);
+	if (value > counter.Count) { counter.Count = value; }
+}
+
+void Statistics::Set(std::string_view group, std::string_view name, double value)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto& statistic = Get(group, name);
+	statistic.Real = value;
+	statistic.IsReal = true;
+}
+
+Statistics::Value& Statistics::Get(std::string_view group, std::string_view name)
+{
+	auto values = m_Groups.find(group);
+	if (values == m_Groups.end()) { values = m_Groups.emplace(group, std::map<std::string, Value, std::less<>>()).first; }
+
+	auto value = values->second.find(name);
+	if (value == values->second.end()) { value = values->second.emplace(name, Value()).first; }
+
+	return value->second;
+}
+
+void Statistics::Print(std::ostream& stream) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	stream << "===" << std::string(73, '-') << "===\n";
+	stream << "                          ... Statistics Collected ...\n";
+	stream << "===" << std::string(73, '-') << "===\n";
+
+	for (auto& [group, values] : m_Groups)
+	{
+		stream << "\n  " << group << ":\n";
+		for (auto& [name, value] : values)
+		{
+			char row[32];
+			if (value.IsReal) { snprintf(row, sizeof(row), "  %14.3f  ", value.Real); }
+			else { snprintf(row, sizeof(row), "  %14llu  ", static_cast<unsigned long long>(value.Count)); }
+			stream << row << name << "\n";
+		}
+	}
+	stream << "\n";
+}
+
+void Statistics::WriteJSON(std::ostream& stream) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	stream << "{";
+	bool firstGroup = true;
+	for (auto& [group, values] : m_Groups)
+	{
+		stream << (firstGroup ? "\n\t" : ",\n\t");
+		firstGroup = false;
+		WriteJSONString(stream, group);
+		stream << ": {";
+
+		bool first = true;
+		for (auto& [name, value] : values)
+		{
+			stream << (first ? "\n\t\t" : ",\n\t\t");
+			first = false;
+			WriteJSONString(stream, name);
+			stream << ": ";
+			if (value.IsReal)
+			{
+				char real[32];
+				snprintf(real, sizeof(real), "%.6g", value.Real);
+				stream << real;
+			}
+			else { stream << value.Count; }
+		}
+		stream << "\n\t}";
+	}
+	stream << "\n}\n";
+}
+
+}
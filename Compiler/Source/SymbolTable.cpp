@@ -0,0 +1,83 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SymbolTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace Wave {
+
+namespace {
+
+constexpr uint64_t BlockSize = 64 * 1024;
+
+}
+
+Symbol SymbolTable::Intern(std::string_view string)
+{
+	{
+		std::shared_lock lock(m_Mutex);
+		auto it = m_Symbols.find(string);
+		if (it != m_Symbols.end()) { return it->second; }
+	}
+
+	std::unique_lock lock(m_Mutex);
+
+	// Another thread could have interned the string while we were waiting for the lock.
+	auto it = m_Symbols.find(string);
+	if (it != m_Symbols.end()) { return it->second; }
+
+	auto stored = Store(string);
+	auto symbol = static_cast<Symbol>(m_Strings.size());
+	m_Strings.emplace_back(stored);
+	m_Symbols.emplace(stored, symbol);
+
+	return symbol;
+}
+
+std::string_view SymbolTable::GetString(Symbol symbol) const
+{
+	std::shared_lock lock(m_Mutex);
+	return m_Strings[symbol];
+}
+
+uint32_t SymbolTable::GetSize() const
+{
+	std::shared_lock lock(m_Mutex);
+	// The first entry is the placeholder for InvalidSymbol.
+	return static_cast<uint32_t>(m_Strings.size() - 1);
+}
+
+std::string_view SymbolTable::Store(std::string_view string)
+{
+	if (string.empty()) { return std::string_view(); }
+
+	if (m_BlockUsed + string.size() > m_BlockSize)
+	{
+		// Strings larger than a block get a block of their own.
+		m_BlockSize = std::max<uint64_t>(BlockSize, string.size());
+		m_Blocks.emplace_back(std::make_unique<char[]>(m_BlockSize));
+		m_BlockUsed = 0;
+	}
+
+	char* data = m_Blocks.back().get() + m_BlockUsed;
+	memcpy(data, string.data(), string.size());
+	m_BlockUsed += string.size();
+
+	return std::string_view(data, string.size());
+}
+
+}
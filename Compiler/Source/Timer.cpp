@@ -0,0 +1,301 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Timer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "JSON.h"
+#include "SourceManager.h"
+
+#if defined(PLATFORM_WINDOWS)
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace Wave {
+
+namespace {
+
+/// Get the CPU time used by the calling thread.
+///
+/// \return The time, in seconds.
+double GetThreadCPUTime()
+{
+#if defined(PLATFORM_WINDOWS)
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) { return 0.0; }
+
+	// Both are in units of 100 nanoseconds.
+	auto ticks = [](const FILETIME& time) { return (uint64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+	return double(ticks(kernel) + ticks(user)) * 1e-7;
+#else
+	timespec time;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) { return 0.0; }
+	return double(time.tv_sec) + double(time.tv_nsec) * 1e-9;
+#endif
+}
+
+double GetPercentage(double part, double total)
+{
+	return total > 0.0 ? part / total * 100.0 : 0.0;
+}
+
+double GetMicroseconds(std::chrono::steady_clock::duration duration)
+{
+	return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void PrintHeader(std::ostream& stream)
+{
+	char header[96];
+	snprintf(header, sizeof(header), "  %17s  %17s  %8s  %s\n", "---CPU Time---", "---Wall Time---", "-Count-", "--- Name ---");
+	stream << header;
+}
+
+void PrintRow(std::ostream& stream, const TimeRecord& time, const TimeRecord& total, uint32_t depth, const std::string& name)
+{
+	char row[96];
+	snprintf(
+		row, sizeof(row), "  %8.4f (%5.1f%%)  %8.4f (%5.1f%%)  %8llu  ",
+		time.CPU, GetPercentage(time.CPU, total.CPU),
+		time.Wall, GetPercentage(time.Wall, total.Wall),
+		static_cast<unsigned long long>(time.Count)
+	);
+	stream << row << std::string(depth * 2, ' ') << name << "\n";
+}
+
+}
+
+thread_local TimerRegistry::Node* ScopedTimer::s_Current = nullptr;
+thread_local TimerRegistry::ThreadTrace* TimerRegistry::s_Thread = nullptr;
+thread_local const TimerRegistry* TimerRegistry::s_ThreadOwner = nullptr;
+
+void TimerRegistry::SetEnabled(bool on)
+{
+	m_Enabled = on;
+	if (on) { m_Start = std::chrono::steady_clock::now(); }
+}
+
+void TimerRegistry::SetTraceEnabled(bool on, uint32_t granularity)
+{
+	m_Trace = on;
+	m_Granularity = double(granularity);
+	if (on) { m_TraceStart = std::chrono::steady_clock::now(); }
+}
+
+void TimerRegistry::SetThreadName(const std::string& name)
+{
+	if (m_Trace) { GetThreadTrace().Name = name; }
+}
+
+void TimerRegistry::WriteTrace(std::ostream& stream, const SourceManager& sources) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	stream << "{\"traceEvents\":[\n";
+	stream << "{\"pid\":1,\"tid\":0,\"ph\":\"M\",\"name\":\"process_name\",\"args\":{\"name\":\"wavec\"}}";
+
+	for (auto& thread : m_Threads)
+	{
+		if (!thread->Name.empty())
+		{
+			stream << ",\n{\"pid\":1,\"tid\":" << thread->ID << ",\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{\"name\":";
+			WriteJSONString(stream, thread->Name);
+			stream << "}}";
+		}
+
+		for (auto& event : thread->Events)
+		{
+			char times[64];
+			snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", event.Start, event.Duration);
+
+			stream << ",\n{\"pid\":1,\"tid\":" << thread->ID << ",\"ph\":\"X\"," << times << ",\"name\":";
+			WriteJSONString(stream, event.Name);
+			stream << ",\"args\":{";
+			if (event.HasFile)
+			{
+				stream << "\"file\":";
+				WriteJSONString(stream, sources.GetPath(event.File).string());
+				if (!event.Detail.empty()) { stream << ","; }
+			}
+			if (!event.Detail.empty())
+			{
+				stream << "\"detail\":";
+				WriteJSONString(stream, event.Detail);
+			}
+			stream << "}}";
+		}
+	}
+
+	stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void TimerRegistry::Print(std::ostream& stream, const SourceManager& sources) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	TimeRecord total;
+	for (auto& child : m_Root.Children)
+	{
+		total.Wall += child->Time.Wall;
+		total.CPU += child->Time.CPU;
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+
+	stream << "===" << std::string(73, '-') << "===\n";
+	stream << "                          Wave compiler time report\n";
+	stream << "===" << std::string(73, '-') << "===\n";
+	char summary[128];
+	snprintf(summary, sizeof(summary), "  Total execution time: %.4f seconds CPU, %.4f seconds wall clock\n\n", total.CPU, elapsed);
+	stream << summary;
+
+	PrintHeader(stream);
+	for (auto& child : m_Root.Children) { PrintNode(stream, *child, total, 0); }
+
+	// Only the slowest files, there may be thousands.
+	std::vector<std::pair<FileID, TimeRecord>> files(m_Files.begin(), m_Files.end());
+	std::stable_sort(files.begin(), files.end(), [](auto& a, auto& b) { return a.second.Wall > b.second.Wall; });
+	if (files.size() > 10) { files.resize(10); }
+
+	if (!files.empty())
+	{
+		stream << "\n  Slowest files:\n";
+		PrintHeader(stream);
+		for (auto& [file, time] : files) { PrintRow(stream, time, total, 0, sources.GetPath(file).string()); }
+	}
+	stream << "\n";
+}
+
+TimerRegistry::Node* TimerRegistry::GetNode(Node* parent, const char* name)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	if (!parent) { parent = &m_Root; }
+	for (auto& child : parent->Children)
+	{
+		if (child->Name == name) { return child.get(); }
+	}
+
+	auto& child = parent->Children.emplace_back(std::make_unique<Node>());
+	child->Name = name;
+	return child.get();
+}
+
+void TimerRegistry::Record(Node* node, double wall, double cpu, const FileID* file)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	node->Time.Wall += wall;
+	node->Time.CPU += cpu;
+	node->Time.Count++;
+
+	if (file)
+	{
+		auto& time = m_Files[*file];
+		time.Wall += wall;
+		time.CPU += cpu;
+		time.Count++;
+	}
+}
+
+TimerRegistry::ThreadTrace& TimerRegistry::GetThreadTrace()
+{
+	if (s_ThreadOwner != this)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto& thread = m_Threads.emplace_back(std::make_unique<ThreadTrace>());
+		thread->ID = static_cast<uint32_t>(m_Threads.size());
+		s_Thread = thread.get();
+		s_ThreadOwner = this;
+	}
+
+	return *s_Thread;
+}
+
+void TimerRegistry::Trace(TraceEvent&& event)
+{
+	if (event.Duration < m_Granularity) { return; }
+	GetThreadTrace().Events.emplace_back(std::move(event));
+}
+
+void TimerRegistry::PrintNode(std::ostream& stream, const Node& node, const TimeRecord& total, uint32_t depth) const
+{
+	PrintRow(stream, node.Time, total, depth, node.Name);
+
+	std::vector<const Node*> children;
+	for (auto& child : node.Children) { children.push_back(child.get()); }
+	std::stable_sort(children.begin(), children.end(), [](auto a, auto b) { return a->Time.Wall > b->Time.Wall; });
+
+	for (auto child : children) { PrintNode(stream, *child, total, depth + 1); }
+}
+
+ScopedTimer::ScopedTimer(TimerRegistry& registry, const char* name)
+{
+	if (!registry.IsEnabled() && !registry.IsTraceEnabled()) { return; }
+
+	m_Registry = &registry;
+	m_Name = name;
+	if (registry.IsEnabled())
+	{
+		m_Parent = s_Current;
+		m_Node = registry.GetNode(m_Parent, name);
+		s_Current = m_Node;
+		m_CPU = GetThreadCPUTime();
+	}
+
+	m_Wall = std::chrono::steady_clock::now();
+}
+
+ScopedTimer::ScopedTimer(TimerRegistry& registry, const char* name, FileID file)
+	: ScopedTimer(registry, name)
+{
+	m_File = file;
+	m_HasFile = true;
+}
+
+ScopedTimer::~ScopedTimer()
+{
+	if (!m_Registry) { return; }
+
+	auto end = std::chrono::steady_clock::now();
+	if (m_Node)
+	{
+		double wall = std::chrono::duration<double>(end - m_Wall).count();
+		double cpu = GetThreadCPUTime() - m_CPU;
+
+		// Nested phases of a file are already part of the time of the outer one.
+		bool topLevel = m_HasFile && !m_Parent;
+		m_Registry->Record(m_Node, wall, cpu, topLevel ? &m_File : nullptr);
+		s_Current = m_Parent;
+	}
+
+	if (m_Registry->IsTraceEnabled())
+	{
+		m_Registry->Trace({
+			m_Name, std::move(m_Detail), m_File, m_HasFile,
+			GetMicroseconds(m_Wall - m_Registry->m_TraceStart), GetMicroseconds(end - m_Wall)
+		});
+	}
+}
+
+void ScopedTimer::SetDetail(std::string_view detail)
+{
+	if (m_Registry && m_Registry->IsTraceEnabled()) { m_Detail = detail; }
+}
+
+}
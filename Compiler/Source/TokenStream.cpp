@@ -0,0 +1,73 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "TokenStream.h"
+
+#include <iostream>
+
+namespace Wave {
+
+TokenStream::TokenStream(Lexer& lexer, uint32_t capacity, bool tee)
+	: m_Lexer(lexer), m_Tee(tee)
+{
+	uint64_t size = 1;
+	while (size < capacity) { size <<= 1; }
+
+	m_Ring.resize(size);
+	m_Mask = size - 1;
+
+	if (m_Tee) { std::cout << "LEXER OUTPUT: \n\n"; }
+}
+
+const Token& TokenStream::LexTo(uint64_t index)
+{
+	while (index >= m_End)
+	{
+		// Every token past the end is Null, so there is no need to lex up to the index.
+		// This also keeps an index that wrapped around, such as the one before token 0,
+		// from growing the ring until memory runs out.
+		auto& last = m_Ring[(m_End - 1) & m_Mask];
+		if (m_End != 0 && last.Type == TokenType::Null) { return last; }
+
+		if (m_End - m_Begin == m_Ring.size()) { Grow(); }
+
+		auto& token = m_Ring[m_End & m_Mask];
+		token = m_Lexer.Next();
+		m_End++;
+
+		if (m_Tee) { m_Lexer.Print(token); }
+	}
+
+	return m_Ring[index & m_Mask];
+}
+
+void TokenStream::Release(uint64_t index)
+{
+	if (index > m_End) { index = m_End; }
+	if (index > m_Begin) { m_Begin = index; }
+}
+
+void TokenStream::Grow()
+{
+	std::vector<Token> ring(m_Ring.size() * 2);
+	for (uint64_t i = m_Begin; i < m_End; i++)
+	{
+		ring[i & (ring.size() - 1)] = m_Ring[i & m_Mask];
+	}
+
+	m_Ring = std::move(ring);
+	m_Mask = m_Ring.size() - 1;
+}
+
+}
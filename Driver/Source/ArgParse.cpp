@@ -14,6 +14,13 @@
 
 #include "ArgParse.h"
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "WaveCompiler/MemoryTracker.h"
+
 #include "DiagnosticReporter.h"
 
 namespace Wave {
@@ -21,11 +28,25 @@ namespace Wave {
 namespace Args {
 
 std::vector<fs::path> SourceFiles;
+uint32_t Jobs = 1;
+fs::path TraceFile;
+fs::path StatsFile;
+fs::path CacheDirectory;
+uint64_t CacheSize = 512ull * 1024 * 1024;
+fs::path ASTDirectory;
+uint32_t TraceGranularity = 0;
 
 }
 
 CompileContext Context;
 
+namespace {
+
+/// Most files compiled at once. Each job is a thread, so far larger counts only exhaust the system.
+constexpr long MaxJobs = 256;
+
+}
+
 void OutputHelp();
 
 void ParseArguments(int argc, const char* const* argv)
@@ -58,6 +79,100 @@ void ParseArguments(int argc, const char* const* argv)
 			{
 				Context.SetDebugOutput(true);
 			}
+			else if (strcmp(argv[i], "-fuse-lex-parse") == 0)
+			{
+				Context.SetFusedLexParse(true);
+			}
+			else if (strncmp(argv[i], "-cache-dir=", 11) == 0)
+			{
+				Args::CacheDirectory = argv[i] + 11;
+			}
+			else if (strncmp(argv[i], "-cache-size=", 12) == 0)
+			{
+				char* end;
+				long long size = strtoll(argv[i] + 12, &end, 10);
+				if (*end != '\0' || size < 0)
+				{
+					DiagnosticReporter diag("wavec", DiagnosticSeverity::Fatal);
+					diag << "invalid cache size: '" << argv[i] + 12 << "'";
+					diag.Dump();
+				}
+				if (static_cast<uint64_t>(size) > UINT64_MAX / (1024 * 1024))
+				{
+					DiagnosticReporter diag("wavec", DiagnosticSeverity::Fatal);
+					diag << "cache size is too large: '" << argv[i] + 12 << "'";
+					diag.Dump();
+				}
+
+				Args::CacheSize = static_cast<uint64_t>(size) * 1024 * 1024;
+			}
+			else if (strncmp(argv[i], "-emit-ast=", 10) == 0)
+			{
+				Args::ASTDirectory = argv[i] + 10;
+			}
+			else if (strcmp(argv[i], "-mem-report") == 0)
+			{
+				MemoryTracker::SetEnabled(true);
+			}
+			else if (strcmp(argv[i], "-time-report") == 0)
+			{
+				Context.GetTimers().SetEnabled(true);
+			}
+			else if (strcmp(argv[i], "-stats") == 0 || strncmp(argv[i], "-stats=", 7) == 0)
+			{
+				Context.GetStatistics().SetEnabled(true);
+				if (argv[i][6] == '=') { Args::StatsFile = argv[i] + 7; }
+			}
+			else if (strncmp(argv[i], "-time-trace-granularity=", 24) == 0)
+			{
+				char* end;
+				long granularity = strtol(argv[i] + 24, &end, 10);
+				if (*end != '\0' || granularity < 0)
+				{
+					DiagnosticReporter diag("wavec", DiagnosticSeverity::Fatal);
+					diag << "invalid trace granularity: '" << argv[i] + 24 << "'";
+					diag.Dump();
+				}
+
+				Args::TraceGranularity = static_cast<uint32_t>(granularity);
+			}
+			else if (strcmp(argv[i], "-time-trace") == 0 || strncmp(argv[i], "-time-trace=", 12) == 0)
+			{
+				Args::TraceFile = argv[i][11] == '=' ? argv[i] + 12 : "wavec-trace.json";
+			}
+			else if (strncmp(argv[i], "-j", 2) == 0)
+			{
+				// Both '-j N' and '-jN' are accepted.
+				const char* count = argv[i] + 2;
+				if (*count == '\0')
+				{
+					if (i + 1 == argc)
+					{
+						DiagnosticReporter diag("wavec", DiagnosticSeverity::Fatal);
+						diag << "missing job count after '-j'";
+						diag.Dump();
+					}
+					count = argv[++i];
+				}
+
+				char* end;
+				long jobs = strtol(count, &end, 10);
+				if (*end != '\0' || jobs < 0)
+				{
+					DiagnosticReporter diag("wavec", DiagnosticSeverity::Fatal);
+					diag << "invalid job count: '" << count << "'";
+					diag.Dump();
+				}
+				if (jobs > MaxJobs)
+				{
+					DiagnosticReporter diag("wavec", DiagnosticSeverity::Fatal);
+					diag << "job count is above the limit of " << MaxJobs << ": '" << count << "'";
+					diag.Dump();
+				}
+
+				Args::Jobs = jobs == 0 ? std::thread::hardware_concurrency() : static_cast<uint32_t>(jobs);
+				if (Args::Jobs == 0) { Args::Jobs = 1; }
+			}
 			else
 			{
 				DiagnosticReporter diag("wavec", DiagnosticSeverity::Warning);
@@ -67,6 +182,8 @@ void ParseArguments(int argc, const char* const* argv)
 		}
 	}
 
+	if (!Args::TraceFile.empty()) { Context.GetTimers().SetTraceEnabled(true, Args::TraceGranularity); }
+
 	if (argc == 1)
 	{
 		DiagnosticReporter diag("wavec", DiagnosticSeverity::Fatal);
@@ -83,7 +200,17 @@ R"(Wave compiler driver
 Usage: wavec [option/file] [option/file] ...
 
 Options:
+  -cache-dir=<dir>                 Keep what came of compiling each file in a cache, and skip unchanged files
+  -cache-size=<MiB>                Evict the least recently used cache entries beyond this size, 512 by default
+  -emit-ast=<dir>                  Write the AST of each parsed file to <dir>/<file>.wast, in the binary AST format
+  -fuse-lex-parse                  Lex each file as it is parsed, without keeping a list of all its tokens
   -h, --help                       Show this help message, and exit
+  -j <N>                           Compile up to N files at once, 0 for one per hardware thread, at most 256
+  -mem-report                      Print the heap allocations made in each phase of compilation
+  -stats[=<file>]                  Print statistics about the compilation, or write them to a JSON file
+  -time-report                     Print the time spent in each phase of compilation
+  -time-trace[=<file>]             Write a Chrome trace of the compilation, to wavec-trace.json by default
+  -time-trace-granularity=<us>     Leave scopes shorter than this many microseconds out of the trace
 )"
 	);
 }
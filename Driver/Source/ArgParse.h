@@ -34,6 +34,27 @@ namespace Args {
 /// List of all source file paths.
 extern std::vector<fs::path> SourceFiles;
 
+/// Number of files to compile at once.
+extern uint32_t Jobs;
+
+/// File to write the trace to, empty if not tracing.
+extern fs::path TraceFile;
+
+/// Shortest scope to trace, in microseconds.
+extern uint32_t TraceGranularity;
+
+/// File to write statistics to as JSON, empty to print them instead.
+extern fs::path StatsFile;
+
+/// Directory of the build cache, empty if not caching.
+extern fs::path CacheDirectory;
+
+/// Size the build cache is pruned to, in bytes.
+extern uint64_t CacheSize;
+
+/// Directory to write the AST of each parsed module to, empty if not writing them.
+extern fs::path ASTDirectory;
+
 }
 
 extern CompileContext Context;
@@ -14,6 +14,10 @@
 
 #include "DiagnosticReporter.h"
 
+#include <algorithm>
+
+#include "ArgParse.h"
+
 namespace Wave {
 
 namespace {
@@ -28,6 +32,7 @@ constexpr const char* EscapeHighlight = "\033[42m";
 }
 
 DiagnosticReporter::DiagnosticReporter(const std::string& location, DiagnosticSeverity severity)
+	: m_Severity(severity)
 {
 	m_Buf << location << ": ";
 
@@ -41,21 +46,16 @@ DiagnosticReporter::DiagnosticReporter(const std::string& location, DiagnosticSe
 }
 
 DiagnosticReporter::DiagnosticReporter(const Diagnostic& diagnostic)
+	: m_Severity(diagnostic.Severity)
 {
 	// <filename>:<line>:<column>: 
-	m_Buf << diagnostic.Marker.File.filename().string() << ":";
-
-	std::ifstream stream(diagnostic.Marker.File);
-
-	uint64_t line = 1, column = 1;
-	for (uint64_t i = 0; i < diagnostic.Marker.Pos; i++)
-	{
-		if (stream.get() == '\n') { line++; column = 1; continue; }
-		column++;
-	}
+	auto& sources = Context.GetSources();
+	auto& marker = diagnostic.Marker;
+	m_Buf << sources.GetPath(marker.File).filename().string() << ":";
 
-	m_Buf << line << ":";
-	m_Buf << column << ": ";
+	auto location = sources.GetLocation(marker.File, marker.Pos);
+	m_Buf << location.Line << ":";
+	m_Buf << location.Column << ": ";
 
 	// <severity>:
 	switch (diagnostic.Severity)
@@ -69,36 +69,31 @@ DiagnosticReporter::DiagnosticReporter(const Diagnostic& diagnostic)
 	// <message>
 	m_Buf << diagnostic.Message << "\n";
 
-	stream.seekg(0);
 	// Offending line, with offending part highlighted.
-	for (uint64_t i = 0; i < line - 1; i++) 
-	{
-		stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-	}
-
-	// Characters before highlight
-	for (uint64_t i = 0; i < column - 1; i++)
-	{
-		char c;
-		stream.get(c);
-		m_Buf << c;
-	}
-	// Highlight
-	m_Buf << EscapeHighlight;
-	for (uint64_t i = 0; i < diagnostic.Marker.Length; i++)
-	{
-		char c;
-		stream.get(c);
-		m_Buf << c;
-	}
-	m_Buf << EscapeEnd;
-	std::string str;
-	std::getline(stream, str);
-	m_Buf << str;
+	// A highlight running past the end of the line is cut off there.
+	auto line = sources.GetLine(marker.File, location.Line);
+	size_t column = std::min<size_t>(location.Column - 1, line.size());
+	size_t length = std::min<size_t>(marker.Length, line.size() - column);
+
+	m_Buf << line.substr(0, column);
+	m_Buf << EscapeHighlight << line.substr(column, length) << EscapeEnd;
+	m_Buf << line.substr(column + length);
 }
 
 void DiagnosticReporter::Dump()
 {
+	auto& stats = Context.GetStatistics();
+	if (stats.IsEnabled())
+	{
+		switch (m_Severity)
+		{
+		case DiagnosticSeverity::Note: stats.Add("Diagnostics", "Notes"); break;
+		case DiagnosticSeverity::Warning: stats.Add("Diagnostics", "Warnings"); break;
+		case DiagnosticSeverity::Error:
+		case DiagnosticSeverity::Fatal: stats.Add("Diagnostics", "Errors"); break;
+		}
+	}
+
 	if (m_Severity != DiagnosticSeverity::Note) { std::cerr << m_Buf.str() << "\n\n"; }
 	else { std::cout << m_Buf.str() << "\n\n"; }
 
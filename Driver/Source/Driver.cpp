@@ -16,15 +16,250 @@
 #include <Windows.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <numeric>
 
+#include "WaveCompiler/BuildCache.h"
+#include "WaveCompiler/MemoryTracker.h"
+#include "WaveCompiler/ModuleGraph.h"
+#include "WaveCompiler/Parser/ASTFormat.h"
 #include "WaveCompiler/Parser/Parser.h"
 
 #include "ArgParse.h"
 #include "DiagnosticReporter.h"
+#include "WorkPool.h"
 
 using namespace Wave;
 
+namespace {
+
+/// What came of writing the AST of a file with -emit-ast.
+enum class ASTWriteResult
+{
+	None,
+	Written,
+	TooLarge,
+	Failed,
+};
+
+/// What came of compiling one source file, kept until it is its turn to be reported.
+struct FileResult
+{
+	FileID File = 0;
+	bool Readable = false;
+	bool Failed = false;
+	std::vector<Diagnostic> Diagnostics;
+
+	/// The module header, which is all that is kept of the AST.
+	bool Parsed = false;
+	Identifier Name;
+	std::vector<ModuleImport> Imports;
+
+	/// If the AST was written with -emit-ast.
+	ASTWriteResult ASTWrite = ASTWriteResult::None;
+};
+
+bool HasErrors(const std::vector<Diagnostic>& diagnostics)
+{
+	return std::any_of(diagnostics.begin(), diagnostics.end(), [](const Diagnostic& diag)
+	{
+		return diag.Severity == DiagnosticSeverity::Error || diag.Severity == DiagnosticSeverity::Fatal;
+	});
+}
+
+/// Get the path the AST of a file is written to with -emit-ast.
+fs::path GetASTPath(const fs::path& source)
+{
+	return Args::ASTDirectory / source.filename().replace_extension(".wast");
+}
+
+/// Write the AST of a module in the binary AST format.
+///
+/// \param module The module.
+/// \param path The file to write to.
+///
+/// \return If the file was written, or why not.
+ASTWriteResult WriteAST(const Module& module, const fs::path& path)
+{
+	ScopedTimer timer(Context.GetTimers(), "Emit AST");
+
+	std::string data;
+	if (!SerializeModule(module, Context.GetSymbols(), data)) { return ASTWriteResult::TooLarge; }
+
+	std::ofstream file(path, std::ios::binary);
+	file.write(data.data(), static_cast<std::streamsize>(data.size()));
+	return file ? ASTWriteResult::Written : ASTWriteResult::Failed;
+}
+
+/// Add what came of parsing a file to its result, writing its AST if asked to.
+///
+/// \param result The file, which has the lexer diagnostics.
+/// \param parser The parser, which has run.
+void AddParse(FileResult& result, Parser& parser)
+{
+	auto& diagnostics = parser.GetDiagnostics();
+	result.Diagnostics.insert(result.Diagnostics.end(), diagnostics.begin(), diagnostics.end());
+	result.Failed = HasErrors(diagnostics);
+	if (!Args::ASTDirectory.empty() && !result.Failed)
+	{
+		result.ASTWrite = WriteAST(*parser.GetModule(), GetASTPath(parser.GetModule()->FilePath));
+	}
+
+	result.Parsed = true;
+	result.Name = std::move(parser.GetModule()->Def);
+	result.Imports = std::move(parser.GetModule()->Imports);
+}
+
+/// Lex and parse a file, collecting its diagnostics.
+/// Only reads the shared context, so any number of files can be compiled at once.
+///
+/// \param result The file to compile, which receives the diagnostics.
+/// \param cache The cache to load the file from and store it in, if any.
+void CompileFile(FileResult& result, BuildCache* cache)
+{
+	ScopedTimer timer(Context.GetTimers(), "Compile", result.File);
+
+	CachedFile cached;
+	if (cache && cache->Load(result.File, cached))
+	{
+		result.Failed = cached.Failed;
+		result.Diagnostics = std::move(cached.Diagnostics);
+		result.Parsed = cached.Parsed;
+		result.Name = std::move(cached.Name);
+		result.Imports = std::move(cached.Imports);
+		return;
+	}
+
+	Lexer lexer(Context, result.File);
+	if (Context.IsFusedLexParseEnabled())
+	{
+		// Tokens are lexed as the parser asks for them, so the lexer diagnostics are only known after the parse.
+		TokenStream stream(lexer, 64, Context.IsDebugOutputEnabled());
+		Parser parser(Context, stream);
+		parser.Parse();
+
+		// Like when lexing first, a file with lexer errors counts as not parsed.
+		result.Diagnostics = lexer.GetDiagnostics();
+		result.Failed = HasErrors(result.Diagnostics);
+		if (!result.Failed) { AddParse(result, parser); }
+	}
+	else
+	{
+		lexer.Lex();
+
+		result.Diagnostics = lexer.GetDiagnostics();
+		result.Failed = HasErrors(result.Diagnostics);
+		if (!result.Failed)
+		{
+			Parser parser(Context, lexer);
+			parser.Parse();
+			AddParse(result, parser);
+		}
+	}
+
+	if (cache)
+	{
+		cached.Failed = result.Failed;
+		cached.Parsed = result.Parsed;
+		cached.Name = result.Name;
+		cached.Imports = result.Imports;
+		cached.Diagnostics = result.Diagnostics;
+		cache->Store(result.File, cached);
+	}
+}
+
+void ReportFile(const fs::path& path, const FileResult& result)
+{
+	ScopedTimer timer(Context.GetTimers(), "Report diagnostics", result.File);
+	ScopedMemoryPhase phase(MemoryPhase::Diagnostics);
+
+	if (!result.Readable)
+	{
+		DiagnosticReporter diag("wavec", DiagnosticSeverity::Error);
+		diag << "could not read source file: '" << path.string() << "'";
+		diag.Dump();
+		return;
+	}
+
+	for (auto& diag : result.Diagnostics)
+	{
+		DiagnosticReporter d(diag);
+		d.Dump();
+	}
+
+	if (result.ASTWrite == ASTWriteResult::TooLarge)
+	{
+		DiagnosticReporter diag("wavec", DiagnosticSeverity::Error);
+		diag << "AST of '" << path.string() << "' is too large for the binary AST format, which is limited to 4 GiB";
+		diag.Dump();
+	}
+	else if (result.ASTWrite == ASTWriteResult::Failed)
+	{
+		DiagnosticReporter diag("wavec", DiagnosticSeverity::Warning);
+		diag << "could not write AST file: '" << GetASTPath(path).string() << "'";
+		diag.Dump();
+	}
+
+	if (MemoryTracker::IsEnabled()) { MemoryTracker::AddItems(MemoryPhase::Diagnostics, result.Diagnostics.size()); }
+}
+
+void Report(const std::vector<Diagnostic>& diagnostics)
+{
+	ScopedTimer timer(Context.GetTimers(), "Report diagnostics");
+	ScopedMemoryPhase phase(MemoryPhase::Diagnostics);
+
+	for (auto& diag : diagnostics)
+	{
+		DiagnosticReporter d(diag);
+		d.Dump();
+	}
+
+	if (MemoryTracker::IsEnabled()) { MemoryTracker::AddItems(MemoryPhase::Diagnostics, diagnostics.size()); }
+}
+
+/// Run a job for every module, starting each as soon as the jobs of all its dependencies are done.
+///
+/// \param graph The linked module graph.
+/// \param pool Pool to run the jobs on, or null to run them one by one on this thread.
+/// \param job The job, called with the node of the module.
+void RunGraph(const ModuleGraph& graph, WorkPool* pool, const std::function<void(uint32_t)>& job)
+{
+	if (!pool)
+	{
+		for (uint32_t node : graph.GetOrder()) { job(node); }
+		return;
+	}
+
+	std::vector<std::atomic<uint32_t>> waiting(graph.GetSize());
+	for (uint32_t node = 0; node < graph.GetSize(); node++)
+	{
+		waiting[node] = static_cast<uint32_t>(graph.GetDependencies(node).size());
+	}
+
+	// Whoever finishes the last dependency of a module queues it.
+	std::function<void(uint32_t)> run = [&](uint32_t node)
+	{
+		job(node);
+		for (uint32_t dependent : graph.GetDependents(node))
+		{
+			if (--waiting[dependent] == 0) { pool->Submit([&run, dependent]() { run(dependent); }); }
+		}
+	};
+
+	for (uint32_t node = 0; node < graph.GetSize(); node++)
+	{
+		if (graph.GetDependencies(node).empty()) { pool->Submit([&run, node]() { run(node); }); }
+	}
+	pool->Wait();
+}
+
+}
+
 int main(int argc, char** argv)
 {
 	// Get colors working on Windows
@@ -52,40 +287,223 @@ int main(int argc, char** argv)
 
 	ParseArguments(argc, argv);
 
-	for (auto& file : Args::SourceFiles)
+	Context.GetTimers().SetThreadName("Main");
+
+	// Every file is registered before any work starts, so the source manager
+	// is only ever read from while files are being compiled.
+	auto& sources = Context.GetSources();
+	if (Args::SourceFiles.size() > SourceManager::MaxFiles)
 	{
-		std::ifstream stream(file);
-		Lexer lexer(Context, file, stream);
-		lexer.Lex();
+		DiagnosticReporter diag("wavec", DiagnosticSeverity::Fatal);
+		diag << "too many source files: " << Args::SourceFiles.size() << ", at most " << SourceManager::MaxFiles << " can be compiled at once";
+		diag.Dump();
+	}
 
-		bool error = false;
-		for (auto& diag : lexer.GetDiagnostics())
+	std::vector<FileResult> results(Args::SourceFiles.size());
+	{
+		// Files are mapped, so most of the reading happens while they are lexed.
+		ScopedTimer timer(Context.GetTimers(), "Read");
+		for (size_t i = 0; i < results.size(); i++)
 		{
-			if (diag.Severity == DiagnosticSeverity::Error || diag.Severity == DiagnosticSeverity::Fatal)
+			results[i].File = sources.AddFile(Args::SourceFiles[i]);
+			results[i].Readable = sources.GetBuffer(results[i].File).IsValid();
+
+			// Reported here, as the lexer diagnostic would print the whole first line of the file.
+			if (sources.GetBuffer(results[i].File).GetSize() > SourceManager::MaxFileSize)
 			{
-				error = true;
+				DiagnosticReporter diag("wavec", DiagnosticSeverity::Fatal);
+				diag << "source file is too large: '" << Args::SourceFiles[i].string() << "', source files can be at most 4 GiB";
+				diag.Dump();
 			}
+		}
+	}
 
-			DiagnosticReporter d(diag);
-			d.Dump();
+	if (!Args::ASTDirectory.empty())
+	{
+		std::error_code error;
+		fs::create_directories(Args::ASTDirectory, error);
+		if (error)
+		{
+			DiagnosticReporter diag("wavec", DiagnosticSeverity::Warning);
+			diag << "could not create AST directory: '" << Args::ASTDirectory.string() << "'";
+			diag.Dump();
+			Args::ASTDirectory.clear();
 		}
-		if (error) { continue; }
+	}
 
-		Parser parser(Context, lexer);
-		parser.Parse();
+	// Files loaded from the cache are not lexed or parsed, so they would have no debug output or AST.
+	std::unique_ptr<BuildCache> cache;
+	if (!Args::CacheDirectory.empty() && !Context.IsDebugOutputEnabled() && Args::ASTDirectory.empty())
+	{
+		cache = std::make_unique<BuildCache>(Context, Args::CacheDirectory, Args::CacheSize);
+		if (!cache->IsValid())
+		{
+			DiagnosticReporter diag("wavec", DiagnosticSeverity::Warning);
+			diag << "could not create cache directory: '" << Args::CacheDirectory.string() << "'";
+			diag.Dump();
+			cache.reset();
+		}
+	}
+
+	// Debug output goes straight to stdout, and would be interleaved between files.
+	uint32_t jobs = Context.IsDebugOutputEnabled() ? 1 : Args::Jobs;
+	std::unique_ptr<WorkPool> pool;
+	if (jobs > 1 && results.size() > 1)
+	{
+		uint32_t threads = std::min<uint32_t>(jobs, static_cast<uint32_t>(results.size()));
+		pool = std::make_unique<WorkPool>(threads, [](uint32_t index)
+		{
+			Context.GetTimers().SetThreadName("Worker " + std::to_string(index + 1));
+		});
+	}
+
+	if (!pool)
+	{
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			if (results[i].Readable) { CompileFile(results[i], cache.get()); }
+			ReportFile(Args::SourceFiles[i], results[i]);
+			results[i].Diagnostics = {};
+		}
+	}
+	else
+	{
+		// Start the largest files first, so that one big file is not left running alone at the end.
+		std::vector<size_t> order(results.size());
+		std::iota(order.begin(), order.end(), size_t(0));
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+		{
+			return sources.GetBuffer(results[a].File).GetSize() > sources.GetBuffer(results[b].File).GetSize();
+		});
+
+		std::mutex lock;
+		std::condition_variable finished;
+		std::vector<bool> done(results.size(), false);
+
+		for (size_t i : order)
+		{
+			pool->Submit([&, i]()
+			{
+				if (results[i].Readable) { CompileFile(results[i], cache.get()); }
+
+				std::lock_guard<std::mutex> guard(lock);
+				done[i] = true;
+				finished.notify_all();
+			});
+		}
+
+		// Report in input order as soon as each file is done, regardless of the order they finish in.
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				finished.wait(guard, [&]() { return done[i]; });
+			}
+
+			ReportFile(Args::SourceFiles[i], results[i]);
+			results[i].Diagnostics = {};
+		}
+
+		pool->Wait();
+	}
+
+	// Modules can only be put in a graph once their imports are known, after parsing.
+	ModuleGraph graph(Context);
+	std::vector<size_t> nodeFiles;
+	{
+		ScopedTimer timer(Context.GetTimers(), "Module graph");
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			if (!results[i].Parsed) { continue; }
+
+			graph.AddModule(results[i].Name, results[i].Imports);
+			nodeFiles.push_back(i);
+		}
+		graph.Link();
+	}
+	Report(graph.GetDiagnostics());
+
+	// Module phases run in import order. A module whose imports failed is failed too,
+	// and is told which of its imports did if it had no errors of its own.
+	std::vector<char> failed(graph.GetSize(), false);
+	std::vector<std::vector<Diagnostic>> moduleDiagnostics(graph.GetSize());
+
+	RunGraph(graph, pool.get(), [&](uint32_t node)
+	{
+		auto& dependencies = graph.GetDependencies(node);
+
+		bool ownErrors = results[nodeFiles[node]].Failed || graph.IsInCycle(node);
+		failed[node] = ownErrors;
+		for (uint32_t i = 0; i < dependencies.size(); i++)
+		{
+			if (!failed[dependencies[i]]) { continue; }
+
+			failed[node] = true;
+			if (ownErrors) { continue; }
+
+			auto& imported = graph.GetImport(node, i).Imported.Path;
+			FileMarker marker(imported.front().File, imported.front().Pos);
+			marker.Length = imported.back().Pos + imported.back().Length - marker.Pos;
+			moduleDiagnostics[node].emplace_back(marker, DiagnosticSeverity::Note, "imported module has errors");
+		}
+	});
+
+	for (auto& diagnostics : moduleDiagnostics) { Report(diagnostics); }
 
-		error = false;
-		for (auto& diag : parser.GetDiagnostics())
+	auto& stats = Context.GetStatistics();
+	if (cache)
+	{
+		cache->Prune();
+		if (stats.IsEnabled())
 		{
-			if (diag.Severity == DiagnosticSeverity::Error || diag.Severity == DiagnosticSeverity::Fatal)
+			stats.Add("Cache", "Hits", cache->GetHits());
+			stats.Add("Cache", "Misses", cache->GetMisses());
+			stats.Add("Cache", "Evictions", cache->GetEvictions());
+			stats.Add("Cache", "Bytes written", cache->GetBytesWritten());
+		}
+	}
+
+	if (stats.IsEnabled())
+	{
+		stats.Add("Modules", "Modules", graph.GetSize());
+		stats.Add("Modules", "Imports", graph.GetEdgeCount());
+		stats.Add("Modules", "Import cycles", graph.GetCycleCount());
+
+		// With unlimited threads, each level of the graph could be compiled at once,
+		// so the graph can keep modules / levels threads busy on average.
+		auto path = graph.GetCriticalPath();
+		stats.Add("Modules", "Critical path length", path.size());
+		stats.Add("Modules", "Widest level", graph.GetMaxWidth());
+		stats.Set("Modules", "Parallelism", path.empty() ? 1.0 : static_cast<double>(graph.GetSize()) / path.size());
+
+		if (Args::StatsFile.empty()) { stats.Print(std::cerr); }
+		else
+		{
+			std::ofstream file(Args::StatsFile);
+			if (file) { stats.WriteJSON(file); }
+
+			if (!file)
 			{
-				error = true;
+				DiagnosticReporter diag("wavec", DiagnosticSeverity::Error);
+				diag << "could not write statistics file: '" << Args::StatsFile.string() << "'";
+				diag.Dump();
 			}
+		}
+	}
+
+	if (MemoryTracker::IsEnabled()) { MemoryTracker::Print(std::cerr); }
+	if (Context.GetTimers().IsEnabled()) { Context.GetTimers().Print(std::cerr, sources); }
+	if (Context.GetTimers().IsTraceEnabled())
+	{
+		std::ofstream trace(Args::TraceFile);
+		if (trace) { Context.GetTimers().WriteTrace(trace, sources); }
 
-			DiagnosticReporter d(diag);
-			d.Dump();
+		if (!trace)
+		{
+			DiagnosticReporter diag("wavec", DiagnosticSeverity::Error);
+			diag << "could not write trace file: '" << Args::TraceFile.string() << "'";
+			diag.Dump();
 		}
-		if (error) { continue; }
 	}
 
 	return 0;
@@ -0,0 +1,202 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replacements of the global operator new and delete, which report every allocation
+// to the MemoryTracker while -mem-report is on. Otherwise they only forward to malloc and free.
+// Every form is replaced, so that no block is allocated by the runtime's operator new
+// and freed by these, or the other way around.
+
+#include "WaveCompiler/MemoryTracker.h"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(PLATFORM_MAC)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace {
+
+/// Get the usable size of a block, which is what it really takes from the heap.
+///
+/// \param memory The block.
+/// \param alignment Alignment the block was allocated with, or 0 if it came from malloc.
+/// 
+/// \return The size in bytes.
+uint64_t GetBlockSize(void* memory, std::size_t alignment)
+{
+#if defined(PLATFORM_WINDOWS)
+	return alignment ? _aligned_msize(memory, alignment, 0) : _msize(memory);
+#elif defined(PLATFORM_MAC)
+	(void)alignment;
+	return malloc_size(memory);
+#else
+	(void)alignment;
+	return malloc_usable_size(memory);
+#endif
+}
+
+/// Allocate a block, calling the new handler until it succeeds or there is no handler.
+///
+/// \param size Size of the block.
+/// \param alignment Alignment of the block, or 0 to use malloc.
+///
+/// \return The block, or null if it could not be allocated.
+void* Allocate(std::size_t size, std::size_t alignment)
+{
+	if (size == 0) { size = 1; }
+
+	while (true)
+	{
+		void* memory = nullptr;
+		if (!alignment) { memory = std::malloc(size); }
+		else
+		{
+#if defined(PLATFORM_WINDOWS)
+			memory = _aligned_malloc(size, alignment);
+#else
+			if (alignment < sizeof(void*)) { alignment = sizeof(void*); }
+			if (posix_memalign(&memory, alignment, size) != 0) { memory = nullptr; }
+#endif
+		}
+
+		if (memory)
+		{
+			if (Wave::MemoryTracker::IsEnabled()) { Wave::MemoryTracker::Allocated(GetBlockSize(memory, alignment)); }
+			return memory;
+		}
+
+		auto handler = std::get_new_handler();
+		if (!handler) { return nullptr; }
+		handler();
+	}
+}
+
+/// Allocate a block, or throw std::bad_alloc if it could not be.
+///
+/// \param size Size of the block.
+/// \param alignment Alignment of the block, or 0 to use malloc.
+///
+/// \return The block.
+void* AllocateOrThrow(std::size_t size, std::size_t alignment)
+{
+	void* memory = Allocate(size, alignment);
+	if (!memory) { throw std::bad_alloc(); }
+	return memory;
+}
+
+/// Allocate a block, or return null if it could not be, even if the new handler throws.
+///
+/// \param size Size of the block.
+/// \param alignment Alignment of the block, or 0 to use malloc.
+///
+/// \return The block, or null.
+void* AllocateOrNull(std::size_t size, std::size_t alignment) noexcept
+{
+	try { return Allocate(size, alignment); }
+	catch (...) { return nullptr; }
+}
+
+/// Free a block from Allocate.
+///
+/// \param memory The block, which may be null.
+/// \param alignment The alignment it was allocated with.
+void Free(void* memory, std::size_t alignment) noexcept
+{
+	if (!memory) { return; }
+	if (Wave::MemoryTracker::IsEnabled()) { Wave::MemoryTracker::Freed(GetBlockSize(memory, alignment)); }
+
+#if defined(PLATFORM_WINDOWS)
+	if (alignment) { _aligned_free(memory); }
+	else { std::free(memory); }
+#else
+	std::free(memory);
+#endif
+}
+
+/// Get an alignment as a number.
+///
+/// \param alignment The alignment.
+///
+/// \return The alignment in bytes.
+std::size_t GetAlignment(std::align_val_t alignment)
+{
+	return static_cast<std::size_t>(alignment);
+}
+
+}
+
+void* operator new(std::size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new[](std::size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return AllocateOrNull(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return AllocateOrNull(size, 0); }
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return AllocateOrThrow(size, GetAlignment(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return AllocateOrThrow(size, GetAlignment(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateOrNull(size, GetAlignment(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateOrNull(size, GetAlignment(alignment));
+}
+
+void operator delete(void* memory) noexcept { Free(memory, 0); }
+void operator delete[](void* memory) noexcept { Free(memory, 0); }
+void operator delete(void* memory, std::size_t) noexcept { Free(memory, 0); }
+void operator delete[](void* memory, std::size_t) noexcept { Free(memory, 0); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { Free(memory, 0); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { Free(memory, 0); }
+
+void operator delete(void* memory, std::align_val_t alignment) noexcept
+{
+	Free(memory, GetAlignment(alignment));
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept
+{
+	Free(memory, GetAlignment(alignment));
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+	Free(memory, GetAlignment(alignment));
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+	Free(memory, GetAlignment(alignment));
+}
+
+void operator delete(void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	Free(memory, GetAlignment(alignment));
+}
+
+void operator delete[](void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	Free(memory, GetAlignment(alignment));
+}
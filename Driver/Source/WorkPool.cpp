@@ -0,0 +1,121 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "WorkPool.h"
+
+namespace Wave {
+
+WorkPool::WorkPool(uint32_t threads, std::function<void(uint32_t)> start)
+	: m_Start(std::move(start))
+{
+	if (threads == 0) { threads = 1; }
+
+	m_Workers.resize(threads);
+	m_Threads.reserve(threads);
+	for (uint32_t i = 0; i < threads; i++)
+	{
+		m_Threads.emplace_back(&WorkPool::Run, this, i);
+	}
+}
+
+WorkPool::~WorkPool()
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Stop = true;
+	}
+	m_WorkReady.notify_all();
+
+	for (auto& thread : m_Threads) { thread.join(); }
+}
+
+void WorkPool::Submit(Job job)
+{
+	auto& worker = m_Workers[m_Next++ % m_Workers.size()];
+
+	// Count the job before it becomes visible, so taking it can never underflow the count.
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Queued++;
+		m_Pending++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(worker.Lock);
+		worker.Jobs.emplace_back(std::move(job));
+	}
+	m_WorkReady.notify_one();
+}
+
+void WorkPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_Lock);
+	m_AllDone.wait(lock, [this]() { return m_Pending == 0; });
+}
+
+void WorkPool::Run(uint32_t index)
+{
+	if (m_Start) { m_Start(index); }
+
+	Job job;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Lock);
+			m_WorkReady.wait(lock, [this]() { return m_Queued > 0 || m_Stop; });
+			if (m_Queued == 0) { return; }
+		}
+
+		// Another worker may have taken the job we were woken for.
+		if (!Take(index, job)) { continue; }
+
+		job();
+		job = nullptr;
+
+		std::lock_guard<std::mutex> lock(m_Lock);
+		if (--m_Pending == 0) { m_AllDone.notify_all(); }
+	}
+}
+
+bool WorkPool::Take(uint32_t index, Job& job)
+{
+	uint32_t count = static_cast<uint32_t>(m_Workers.size());
+	for (uint32_t i = 0; i < count; i++)
+	{
+		auto& worker = m_Workers[(index + i) % count];
+		std::lock_guard<std::mutex> lock(worker.Lock);
+		if (worker.Jobs.empty()) { continue; }
+
+		if (i == 0)
+		{
+			job = std::move(worker.Jobs.front());
+			worker.Jobs.pop_front();
+		}
+		else
+		{
+			job = std::move(worker.Jobs.back());
+			worker.Jobs.pop_back();
+		}
+
+		std::lock_guard<std::mutex> queued(m_Lock);
+		m_Queued--;
+		return true;
+	}
+
+	return false;
+}
+
+}
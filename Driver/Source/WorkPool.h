@@ -0,0 +1,91 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Wave {
+
+/// Pool of worker threads, each with its own queue of jobs.
+/// A worker takes jobs from the front of its own queue, and when that runs dry
+/// steals from the back of another worker's queue.
+class WorkPool
+{
+public:
+	using Job = std::function<void()>;
+
+	/// Start the worker threads.
+	///
+	/// \param threads The number of workers, at least 1.
+	/// \param start Called on each worker thread before it takes any jobs, with the index of the worker.
+	WorkPool(uint32_t threads, std::function<void(uint32_t)> start = nullptr);
+
+	/// Wait for all submitted jobs to finish, and stop the workers.
+	~WorkPool();
+
+	WorkPool(const WorkPool&) = delete;
+	WorkPool& operator=(const WorkPool&) = delete;
+
+	/// Queue a job.
+	/// Jobs are handed to the workers in turn, so submitting the most expensive jobs first
+	/// makes them start first. Jobs may submit more jobs.
+	///
+	/// \param job The job to run.
+	void Submit(Job job);
+
+	/// Wait for all submitted jobs to finish.
+	void Wait();
+
+private:
+	struct Worker
+	{
+		std::mutex Lock;
+		std::deque<Job> Jobs;
+	};
+
+	/// Main loop of a worker thread.
+	///
+	/// \param index The index of the worker.
+	void Run(uint32_t index);
+
+	/// Take a job for a worker, from its own queue or stolen from another.
+	///
+	/// \param index The index of the worker.
+	/// \param job Set to the job taken.
+	/// 
+	/// \return If a job was found.
+	bool Take(uint32_t index, Job& job);
+
+	std::deque<Worker> m_Workers;
+	std::vector<std::thread> m_Threads;
+	std::function<void(uint32_t)> m_Start;
+	std::atomic<uint32_t> m_Next = 0;
+
+	std::mutex m_Lock;
+	std::condition_variable m_WorkReady;
+	std::condition_variable m_AllDone;
+	uint64_t m_Queued = 0;
+	uint64_t m_Pending = 0;
+	bool m_Stop = false;
+};
+
+}
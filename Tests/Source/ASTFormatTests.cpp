@@ -0,0 +1,237 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "WaveCompiler/Parser/ASTFormat.h"
+#include "WaveCompiler/Parser/Parser.h"
+
+using namespace Wave;
+
+namespace {
+
+/// Source with every kind of statement, expression, definition and type.
+constexpr const char* Source = R"(module Tests.Format;
+
+import Std.IO;
+import Std.Math as M;
+import extern "stdio.h";
+
+export func add(a: int, b: int): int
+{
+	return a + b * 2 - (a % b) / 3;
+}
+
+func generic(x, y: const, z: real[]): const bool
+{
+	var i = 0;
+	const j: int = 10;
+	static k: real = 1.5;
+	while i < j and !(k >= 2.0) or i != 3
+	{
+		i = i + 1;
+		if i == 5 { break; }
+		else if i <= 2 { continue; }
+		else { M.Print("hello \"world\"\n", i, k); }
+	}
+	for var n = 0; n < 10; n = n + 1 { Std.IO.Print(n); }
+	for v in z { Print(copy v); }
+	try { throw 5; } catch e: int { Print(e); }
+	var f = (p: int, q): int { return p; };
+	var arr: int[10] = { 1, 2, 3 };
+	arr[2] = -arr[1];
+	var t: tuple<int, real, func(int, bool): char> = Make();
+	var g: typeof i = 3;
+	return true;
+}
+
+class Point : Base.Shape, Other
+{
+public:
+	var X: real;
+	var Y: real = 0.0;
+	construct(x: real, y: real) { X = x; Y = y; }
+	static func Origin(): Point { return Make(0, 0); }
+	const func Length(): real { return X * X + Y * Y; }
+	abstract Area(): real;
+	Norm: real { return Length(); }
+	Norm(v: real) { X = v; }
+	static op +(l: Point, r: Point): Point { return Make(l.X + r.X, l.Y + r.Y); }
+	static op -(l: Point): Point { return Make(-l.X, -l.Y); }
+protected:
+	enum Kind { A, B, C };
+private:
+	class Inner { var Z: int; };
+};
+
+enum Color { Red, Green, Blue };
+
+var global: int = 42;
+)";
+
+/// A copy of a serialized module, aligned like the format needs.
+class AlignedBuffer
+{
+public:
+	AlignedBuffer(const std::string& data) : m_Words((data.size() + 7) / 8), m_Size(data.size())
+	{
+		memcpy(m_Words.data(), data.data(), data.size());
+	}
+
+	char* GetData() { return reinterpret_cast<char*>(m_Words.data()); }
+	uint64_t GetSize() const { return m_Size; }
+
+	/// Overwrite a value in the buffer.
+	///
+	/// \param offset Where the value starts.
+	/// \param value The value.
+	template<typename T>
+	void Set(uint64_t offset, T value) { memcpy(GetData() + offset, &value, sizeof(T)); }
+
+private:
+	std::vector<uint64_t> m_Words;
+	uint64_t m_Size;
+};
+
+class ASTFormatTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		m_Stream.str(Source);
+		m_Lexer = std::make_unique<Lexer>(m_Context, "Format.wve", m_Stream);
+		m_Lexer->Lex();
+		m_Parser = std::make_unique<Parser>(m_Context, *m_Lexer);
+		m_Parser->Parse();
+
+		ASSERT_TRUE(m_Lexer->GetDiagnostics().empty());
+		ASSERT_TRUE(m_Parser->GetDiagnostics().empty());
+		ASSERT_TRUE(SerializeModule(*m_Parser->GetModule(), m_Context.GetSymbols(), m_Data));
+	}
+
+	/// Check if a buffer is read as a module.
+	///
+	/// \param buffer The buffer.
+	/// \param size How much of the buffer to read.
+	///
+	/// \return If the module was read.
+	bool Loads(AlignedBuffer& buffer, uint64_t size)
+	{
+		return DeserializeModule(m_Context, m_Lexer->GetFile(), buffer.GetData(), size) != nullptr;
+	}
+
+	bool Loads(AlignedBuffer& buffer) { return Loads(buffer, buffer.GetSize()); }
+
+	CompileContext m_Context;
+	std::istringstream m_Stream;
+	up<Lexer> m_Lexer;
+	up<Parser> m_Parser;
+	std::string m_Data;
+};
+
+}
+
+TEST_F(ASTFormatTest, RoundTripsToTheSameBytes)
+{
+	AlignedBuffer buffer(m_Data);
+	auto module = DeserializeModule(m_Context, m_Lexer->GetFile(), buffer.GetData(), buffer.GetSize());
+	ASSERT_NE(module, nullptr);
+	EXPECT_EQ(module->Definitions.size(), m_Parser->GetModule()->Definitions.size());
+
+	std::string again;
+	ASSERT_TRUE(SerializeModule(*module, m_Context.GetSymbols(), again));
+	EXPECT_EQ(again, m_Data);
+}
+
+TEST_F(ASTFormatTest, RejectsTruncatedBuffers)
+{
+	AlignedBuffer buffer(m_Data);
+	for (uint64_t size = 0; size < buffer.GetSize(); size++)
+	{
+		EXPECT_FALSE(Loads(buffer, size)) << "loaded the first " << size << " of " << buffer.GetSize() << " bytes";
+	}
+}
+
+TEST_F(ASTFormatTest, RejectsDamagedHeaders)
+{
+	auto size = static_cast<uint32_t>(m_Data.size());
+	auto damage = [&](uint64_t offset, auto value)
+	{
+		AlignedBuffer buffer(m_Data);
+		buffer.Set(offset, value);
+		return Loads(buffer);
+	};
+
+	EXPECT_FALSE(damage(offsetof(ASTFormat::Header, Magic), 'X'));
+	EXPECT_FALSE(damage(offsetof(ASTFormat::Header, ByteOrder), uint32_t(0x04030201)));
+	EXPECT_FALSE(damage(offsetof(ASTFormat::Header, Version), ASTFormat::Version + 1));
+	EXPECT_FALSE(damage(offsetof(ASTFormat::Header, Size), size + 1));
+	EXPECT_FALSE(damage(offsetof(ASTFormat::Header, Size), size - 8));
+	EXPECT_FALSE(damage(offsetof(ASTFormat::Header, Module), size));
+	EXPECT_FALSE(damage(offsetof(ASTFormat::Header, Module), uint32_t(1)));
+}
+
+TEST_F(ASTFormatTest, RejectsDamagedNodes)
+{
+	AlignedBuffer buffer(m_Data);
+	BinaryModule view(buffer.GetData(), buffer.GetSize());
+	ASSERT_TRUE(view.IsValid());
+
+	auto definitions = view.GetModule().Definitions;
+	ASSERT_GT(definitions.Count, 0u);
+	auto field = definitions.Offset + offsetof(ASTFormat::GlobalDefinition, Def);
+	ASTFormat::Ref def = view.Get(definitions)[0].Def;
+
+	for (ASTFormat::Ref ref : { uint32_t(buffer.GetSize()), uint32_t(UINT32_MAX), def + 1, uint32_t(sizeof(ASTFormat::Header)) })
+	{
+		AlignedBuffer damaged(m_Data);
+		damaged.Set(field, ref);
+		EXPECT_FALSE(Loads(damaged)) << "loaded a definition at " << ref;
+	}
+
+	AlignedBuffer damaged(m_Data);
+	damaged.Set(def + offsetof(ASTFormat::Node, Kind), NodeKind::Count);
+	EXPECT_FALSE(Loads(damaged));
+}
+
+TEST_F(ASTFormatTest, SurvivesRandomDamage)
+{
+	std::mt19937 random(1);
+	for (int i = 0; i < 2000; i++)
+	{
+		AlignedBuffer buffer(m_Data);
+		for (int j = 0; j < 4; j++) { buffer.Set(random() % buffer.GetSize(), static_cast<char>(random())); }
+
+		// Damage can leave a valid module behind, which must then serialize again.
+		auto module = DeserializeModule(m_Context, m_Lexer->GetFile(), buffer.GetData(), buffer.GetSize());
+		std::string again;
+		if (module) { EXPECT_TRUE(SerializeModule(*module, m_Context.GetSymbols(), again)); }
+	}
+}
+
+TEST_F(ASTFormatTest, RefusesModulesPastTheLimit)
+{
+	std::string data;
+	EXPECT_FALSE(SerializeModule(*m_Parser->GetModule(), m_Context.GetSymbols(), data, m_Data.size() - 1));
+	EXPECT_TRUE(data.empty());
+
+	EXPECT_TRUE(SerializeModule(*m_Parser->GetModule(), m_Context.GetSymbols(), data, m_Data.size()));
+	EXPECT_EQ(data, m_Data);
+}
@@ -0,0 +1,117 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "WaveCompiler/Parser/ASTTraversal.h"
+#include "WaveCompiler/Parser/Parser.h"
+
+using namespace Wave;
+
+namespace {
+
+/// Walk a module and describe each node it walks: types, variables and literals by their text,
+/// other nodes by the name of their kind.
+///
+/// \param source The module, which must have no errors.
+/// \param order Order to walk the nodes in.
+///
+/// \return The descriptions, in walk order.
+std::vector<std::string> Walk(const std::string& source, ASTTraversal::Order order)
+{
+	CompileContext context;
+	std::istringstream stream(source);
+	Lexer lexer(context, "Traversal.wve", stream);
+	lexer.Lex();
+	Parser parser(context, lexer);
+	parser.Parse();
+	EXPECT_TRUE(parser.GetDiagnostics().empty());
+
+	auto text = [&](const Token& token) { return source.substr(token.Pos, token.Length); };
+
+	std::vector<std::string> walked;
+	ASTTraversal walk(order);
+	walk.Reset(*parser.GetModule());
+	for (ASTNode node : walk)
+	{
+		switch (GetKind(node))
+		{
+		case NodeKind::Block: walked.push_back("block"); break;
+		case NodeKind::Call: walked.push_back("call"); break;
+		case NodeKind::ClassDefinition: walked.push_back("class"); break;
+		case NodeKind::ExpressionStatement: walked.push_back("statement"); break;
+		case NodeKind::Function: walked.push_back("function"); break;
+		case NodeKind::FunctionDefinition: walked.push_back("definition"); break;
+		case NodeKind::FuncType: walked.push_back("func type"); break;
+		case NodeKind::OperatorOverload: walked.push_back("operator"); break;
+		case NodeKind::Return: walked.push_back("return"); break;
+		case NodeKind::Try: walked.push_back("try"); break;
+		case NodeKind::VarDefinition: walked.push_back("var"); break;
+		case NodeKind::Literal: walked.push_back(text(static_cast<Literal*>(std::get<Expression*>(node))->Value)); break;
+		case NodeKind::VarAccess: walked.push_back(text(static_cast<VarAccess*>(std::get<Expression*>(node))->Var.Path[0])); break;
+		case NodeKind::SimpleType: walked.push_back(text(std::get<Type*>(node)->Tok)); break;
+		default: walked.push_back("?"); break;
+		}
+	}
+
+	return walked;
+}
+
+using Walked = std::vector<std::string>;
+
+}
+
+TEST(ASTTraversal, WalksOperatorOverloadsInSourceOrder)
+{
+	auto source =
+		"module Tests.Traversal;\n"
+		"class P\n{\npublic:\n"
+		"\tstatic op +(l: int, r: real): char { return l; }\n"
+		"\tstatic op -(v: bool): int { return v; }\n"
+		"};\n";
+
+	// The one parameter of a unary overload is walked once.
+	EXPECT_EQ(Walk(source, ASTTraversal::Order::PreOrder), (Walked{
+		"class",
+		"operator", "int", "real", "char", "block", "return", "l",
+		"operator", "bool", "int", "block", "return", "v",
+	}));
+	EXPECT_EQ(Walk(source, ASTTraversal::Order::PostOrder), (Walked{
+		"int", "real", "char", "l", "return", "block", "operator",
+		"bool", "int", "v", "return", "block", "operator",
+		"class",
+	}));
+}
+
+TEST(ASTTraversal, WalksCatchesAndFunctionTypesInSourceOrder)
+{
+	auto source =
+		"module Tests.Traversal;\n"
+		"func f()\n{\n"
+		"\ttry { g(); } catch e: int { h(1); } catch x: real { k(); }\n"
+		"\tvar t: func(bool, char): real = f;\n"
+		"}\n";
+
+	EXPECT_EQ(Walk(source, ASTTraversal::Order::PreOrder), (Walked{
+		"definition", "function", "block",
+		"try", "block", "statement", "call", "g",
+		"int", "block", "statement", "call", "h", "1",
+		"real", "block", "statement", "call", "k",
+		"var", "func type", "bool", "char", "real", "f",
+	}));
+}
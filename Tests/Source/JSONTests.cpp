@@ -0,0 +1,65 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "JSON.h"
+#include "WaveCompiler/Statistics.h"
+
+using namespace Wave;
+
+namespace {
+
+/// Write a string as JSON.
+///
+/// \param string The string.
+///
+/// \return The quoted string.
+std::string Quote(std::string_view string)
+{
+	std::ostringstream stream;
+	WriteJSONString(stream, string);
+	return stream.str();
+}
+
+}
+
+TEST(JSON, EscapesQuotesAndBackslashes)
+{
+	EXPECT_EQ(Quote("plain"), "\"plain\"");
+	EXPECT_EQ(Quote("say \"hi\""), "\"say \\\"hi\\\"\"");
+	EXPECT_EQ(Quote("C:\\Wave"), "\"C:\\\\Wave\"");
+}
+
+TEST(JSON, EscapesControlCharacters)
+{
+	EXPECT_EQ(Quote("a\nb\tc"), "\"a\\u000ab\\u0009c\"");
+	EXPECT_EQ(Quote(std::string_view("\0\x1f", 2)), "\"\\u0000\\u001f\"");
+	EXPECT_EQ(Quote("\x7f caf\xc3\xa9"), "\"\x7f caf\xc3\xa9\"");
+}
+
+TEST(JSON, EscapesStatisticNames)
+{
+	Statistics stats;
+	stats.SetEnabled(true);
+	stats.Add("Files", "line\nbreak", 1);
+
+	std::ostringstream stream;
+	stats.WriteJSON(stream);
+	EXPECT_NE(stream.str().find("\"line\\u000abreak\""), std::string::npos) << stream.str();
+	EXPECT_EQ(stream.str().find('\n' + std::string("break")), std::string::npos);
+}
@@ -0,0 +1,205 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "WaveCompiler/MemoryTracker.h"
+#include "WaveCompiler/Parser/Parser.h"
+#include "WaveCompiler/TokenStream.h"
+
+using namespace Wave;
+
+namespace {
+
+/// Most allocations the lexer may make per token. Tokens themselves are never allocated one by one,
+/// only the token list and the symbols they refer to are.
+constexpr double LexerAllocationsPerToken = 0.05;
+
+/// Most allocations the parser may make per AST node, including the lexer when it is fused.
+/// Nodes come from the arena, so this bounds everything else the parser allocates.
+constexpr double ParserAllocationsPerNode = 1.0;
+
+/// Turns on tracking for a scope, and gives what was counted in a phase since.
+class TrackedScope
+{
+public:
+	TrackedScope() : m_Enabled(MemoryTracker::IsEnabled())
+	{
+		MemoryTracker::SetEnabled(true);
+		for (size_t i = 0; i < static_cast<size_t>(MemoryPhase::Count); i++)
+		{
+			m_Start[i] = MemoryTracker::GetStats(static_cast<MemoryPhase>(i));
+		}
+	}
+
+	~TrackedScope() { MemoryTracker::SetEnabled(m_Enabled); }
+
+	/// Get what was counted in a phase since the scope started.
+	///
+	/// \param phase The phase.
+	///
+	/// \return The counts.
+	MemoryPhaseStats Get(MemoryPhase phase) const
+	{
+		auto& start = m_Start[static_cast<size_t>(phase)];
+		auto now = MemoryTracker::GetStats(phase);
+		now.Allocations -= start.Allocations;
+		now.Bytes -= start.Bytes;
+		now.Frees -= start.Frees;
+		now.FreedBytes -= start.FreedBytes;
+		now.Items -= start.Items;
+		return now;
+	}
+
+private:
+	bool m_Enabled;
+	MemoryPhaseStats m_Start[static_cast<size_t>(MemoryPhase::Count)];
+};
+
+/// Generate functions with comments, typed parameters, expressions, branches and calls.
+///
+/// \param functions Number of functions.
+///
+/// \return The source.
+std::string GenerateSource(uint64_t functions)
+{
+	std::string source = "module Tests.Memory;\nimport Std.IO;\n\n";
+	for (uint64_t i = 0; i < functions; i++)
+	{
+		auto n = std::to_string(i);
+		source += "// function " + n + "\n";
+		source += "func f" + n + "(alpha: int, beta: tuple<real, int[]>, gamma: func(char): bool): real\n{\n";
+		source += "\tvar local_" + n + " = alpha * " + n + " + beta / 2.5 - (gamma % 7);\n";
+		source += "\tif local_" + n + " >= 10 and alpha != beta { Std.IO.Print(\"large\", local_" + n + "); }\n";
+		source += "\twhile alpha < 100 { alpha = alpha + 1; }\n";
+		source += "\treturn Compute(alpha, beta, gamma, local_" + n + ");\n}\n\n";
+	}
+
+	return source;
+}
+
+}
+
+TEST(MemoryTracker, CountsEveryFormOfNewAndDelete)
+{
+	constexpr auto Alignment = std::align_val_t(64);
+	MemoryPhaseStats counted;
+	{
+		TrackedScope scope;
+
+		::operator delete(::operator new(8));
+		::operator delete[](::operator new[](8));
+		::operator delete(::operator new(8, std::nothrow), std::nothrow);
+		::operator delete[](::operator new[](8, std::nothrow), std::nothrow);
+		::operator delete(::operator new(8), 8);
+		::operator delete[](::operator new[](8), 8);
+
+		::operator delete(::operator new(8, Alignment), Alignment);
+		::operator delete[](::operator new[](8, Alignment), Alignment);
+		::operator delete(::operator new(8, Alignment, std::nothrow), Alignment, std::nothrow);
+		::operator delete[](::operator new[](8, Alignment, std::nothrow), Alignment, std::nothrow);
+		::operator delete(::operator new(8, Alignment), 8, Alignment);
+		::operator delete[](::operator new[](8, Alignment), 8, Alignment);
+
+		counted = scope.Get(MemoryPhase::Other);
+	}
+
+	EXPECT_EQ(counted.Allocations, 12u);
+	EXPECT_EQ(counted.Frees, 12u);
+	EXPECT_EQ(counted.Bytes, counted.FreedBytes);
+}
+
+TEST(MemoryTracker, AlignsAlignedNew)
+{
+	void* memory = ::operator new(100, std::align_val_t(256));
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(memory) % 256, 0u);
+	::operator delete(memory, std::align_val_t(256));
+}
+
+TEST(MemoryTracker, CountsTheBufferOfStableSort)
+{
+	// std::stable_sort gets its buffer with the nothrow operator new, and frees it with the plain delete.
+	std::vector<uint64_t> values(10000);
+	for (uint64_t i = 0; i < values.size(); i++) { values[i] = (i * 7919) % values.size(); }
+
+	MemoryPhaseStats counted;
+	{
+		TrackedScope scope;
+		std::stable_sort(values.begin(), values.end());
+		counted = scope.Get(MemoryPhase::Other);
+	}
+
+	EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+	EXPECT_EQ(counted.Allocations, counted.Frees);
+	EXPECT_EQ(counted.Bytes, counted.FreedBytes);
+}
+
+TEST(MemoryTracker, StaysWithinTheAllocationBudget)
+{
+	auto source = GenerateSource(2000);
+
+	CompileContext context;
+	std::istringstream stream(source);
+	Lexer lexer(context, "Memory.wve", stream);
+
+	MemoryPhaseStats lexed, parsed;
+	{
+		TrackedScope scope;
+		lexer.Lex();
+
+		Parser parser(context, lexer);
+		parser.Parse();
+		ASSERT_TRUE(parser.GetDiagnostics().empty());
+
+		lexed = scope.Get(MemoryPhase::Lexer);
+		parsed = scope.Get(MemoryPhase::Parser);
+	}
+
+	ASSERT_EQ(lexed.Items, lexer.GetTokens().size());
+	ASSERT_GT(parsed.Items, 0u);
+	EXPECT_LE(double(lexed.Allocations) / double(lexed.Items), LexerAllocationsPerToken)
+		<< lexed.Allocations << " allocations for " << lexed.Items << " tokens";
+	EXPECT_LE(double(parsed.Allocations) / double(parsed.Items), ParserAllocationsPerNode)
+		<< parsed.Allocations << " allocations for " << parsed.Items << " AST nodes";
+}
+
+TEST(MemoryTracker, StaysWithinTheAllocationBudgetWhenFused)
+{
+	auto source = GenerateSource(2000);
+
+	CompileContext context;
+	std::istringstream stream(source);
+	Lexer lexer(context, "Memory.wve", stream);
+
+	MemoryPhaseStats parsed;
+	{
+		TrackedScope scope;
+		TokenStream tokens(lexer);
+		Parser parser(context, tokens);
+		parser.Parse();
+		ASSERT_TRUE(parser.GetDiagnostics().empty());
+
+		parsed = scope.Get(MemoryPhase::Parser);
+	}
+
+	ASSERT_GT(parsed.Items, 0u);
+	EXPECT_LE(double(parsed.Allocations) / double(parsed.Items), ParserAllocationsPerNode)
+		<< parsed.Allocations << " allocations for " << parsed.Items << " AST nodes";
+}
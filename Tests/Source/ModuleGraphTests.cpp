@@ -0,0 +1,126 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "WaveCompiler/ModuleGraph.h"
+#include "WaveCompiler/Parser/Parser.h"
+
+using namespace Wave;
+
+namespace {
+
+/// Parses modules into one context and adds each to a graph, the way the driver does.
+class Modules
+{
+public:
+	Modules() : m_Graph(m_Context) {}
+
+	/// Parse a module and add it to the graph.
+	///
+	/// \param source The source of the module.
+	void Add(const std::string& source)
+	{
+		std::istringstream stream(source);
+		Lexer lexer(m_Context, "Module" + std::to_string(m_Graph.GetSize()) + ".wve", stream);
+		lexer.Lex();
+		Parser parser(m_Context, lexer);
+		parser.Parse();
+
+		auto module = parser.GetModule();
+		m_Graph.AddModule(module->Def, module->Imports);
+	}
+
+	/// Link the graph.
+	///
+	/// \return The messages of the graph's errors.
+	std::vector<std::string> Link()
+	{
+		m_Graph.Link();
+
+		std::vector<std::string> errors;
+		for (auto& diag : m_Graph.GetDiagnostics())
+		{
+			if (diag.Severity == DiagnosticSeverity::Error) { errors.push_back(diag.Message); }
+		}
+		return errors;
+	}
+
+	ModuleGraph& GetGraph() { return m_Graph; }
+
+private:
+	CompileContext m_Context;
+	ModuleGraph m_Graph;
+};
+
+}
+
+TEST(ModuleGraph, LinksImports)
+{
+	Modules modules;
+	modules.Add("module Alpha;\n");
+	modules.Add("module Beta;\nimport Alpha;\n");
+
+	EXPECT_TRUE(modules.Link().empty());
+	EXPECT_EQ(modules.GetGraph().GetEdgeCount(), 1u);
+	EXPECT_EQ(modules.GetGraph().GetDependencies(1), std::vector<uint32_t>{ 0 });
+}
+
+TEST(ModuleGraph, ReportsDuplicateModules)
+{
+	Modules modules;
+	modules.Add("module Alpha;\n");
+	modules.Add("module Alpha;\n");
+
+	EXPECT_EQ(modules.Link(), std::vector<std::string>{ "module 'Alpha' is defined more than once" });
+}
+
+TEST(ModuleGraph, FindsTheLongestChainOfImports)
+{
+	Modules modules;
+	modules.Add("module Base;\n");
+	modules.Add("module Left;\nimport Base;\n");
+	modules.Add("module Right;\nimport Base;\n");
+	modules.Add("module Top;\nimport Left;\nimport Right;\n");
+	modules.Add("module Alone;\n");
+
+	EXPECT_TRUE(modules.Link().empty());
+	EXPECT_EQ(modules.GetGraph().GetCriticalPath(), (std::vector<uint32_t>{ 0, 1, 3 }));
+	EXPECT_EQ(modules.GetGraph().GetMaxWidth(), 2u);
+}
+
+TEST(ModuleGraph, HasNoCriticalPathWithoutModules)
+{
+	Modules modules;
+
+	EXPECT_TRUE(modules.Link().empty());
+	EXPECT_TRUE(modules.GetGraph().GetCriticalPath().empty());
+	EXPECT_EQ(modules.GetGraph().GetMaxWidth(), 0u);
+}
+
+TEST(ModuleGraph, IgnoresNamesThatFailedToParse)
+{
+	// Names that failed to parse must not be mistaken for the first name interned.
+	Modules modules;
+	modules.Add("module Alpha;\n");
+	modules.Add("module ;\nimport ;\n");
+	modules.Add("module ;\n");
+
+	EXPECT_TRUE(modules.Link().empty());
+	EXPECT_EQ(modules.GetGraph().GetEdgeCount(), 0u);
+}
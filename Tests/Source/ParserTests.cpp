@@ -0,0 +1,185 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "WaveCompiler/Parser/Parser.h"
+#include "WaveCompiler/Parser/StaticVisitor.h"
+
+using namespace Wave;
+
+namespace {
+
+/// Prints an expression with every operation in parentheses, like "(+ a (* b c))",
+/// so the tests can check how it was grouped. Names and operators are printed as written.
+class ExpressionPrinter : public StaticVisitor<ExpressionPrinter, std::string>
+{
+public:
+	ExpressionPrinter(const std::string& source) : m_Source(source) {}
+
+	std::string Print(Expression* node) { return node ? Dispatch(*node) : "<null>"; }
+
+	std::string Visit(ArrayIndex& node) { return "(index " + Print(node.Var) + " " + Print(node.Index) + ")"; }
+	std::string Visit(Assignment& node) { return "(= " + Print(node.Var) + " " + Print(node.Value) + ")"; }
+	std::string Visit(Binary& node) { return "(" + Print(node.Operator) + " " + Print(node.Left) + " " + Print(node.Right) + ")"; }
+	std::string Visit(Group& node) { return "(group " + Print(node.Expr) + ")"; }
+	std::string Visit(Literal& node) { return Print(node.Value); }
+	std::string Visit(Logical& node) { return "(" + Print(node.Operator) + " " + Print(node.Left) + " " + Print(node.Right) + ")"; }
+	std::string Visit(Unary& node) { return "(" + Print(node.Operator) + " " + Print(node.Right) + ")"; }
+	std::string Visit(VarAccess& node) { return Print(node.Var); }
+
+	std::string Visit(Call& node)
+	{
+		auto call = "(call " + Print(node.Callee);
+		for (auto arg : node.Args) { call += " " + Print(arg); }
+		return call + ")";
+	}
+
+	std::string Visit(Expression&) { return "<other>"; }
+
+private:
+	std::string Print(const Token& token) { return m_Source.substr(token.Pos, token.Length); }
+
+	std::string Print(const Identifier& ident)
+	{
+		std::string path;
+		for (auto& token : ident.Path) { path += (path.empty() ? "" : ".") + Print(token); }
+		return path;
+	}
+
+	const std::string& m_Source;
+};
+
+/// What came of parsing an expression statement.
+struct ParsedExpression
+{
+	/// The expression, printed by ExpressionPrinter, or empty if there was no statement.
+	std::string Printed;
+
+	/// The first error, or empty if there was none.
+	std::string Error;
+};
+
+/// Parse an expression as the only statement of a function.
+///
+/// \param expression The expression, without the semicolon.
+///
+/// \return The expression and the first error.
+ParsedExpression Parse(const std::string& expression)
+{
+	auto source = "module Tests.Parser;\nfunc f()\n{\n\t" + expression + ";\n}\n";
+
+	CompileContext context;
+	std::istringstream stream(source);
+	Lexer lexer(context, "Parser.wve", stream);
+	lexer.Lex();
+	Parser parser(context, lexer);
+	parser.Parse();
+
+	ParsedExpression parsed;
+	for (auto& diag : parser.GetDiagnostics())
+	{
+		if (diag.Severity == DiagnosticSeverity::Error && parsed.Error.empty()) { parsed.Error = diag.Message; }
+	}
+
+	auto& definitions = parser.GetModule()->Definitions;
+	if (definitions.empty() || definitions[0].Def->Kind != NodeKind::FunctionDefinition) { return parsed; }
+
+	auto block = static_cast<FunctionDefinition*>(definitions[0].Def)->Func->ExecBlock;
+	if (!block || block->Statements.empty() || block->Statements[0]->Kind != NodeKind::ExpressionStatement) { return parsed; }
+
+	auto statement = static_cast<ExpressionStatement*>(block->Statements[0]);
+	parsed.Printed = ExpressionPrinter(source).Print(statement->Expr);
+	return parsed;
+}
+
+/// Parse an expression which must have no errors.
+///
+/// \param expression The expression, without the semicolon.
+///
+/// \return The printed expression.
+std::string ParseValid(const std::string& expression)
+{
+	auto parsed = Parse(expression);
+	EXPECT_EQ(parsed.Error, "") << "in '" << expression << "'";
+	return parsed.Printed;
+}
+
+}
+
+TEST(Parser, BindsOperatorsByPrecedence)
+{
+	EXPECT_EQ(ParseValid("a + b * c"), "(+ a (* b c))");
+	EXPECT_EQ(ParseValid("a * b + c"), "(+ (* a b) c)");
+	EXPECT_EQ(ParseValid("a or b and c == d < e + f * g"), "(or a (and b (== c (< d (+ e (* f g))))))");
+	EXPECT_EQ(ParseValid("a * b < c - d != e and f or g"), "(or (and (!= (< (* a b) (- c d)) e) f) g)");
+	EXPECT_EQ(ParseValid("(a + b) * c"), "(* (group (+ a b)) c)");
+}
+
+TEST(Parser, GroupsBinaryOperatorsToTheLeft)
+{
+	EXPECT_EQ(ParseValid("a - b - c"), "(- (- a b) c)");
+	EXPECT_EQ(ParseValid("a / b % c * d"), "(* (% (/ a b) c) d)");
+	EXPECT_EQ(ParseValid("a == b != c"), "(!= (== a b) c)");
+	EXPECT_EQ(ParseValid("a or b or c"), "(or (or a b) c)");
+	EXPECT_EQ(ParseValid("a and b and c"), "(and (and a b) c)");
+}
+
+TEST(Parser, GroupsAssignmentToTheRight)
+{
+	EXPECT_EQ(ParseValid("a = b = c"), "(= a (= b c))");
+	EXPECT_EQ(ParseValid("a = b + c * d"), "(= a (+ b (* c d)))");
+	EXPECT_EQ(ParseValid("a = b or c"), "(= a (or b c))");
+}
+
+TEST(Parser, ChainsUnaryOperators)
+{
+	EXPECT_EQ(ParseValid("-a"), "(- a)");
+	EXPECT_EQ(ParseValid("!!a"), "(! (! a))");
+	EXPECT_EQ(ParseValid("- -!-a"), "(- (- (! (- a))))");
+	EXPECT_EQ(ParseValid("-a * -b"), "(* (- a) (- b))");
+	EXPECT_EQ(ParseValid("!f(x) and -a[1]"), "(and (! (call f x)) (- (index a 1)))");
+}
+
+TEST(Parser, AcceptsVariablesAsAssignmentTargets)
+{
+	EXPECT_EQ(ParseValid("a = 1"), "(= a 1)");
+	EXPECT_EQ(ParseValid("Std.IO.Value = 1"), "(= Std.IO.Value 1)");
+
+	// Array elements are accepted too, though Assignment only holds the name of the array.
+	EXPECT_EQ(Parse("a[0] = 1").Error, "");
+}
+
+TEST(Parser, RejectsOtherAssignmentTargets)
+{
+	for (auto expression : { "1 = a", "f() = a", "(a) = b", "a + b = c", "-a = b" })
+	{
+		EXPECT_EQ(Parse(expression).Error, "invalid assignment, can only assign to variables.") << "in '" << expression << "'";
+	}
+}
+
+TEST(Parser, LimitsHowDeeplyExpressionsNest)
+{
+	// The statement is one level of nesting, and each group adds one more.
+	auto nest = [](uint32_t groups) { return std::string(groups, '(') + "a" + std::string(groups, ')'); };
+
+	EXPECT_EQ(Parse(nest(1023)).Error, "");
+	EXPECT_EQ(Parse(nest(1024)).Error, "expression is nested too deeply");
+
+	// Unary chains are built in a loop, so they do not count towards the limit.
+	EXPECT_EQ(Parse(std::string(5000, '-') + "a").Error, "");
+}
@@ -0,0 +1,196 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ScanKernels.h"
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace Wave;
+
+namespace {
+
+constexpr ScanISA VectorISAs[] = { ScanISA::SSE2, ScanISA::AVX2 };
+
+/// Lengths around the 16 and 32 byte strides of the vector kernels.
+constexpr uint64_t TailLengths[] = { 0, 1, 2, 15, 16, 17, 31, 32, 33, 63, 64, 65 };
+
+/// Characters each kernel stops at or skips over, and some that matter to none of them.
+constexpr char Alphabet[] = { ' ', '\t', '\r', '\n', 'a', 'Z', '_', '7', '*', '/', '\0', '-', '"', '\x7F', '\x80', '\xFF' };
+
+/// Small pseudo-random generator, so failures reproduce on every platform.
+class Random
+{
+public:
+	uint64_t Below(uint64_t bound)
+	{
+		m_State ^= m_State >> 12;
+		m_State ^= m_State << 25;
+		m_State ^= m_State >> 27;
+		return (m_State * 0x2545F4914F6CDD1Dull) % bound;
+	}
+
+private:
+	uint64_t m_State = 0x9E3779B97F4A7C15ull;
+};
+
+/// Check that every kernel of an instruction set finds what the scalar kernel does,
+/// starting at every character of a buffer.
+void ExpectSameAsScalar(ScanISA isa, const char* begin, const char* end)
+{
+	auto& scalar = GetScanKernels(ScanISA::Scalar);
+	auto& kernels = GetScanKernels(isa);
+
+	for (const char* cur = begin; cur <= end; cur++)
+	{
+		SCOPED_TRACE("starting at " + std::to_string(cur - begin) + " of " + std::to_string(end - begin));
+
+		EXPECT_EQ(kernels.SkipWhitespace(cur, end) - begin, scalar.SkipWhitespace(cur, end) - begin);
+		EXPECT_EQ(kernels.FindLineEnd(cur, end) - begin, scalar.FindLineEnd(cur, end) - begin);
+		EXPECT_EQ(kernels.FindCommentEnd(cur, end) - begin, scalar.FindCommentEnd(cur, end) - begin);
+		EXPECT_EQ(kernels.SkipIdentifier(cur, end) - begin, scalar.SkipIdentifier(cur, end) - begin);
+	}
+}
+
+/// Build buffers which are a run of one character, the kind of run a kernel strides over,
+/// with another character put at one position or nowhere.
+///
+/// \param length Length of the buffers.
+///
+/// \return The buffers.
+std::vector<std::string> MakeRuns(uint64_t length)
+{
+	static constexpr char Runs[] = { ' ', '\t', 'a', '_', '9', '*', '/', '-' };
+	static constexpr char Stops[] = { '\n', '\0', '*', '/', '.', '\x80' };
+
+	std::vector<std::string> buffers;
+	for (char run : Runs)
+	{
+		buffers.emplace_back(length, run);
+		for (char stop : Stops)
+		{
+			for (uint64_t at = 0; at < length; at++)
+			{
+				std::string buffer(length, run);
+				buffer[at] = stop;
+				buffers.push_back(std::move(buffer));
+			}
+		}
+	}
+
+	// A comment end split over the last two characters, or cut off by the end.
+	if (length >= 2) { buffers.push_back(std::string(length - 2, 'x') + "*/"); }
+	if (length >= 1) { buffers.push_back(std::string(length - 1, 'x') + "*"); }
+
+	return buffers;
+}
+
+}
+
+TEST(ScanKernels, FallBackToNarrowerKernels)
+{
+	EXPECT_EQ(GetScanKernels(ScanISA::Scalar).ISA, ScanISA::Scalar);
+	EXPECT_EQ(GetScanKernels().ISA, GetScanKernels(ScanISA::AVX2).ISA);
+}
+
+TEST(ScanKernels, MatchScalarOnRandomBuffers)
+{
+	Random random;
+	for (ScanISA isa : VectorISAs)
+	{
+		for (uint64_t i = 0; i < 2000; i++)
+		{
+			// Long runs of one character, so the vector loops run, broken up by other characters.
+			std::string buffer(random.Below(160), ' ');
+			char run = Alphabet[random.Below(sizeof(Alphabet))];
+			for (char& c : buffer)
+			{
+				c = random.Below(8) == 0 ? Alphabet[random.Below(sizeof(Alphabet))] : run;
+			}
+
+			ExpectSameAsScalar(isa, buffer.data(), buffer.data() + buffer.size());
+		}
+	}
+}
+
+TEST(ScanKernels, MatchScalarOnTails)
+{
+	for (ScanISA isa : VectorISAs)
+	{
+		for (uint64_t length : TailLengths)
+		{
+			for (auto& buffer : MakeRuns(length))
+			{
+				ExpectSameAsScalar(isa, buffer.data(), buffer.data() + buffer.size());
+			}
+		}
+	}
+}
+
+TEST(ScanKernels, MatchScalarOnEmbeddedNull)
+{
+	const std::string sources[] = {
+		std::string("abc\0def", 7),
+		std::string("   \0   \n", 8),
+		std::string("// comment\0 still comment\nnext", 31),
+		std::string("/* comment \0 */ after", 21),
+		std::string(40, '\0'),
+		std::string(20, 'x') + std::string(1, '\0') + std::string(20, 'x'),
+	};
+
+	for (ScanISA isa : VectorISAs)
+	{
+		for (auto& source : sources)
+		{
+			ExpectSameAsScalar(isa, source.data(), source.data() + source.size());
+		}
+	}
+}
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+
+TEST(ScanKernels, StopAtTheEndOfThePage)
+{
+	// A page followed by one which cannot be read, so a kernel reading past the end of the buffer crashes.
+	auto page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+	void* mapping = mmap(nullptr, page * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	ASSERT_NE(mapping, MAP_FAILED);
+	ASSERT_EQ(mprotect(static_cast<char*>(mapping) + page, page, PROT_NONE), 0);
+
+	char* end = static_cast<char*>(mapping) + page;
+	for (ScanISA isa : VectorISAs)
+	{
+		for (uint64_t length : TailLengths)
+		{
+			for (auto& buffer : MakeRuns(length))
+			{
+				char* begin = end - length;
+				std::copy(buffer.begin(), buffer.end(), begin);
+				ExpectSameAsScalar(isa, begin, end);
+			}
+		}
+	}
+
+	munmap(mapping, page * 2);
+}
+
+#endif
@@ -0,0 +1,106 @@
+// Copyright 2021 SparkyPotato
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "WaveCompiler/TokenStream.h"
+
+using namespace Wave;
+
+namespace {
+
+constexpr const char* Source = "module Test;\nfunc f(a, b) { return a + b * 2; }\n";
+
+/// Lex a source with Lex(), as the tokens a stream should give.
+///
+/// \param context The context.
+///
+/// \return The tokens.
+std::vector<Token> LexAll(CompileContext& context)
+{
+	std::istringstream stream(Source);
+	Lexer lexer(context, "Test.wve", stream);
+	lexer.Lex();
+	return lexer.GetTokens();
+}
+
+}
+
+TEST(TokenStream, GivesTheTokensLexDoes)
+{
+	CompileContext context;
+	auto tokens = LexAll(context);
+
+	std::istringstream source(Source);
+	Lexer lexer(context, "Test.wve", source);
+	TokenStream stream(lexer, 2);
+
+	for (uint64_t i = 0; i < tokens.size(); i++)
+	{
+		auto& token = stream.Get(i);
+		EXPECT_EQ(token.Type, tokens[i].Type);
+		EXPECT_EQ(token.Pos, tokens[i].Pos);
+		EXPECT_EQ(token.Length, tokens[i].Length);
+
+		// Only keep the last token, so the ring wraps around instead of growing.
+		stream.Release(i);
+	}
+
+	EXPECT_EQ(stream.GetCapacity(), 2u);
+}
+
+TEST(TokenStream, GivesNullPastTheEnd)
+{
+	CompileContext context;
+	std::istringstream source(Source);
+	Lexer lexer(context, "Test.wve", source);
+	TokenStream stream(lexer);
+
+	EXPECT_EQ(stream.Get(10000).Type, TokenType::Null);
+	EXPECT_EQ(stream.Get(20000).Type, TokenType::Null);
+	EXPECT_EQ(stream.GetCapacity(), 64u);
+}
+
+TEST(TokenStream, GivesNullForTheIndexBeforeTheFirstToken)
+{
+	// The parser asks for the token before the cursor, which wraps around at the first token.
+	CompileContext context;
+	std::istringstream empty("");
+	Lexer lexer(context, "Empty.wve", empty);
+	TokenStream stream(lexer);
+
+	EXPECT_EQ(stream.Get(0).Type, TokenType::Null);
+	EXPECT_EQ(stream.Get(UINT64_MAX).Type, TokenType::Null);
+	EXPECT_EQ(stream.GetCapacity(), 64u);
+}
+
+#ifndef NDEBUG
+
+TEST(TokenStreamDeathTest, RejectsReleasedTokens)
+{
+	CompileContext context;
+	std::istringstream source(Source);
+	Lexer lexer(context, "Test.wve", source);
+	TokenStream stream(lexer);
+
+	stream.Get(5);
+	stream.Release(4);
+	EXPECT_DEATH(stream.Get(3), "released");
+}
+
+#endif